@@ -0,0 +1,1048 @@
+//
+// Created by 陈燊 on 2021/12/20.
+//
+
+#ifndef MY_STL_ALGO_H
+#define MY_STL_ALGO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "iterator.h"
+#include "util.h"
+#include "functional.h"
+#include "algobase.h"
+#include "heap_algo.h"
+#include "mymemory.h"
+
+/*
+ * 排序等较复杂的算法, 作用于随机访问迭代器(my_stl::vector的迭代器, 原生指针)
+ *   is_sorted       区间是否已经有序
+ *   lower_bound / upper_bound  有序区间上的二分查找
+ *   insertion_sort  插入排序, 小区间或基本有序时使用
+ *   introsort       内省排序, 不稳定
+ *   sort            pattern-defeating quicksort(pdqsort), 不稳定, 有序/重复元素多的输入更快
+ *   merge / inplace_merge  合并有序区间, 稳定
+ *   rotate          交换相邻的两段
+ *   stable_sort     归并排序, 稳定, 使用temporary_buffer, 拿不到时退化为不需要额外内存的归并
+ *   radix_sort      LSD基数排序, 整数/浮点数/以first为键的pair, 稳定
+ * 除rotate外每个算法都有接受比较函数comp的重载, 默认使用operator<.
+ */
+
+namespace my_stl {
+    /*****************************************************************************************
+     * is_sorted / is_sorted_until
+     *****************************************************************************************/
+    template <class ForwardIter, class Compare>
+    ForwardIter is_sorted_until(ForwardIter first, ForwardIter last, Compare comp) {
+        if (first == last)
+            return last;
+        auto next = first;
+        for (++next; next != last; first = next, ++next) {
+            if (comp(*next, *first))
+                return next;
+        }
+        return last;
+    }
+
+    template <class ForwardIter>
+    ForwardIter is_sorted_until(ForwardIter first, ForwardIter last) {
+        return my_stl::is_sorted_until(first, last,
+                                       my_stl::less<typename iterator_traits<ForwardIter>::value_type>());
+    }
+
+    template <class ForwardIter, class Compare>
+    bool is_sorted(ForwardIter first, ForwardIter last, Compare comp) {
+        return my_stl::is_sorted_until(first, last, comp) == last;
+    }
+
+    template <class ForwardIter>
+    bool is_sorted(ForwardIter first, ForwardIter last) {
+        return my_stl::is_sorted_until(first, last) == last;
+    }
+
+    /*****************************************************************************************
+     * lower_bound / upper_bound
+     * 在有序区间中二分查找第一个不小于/大于value的位置
+     *****************************************************************************************/
+    template <class ForwardIter, class T, class Compare>
+    ForwardIter lower_bound(ForwardIter first, ForwardIter last, const T &value, Compare comp) {
+        auto len = my_stl::distance(first, last);
+        while (len > 0) {
+            const auto half = len / 2;
+            auto mid = first;
+            my_stl::advance(mid, half);
+            if (comp(*mid, value)) {
+                first = ++mid;
+                len -= half + 1;
+            }
+            else {
+                len = half;
+            }
+        }
+        return first;
+    }
+
+    template <class ForwardIter, class T>
+    ForwardIter lower_bound(ForwardIter first, ForwardIter last, const T &value) {
+        return my_stl::lower_bound(first, last, value, my_stl::less<T>());
+    }
+
+    template <class ForwardIter, class T, class Compare>
+    ForwardIter upper_bound(ForwardIter first, ForwardIter last, const T &value, Compare comp) {
+        auto len = my_stl::distance(first, last);
+        while (len > 0) {
+            const auto half = len / 2;
+            auto mid = first;
+            my_stl::advance(mid, half);
+            if (!comp(value, *mid)) {
+                first = ++mid;
+                len -= half + 1;
+            }
+            else {
+                len = half;
+            }
+        }
+        return first;
+    }
+
+    template <class ForwardIter, class T>
+    ForwardIter upper_bound(ForwardIter first, ForwardIter last, const T &value) {
+        return my_stl::upper_bound(first, last, value, my_stl::less<T>());
+    }
+
+    /*****************************************************************************************
+     * insertion_sort
+     *****************************************************************************************/
+    /* 左边一定有不大于*last的元素时使用, 内层循环不必检查边界 */
+    template <class RandomIter, class Compare>
+    void unguarded_linear_insert(RandomIter last, Compare comp) {
+        auto value = my_stl::move(*last);
+        auto next = last;
+        --next;
+        while (comp(value, *next)) {
+            *last = my_stl::move(*next);
+            last = next;
+            --next;
+        }
+        *last = my_stl::move(value);
+    }
+
+    template <class RandomIter, class Compare>
+    void insertion_sort(RandomIter first, RandomIter last, Compare comp) {
+        if (first == last)
+            return;
+        for (auto i = first + 1; i != last; ++i) {
+            if (comp(*i, *first)) {
+                /* 比第一个还小, 整段后移一格 */
+                auto value = my_stl::move(*i);
+                my_stl::move_backward(first, i, i + 1);
+                *first = my_stl::move(value);
+            }
+            else {
+                my_stl::unguarded_linear_insert(i, comp);
+            }
+        }
+    }
+
+    template <class RandomIter>
+    void insertion_sort(RandomIter first, RandomIter last) {
+        my_stl::insertion_sort(first, last, my_stl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    template <class RandomIter, class Compare>
+    void unguarded_insertion_sort(RandomIter first, RandomIter last, Compare comp) {
+        for (auto i = first; i != last; ++i)
+            my_stl::unguarded_linear_insert(i, comp);
+    }
+
+    /*****************************************************************************************
+     * introsort
+     * 快速排序, 枢轴取三数中值(区间大于128时取九数中值), 区间小于sort_threshold后不再划分,
+     * 最后对整个区间做一次插入排序. 递归深度超过2logn时改用堆排序, 最坏O(nlogn).
+     *****************************************************************************************/
+    constexpr ptrdiff_t sort_threshold = 16;
+
+    /* floor(log2(n)) */
+    template <class Size>
+    Size sort_lg(Size n) {
+        Size k = 0;
+        for (; n > 1; n >>= 1)
+            ++k;
+        return k;
+    }
+
+    /* 使*a <= *b <= *c */
+    template <class Iter, class Compare>
+    void sort3(Iter a, Iter b, Iter c, Compare comp) {
+        if (comp(*b, *a))
+            my_stl::iter_swap(a, b);
+        if (comp(*c, *b)) {
+            my_stl::iter_swap(b, c);
+            if (comp(*b, *a))
+                my_stl::iter_swap(a, b);
+        }
+    }
+
+    /* 选出枢轴放到*first */
+    template <class RandomIter, class Compare>
+    void choose_pivot(RandomIter first, RandomIter last, Compare comp) {
+        const auto len = last - first;
+        const auto mid = first + len / 2;
+        if (len > 128) {
+            /* 九数中值: 三组三数中值再取中值 */
+            my_stl::sort3(first, mid, last - 1, comp);
+            my_stl::sort3(first + 1, mid - 1, last - 2, comp);
+            my_stl::sort3(first + 2, mid + 1, last - 3, comp);
+            my_stl::sort3(mid - 1, mid, mid + 1, comp);
+        }
+        else {
+            my_stl::sort3(first, mid, last - 1, comp);
+        }
+        my_stl::iter_swap(first, mid);
+    }
+
+    /* 以pivot划分[first, last), pivot不在区间内, 区间两侧都有能让扫描停下的元素 */
+    template <class RandomIter, class T, class Compare>
+    RandomIter unguarded_partition(RandomIter first, RandomIter last, const T &pivot, Compare comp) {
+        while (true) {
+            while (comp(*first, pivot))
+                ++first;
+            --last;
+            while (comp(pivot, *last))
+                --last;
+            if (!(first < last))
+                return first;
+            my_stl::iter_swap(first, last);
+            ++first;
+        }
+    }
+
+    template <class RandomIter, class Size, class Compare>
+    void introsort_loop(RandomIter first, RandomIter last, Size depth_limit, Compare comp) {
+        while (last - first > sort_threshold) {
+            if (depth_limit == 0) {
+                /* 划分太多次, 改用堆排序 */
+                my_stl::make_heap(first, last, comp);
+                my_stl::sort_heap(first, last, comp);
+                return;
+            }
+            --depth_limit;
+            my_stl::choose_pivot(first, last, comp);
+            auto cut = my_stl::unguarded_partition(first + 1, last, *first, comp);
+            /* 递归右半段, 循环处理左半段 */
+            my_stl::introsort_loop(cut, last, depth_limit, comp);
+            last = cut;
+        }
+    }
+
+    /* 划分结束后每段长度不超过sort_threshold, 且前面段的元素都不大于后面段,
+     * 前sort_threshold个元素中一定有整个区间的最小值, 之后可以不检查边界 */
+    template <class RandomIter, class Compare>
+    void final_insertion_sort(RandomIter first, RandomIter last, Compare comp) {
+        if (last - first > sort_threshold) {
+            my_stl::insertion_sort(first, first + sort_threshold, comp);
+            my_stl::unguarded_insertion_sort(first + sort_threshold, last, comp);
+        }
+        else {
+            my_stl::insertion_sort(first, last, comp);
+        }
+    }
+
+    template <class RandomIter, class Compare>
+    void introsort(RandomIter first, RandomIter last, Compare comp) {
+        if (last - first > 1) {
+            my_stl::introsort_loop(first, last, sort_lg(last - first) * 2, comp);
+            my_stl::final_insertion_sort(first, last, comp);
+        }
+    }
+
+    template <class RandomIter>
+    void introsort(RandomIter first, RandomIter last) {
+        my_stl::introsort(first, last, my_stl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /*****************************************************************************************
+     * sort (pattern-defeating quicksort, pdqsort)
+     * 在内省排序的基础上:
+     *   1. 划分时没有发生交换(区间看起来已经有序)就试一次限次数的插入排序, 有序/基本有序的输入O(n)
+     *   2. 枢轴与左边界的前一个元素(上一轮的枢轴)相等时, 把等于枢轴的元素全部划到左边一次处理完,
+     *      大量重复元素时O(nk)
+     *   3. 划分极不均衡时交换几个元素打乱可能的攻击模式, 不均衡次数超过logn次改用堆排序
+     *   4. 比较代价低(算术类型配合less/greater)时使用分块的无分支划分: 先把需要交换的下标
+     *      批量记录到缓冲区里, 比较结果只参与加法而不参与跳转, 不会因为分支预测失败而停顿
+     *****************************************************************************************/
+    constexpr ptrdiff_t pdq_insertion_threshold = 24;    /* 小于此长度用插入排序 */
+    constexpr ptrdiff_t pdq_ninther_threshold = 128;     /* 大于此长度用九数中值 */
+    constexpr size_t    pdq_partial_insertion_limit = 8; /* 部分插入排序最多移动的元素数 */
+    constexpr ptrdiff_t pdq_block_size = 64;             /* 无分支划分每块的元素数, 下标用unsigned char保存 */
+    constexpr size_t    pdq_cacheline = 64;
+
+    /* 比较是否足够便宜, 可以使用无分支划分. 其他类型/比较函数可以自行特化 */
+    template <class T, class Compare>
+    struct is_cheap_compare : m_false_type {};
+
+    template <class T>
+    struct is_cheap_compare<T, my_stl::less<T>>
+            : m_bool_constant<std::is_arithmetic<T>::value || std::is_pointer<T>::value> {};
+
+    template <class T>
+    struct is_cheap_compare<T, my_stl::greater<T>>
+            : m_bool_constant<std::is_arithmetic<T>::value || std::is_pointer<T>::value> {};
+
+    /* 插入排序, 但总共移动超过pdq_partial_insertion_limit个元素就放弃, 返回是否排好 */
+    template <class RandomIter, class Compare>
+    bool partial_insertion_sort(RandomIter first, RandomIter last, Compare comp) {
+        if (first == last)
+            return true;
+        size_t moved = 0;
+        for (auto cur = first + 1; cur != last; ++cur) {
+            auto sift = cur;
+            auto sift_1 = cur - 1;
+            if (comp(*sift, *sift_1)) {
+                auto value = my_stl::move(*sift);
+                do {
+                    *sift-- = my_stl::move(*sift_1);
+                } while (sift != first && comp(value, *--sift_1));
+                *sift = my_stl::move(value);
+                moved += static_cast<size_t>(cur - sift);
+            }
+            if (moved > pdq_partial_insertion_limit)
+                return false;
+        }
+        return true;
+    }
+
+    /* 以*first为枢轴划分, 等于枢轴的元素放在右边; 返回枢轴的最终位置和划分前是否已经划分好 */
+    template <class RandomIter, class Compare>
+    my_stl::pair<RandomIter, bool> partition_right(RandomIter first, RandomIter last, Compare comp) {
+        auto pivot = my_stl::move(*first);
+        auto l = first;
+        auto r = last;
+        /* 枢轴是三数中值, 右边一定有不小于它的元素 */
+        while (comp(*++l, pivot));
+        /* 左边第一个元素就停下时右边没有哨兵, 需要检查边界 */
+        if (l - 1 == first)
+            while (l < r && !comp(*--r, pivot));
+        else
+            while (!comp(*--r, pivot));
+        const bool already_partitioned = l >= r;
+        while (l < r) {
+            my_stl::iter_swap(l, r);
+            while (comp(*++l, pivot));
+            while (!comp(*--r, pivot));
+        }
+        auto pivot_pos = l - 1;
+        *first = my_stl::move(*pivot_pos);
+        *pivot_pos = my_stl::move(pivot);
+        return my_stl::pair<RandomIter, bool>(pivot_pos, already_partitioned);
+    }
+
+    /* 按记录的下标成对交换左块和右块中放错边的元素; 个数不同时用轮换少一半的赋值 */
+    template <class RandomIter>
+    void swap_offsets(RandomIter first, RandomIter last, const unsigned char *offsets_l,
+                      const unsigned char *offsets_r, size_t num, bool use_swaps) {
+        if (use_swaps) {
+            /* 左右个数相同时不能轮换, 否则会有一个元素被放回原处 */
+            for (size_t i = 0; i < num; ++i)
+                my_stl::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+        }
+        else if (num > 0) {
+            auto l = first + offsets_l[0];
+            auto r = last - offsets_r[0];
+            auto value = my_stl::move(*l);
+            *l = my_stl::move(*r);
+            for (size_t i = 1; i < num; ++i) {
+                l = first + offsets_l[i];
+                *r = my_stl::move(*l);
+                r = last - offsets_r[i];
+                *l = my_stl::move(*r);
+            }
+            *r = my_stl::move(value);
+        }
+    }
+
+    template <class T>
+    T* align_to_cacheline(T *p) {
+        const auto v = reinterpret_cast<size_t>(p);
+        return reinterpret_cast<T*>((v + pdq_cacheline - 1) & ~(pdq_cacheline - 1));
+    }
+
+    /* partition_right的分块无分支版本, 结果相同 */
+    template <class RandomIter, class Compare>
+    my_stl::pair<RandomIter, bool> partition_right_branchless(RandomIter first, RandomIter last, Compare comp) {
+        auto pivot = my_stl::move(*first);
+        auto l = first;
+        auto r = last;
+        while (comp(*++l, pivot));
+        if (l - 1 == first)
+            while (l < r && !comp(*--r, pivot));
+        else
+            while (!comp(*--r, pivot));
+        const bool already_partitioned = l >= r;
+        if (!already_partitioned) {
+            my_stl::iter_swap(l, r);
+            ++l;
+        }
+
+        /* 左块记录不小于枢轴的元素下标, 右块记录小于枢轴的元素下标(从右往左数) */
+        unsigned char offsets_l_storage[pdq_block_size + pdq_cacheline];
+        unsigned char offsets_r_storage[pdq_block_size + pdq_cacheline];
+        unsigned char *offsets_l = align_to_cacheline(offsets_l_storage);
+        unsigned char *offsets_r = align_to_cacheline(offsets_r_storage);
+        auto offsets_l_base = l;
+        auto offsets_r_base = r;
+        size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+        while (l < r) {
+            /* 剩余不足两块时把未扫描的部分分给空的一侧 */
+            const auto num_unknown = static_cast<size_t>(r - l);
+            const size_t left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+            const size_t right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+            if (left_split >= static_cast<size_t>(pdq_block_size)) {
+                for (unsigned char i = 0; i < pdq_block_size;) {
+                    offsets_l[num_l] = i++; num_l += !comp(*l, pivot); ++l;
+                    offsets_l[num_l] = i++; num_l += !comp(*l, pivot); ++l;
+                    offsets_l[num_l] = i++; num_l += !comp(*l, pivot); ++l;
+                    offsets_l[num_l] = i++; num_l += !comp(*l, pivot); ++l;
+                    offsets_l[num_l] = i++; num_l += !comp(*l, pivot); ++l;
+                    offsets_l[num_l] = i++; num_l += !comp(*l, pivot); ++l;
+                    offsets_l[num_l] = i++; num_l += !comp(*l, pivot); ++l;
+                    offsets_l[num_l] = i++; num_l += !comp(*l, pivot); ++l;
+                }
+            }
+            else {
+                for (size_t i = 0; i < left_split;) {
+                    offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*l, pivot); ++l;
+                }
+            }
+
+            if (right_split >= static_cast<size_t>(pdq_block_size)) {
+                for (unsigned char i = 0; i < pdq_block_size;) {
+                    offsets_r[num_r] = ++i; num_r += comp(*--r, pivot);
+                    offsets_r[num_r] = ++i; num_r += comp(*--r, pivot);
+                    offsets_r[num_r] = ++i; num_r += comp(*--r, pivot);
+                    offsets_r[num_r] = ++i; num_r += comp(*--r, pivot);
+                    offsets_r[num_r] = ++i; num_r += comp(*--r, pivot);
+                    offsets_r[num_r] = ++i; num_r += comp(*--r, pivot);
+                    offsets_r[num_r] = ++i; num_r += comp(*--r, pivot);
+                    offsets_r[num_r] = ++i; num_r += comp(*--r, pivot);
+                }
+            }
+            else {
+                for (size_t i = 0; i < right_split;) {
+                    offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--r, pivot);
+                }
+            }
+
+            const size_t num = num_l < num_r ? num_l : num_r;
+            my_stl::swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r,
+                                 num, num_l == num_r);
+            num_l -= num;
+            num_r -= num;
+            start_l += num;
+            start_r += num;
+            if (num_l == 0) {
+                start_l = 0;
+                offsets_l_base = l;
+            }
+            if (num_r == 0) {
+                start_r = 0;
+                offsets_r_base = r;
+            }
+        }
+
+        /* 只剩一侧还有放错的元素, 把它们依次换到中间 */
+        if (num_l) {
+            offsets_l += start_l;
+            while (num_l--)
+                my_stl::iter_swap(offsets_l_base + offsets_l[num_l], --r);
+            l = r;
+        }
+        if (num_r) {
+            offsets_r += start_r;
+            while (num_r--) {
+                my_stl::iter_swap(offsets_r_base - offsets_r[num_r], l);
+                ++l;
+            }
+            r = l;
+        }
+
+        auto pivot_pos = l - 1;
+        *first = my_stl::move(*pivot_pos);
+        *pivot_pos = my_stl::move(pivot);
+        return my_stl::pair<RandomIter, bool>(pivot_pos, already_partitioned);
+    }
+
+    template <class RandomIter, class Compare>
+    my_stl::pair<RandomIter, bool> pdq_partition(RandomIter first, RandomIter last, Compare comp, m_true_type) {
+        return my_stl::partition_right_branchless(first, last, comp);
+    }
+
+    template <class RandomIter, class Compare>
+    my_stl::pair<RandomIter, bool> pdq_partition(RandomIter first, RandomIter last, Compare comp, m_false_type) {
+        return my_stl::partition_right(first, last, comp);
+    }
+
+    /* 以*first为枢轴划分, 等于枢轴的元素放在左边, 返回枢轴的最终位置.
+     * 只在*(first - 1)(上一轮的枢轴)不小于*first时调用, 此时左边全部等于枢轴, 不必再排序 */
+    template <class RandomIter, class Compare>
+    RandomIter partition_left(RandomIter first, RandomIter last, Compare comp) {
+        auto pivot = my_stl::move(*first);
+        auto l = first;
+        auto r = last;
+        while (comp(pivot, *--r));
+        if (r + 1 == last)
+            while (l < r && !comp(pivot, *++l));
+        else
+            while (!comp(pivot, *++l));
+        while (l < r) {
+            my_stl::iter_swap(l, r);
+            while (comp(pivot, *--r));
+            while (!comp(pivot, *++l));
+        }
+        *first = my_stl::move(*r);
+        *r = my_stl::move(pivot);
+        return r;
+    }
+
+    template <class RandomIter, class Compare, class Branchless>
+    void pdqsort_loop(RandomIter first, RandomIter last, Compare comp, int bad_allowed, bool leftmost,
+                      Branchless branchless) {
+        while (true) {
+            const auto len = last - first;
+            if (len < pdq_insertion_threshold) {
+                /* 不是最左边的区间时, first - 1上的枢轴就是哨兵 */
+                if (leftmost)
+                    my_stl::insertion_sort(first, last, comp);
+                else
+                    my_stl::unguarded_insertion_sort(first, last, comp);
+                return;
+            }
+
+            /* 选枢轴放到*first */
+            const auto half = len / 2;
+            if (len > pdq_ninther_threshold) {
+                my_stl::sort3(first, first + half, last - 1, comp);
+                my_stl::sort3(first + 1, first + (half - 1), last - 2, comp);
+                my_stl::sort3(first + 2, first + (half + 1), last - 3, comp);
+                my_stl::sort3(first + (half - 1), first + half, first + (half + 1), comp);
+                my_stl::iter_swap(first, first + half);
+            }
+            else {
+                my_stl::sort3(first + half, first, last - 1, comp);
+            }
+
+            /* 枢轴等于上一轮的枢轴: 左边全是相等元素, 一次划掉 */
+            if (!leftmost && !comp(*(first - 1), *first)) {
+                first = my_stl::partition_left(first, last, comp) + 1;
+                continue;
+            }
+
+            auto part = my_stl::pdq_partition(first, last, comp, branchless);
+            auto pivot_pos = part.first;
+            const bool already_partitioned = part.second;
+
+            const auto l_len = pivot_pos - first;
+            const auto r_len = last - (pivot_pos + 1);
+            if (l_len < len / 8 || r_len < len / 8) {
+                /* 划分极不均衡, 次数用完就改用堆排序 */
+                if (--bad_allowed == 0) {
+                    my_stl::make_heap(first, last, comp);
+                    my_stl::sort_heap(first, last, comp);
+                    return;
+                }
+                /* 交换几个元素打破输入的模式 */
+                if (l_len >= pdq_insertion_threshold) {
+                    my_stl::iter_swap(first, first + l_len / 4);
+                    my_stl::iter_swap(pivot_pos - 1, pivot_pos - l_len / 4);
+                    if (l_len > pdq_ninther_threshold) {
+                        my_stl::iter_swap(first + 1, first + (l_len / 4 + 1));
+                        my_stl::iter_swap(first + 2, first + (l_len / 4 + 2));
+                        my_stl::iter_swap(pivot_pos - 2, pivot_pos - (l_len / 4 + 1));
+                        my_stl::iter_swap(pivot_pos - 3, pivot_pos - (l_len / 4 + 2));
+                    }
+                }
+                if (r_len >= pdq_insertion_threshold) {
+                    my_stl::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_len / 4));
+                    my_stl::iter_swap(last - 1, last - r_len / 4);
+                    if (r_len > pdq_ninther_threshold) {
+                        my_stl::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_len / 4));
+                        my_stl::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_len / 4));
+                        my_stl::iter_swap(last - 2, last - (1 + r_len / 4));
+                        my_stl::iter_swap(last - 3, last - (2 + r_len / 4));
+                    }
+                }
+            }
+            else if (already_partitioned &&
+                     my_stl::partial_insertion_sort(first, pivot_pos, comp) &&
+                     my_stl::partial_insertion_sort(pivot_pos + 1, last, comp)) {
+                /* 划分时没有交换, 两边用少量移动就排好了 */
+                return;
+            }
+
+            /* 递归左半段, 循环处理右半段 */
+            my_stl::pdqsort_loop(first, pivot_pos, comp, bad_allowed, leftmost, branchless);
+            first = pivot_pos + 1;
+            leftmost = false;
+        }
+    }
+
+    template <class RandomIter, class Compare>
+    void sort(RandomIter first, RandomIter last, Compare comp) {
+        typedef typename iterator_traits<RandomIter>::value_type value_type;
+        if (last - first > 1)
+            my_stl::pdqsort_loop(first, last, comp, static_cast<int>(sort_lg(last - first)), true,
+                                 m_bool_constant<is_cheap_compare<value_type, Compare>::value>());
+    }
+
+    template <class RandomIter>
+    void sort(RandomIter first, RandomIter last) {
+        my_stl::sort(first, last, my_stl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /*****************************************************************************************
+     * merge
+     * 把有序区间[first1, last1)和[first2, last2)合并到result, 稳定: 相等时先取第一个区间的元素
+     *****************************************************************************************/
+    template <class InputIter1, class InputIter2, class OutputIter, class Compare>
+    OutputIter merge(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+                     OutputIter result, Compare comp) {
+        for (; first1 != last1 && first2 != last2; ++result) {
+            if (comp(*first2, *first1)) {
+                *result = *first2;
+                ++first2;
+            }
+            else {
+                *result = *first1;
+                ++first1;
+            }
+        }
+        return my_stl::copy(first2, last2, my_stl::copy(first1, last1, result));
+    }
+
+    template <class InputIter1, class InputIter2, class OutputIter>
+    OutputIter merge(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+                     OutputIter result) {
+        return my_stl::merge(first1, last1, first2, last2, result,
+                             my_stl::less<typename iterator_traits<InputIter1>::value_type>());
+    }
+
+    /* 移动元素的merge, 两个输入区间都不能和输出区间重叠 */
+    template <class InputIter1, class InputIter2, class OutputIter, class Compare>
+    OutputIter move_merge(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+                          OutputIter result, Compare comp) {
+        for (; first1 != last1 && first2 != last2; ++result) {
+            if (comp(*first2, *first1)) {
+                *result = my_stl::move(*first2);
+                ++first2;
+            }
+            else {
+                *result = my_stl::move(*first1);
+                ++first1;
+            }
+        }
+        return my_stl::move(first2, last2, my_stl::move(first1, last1, result));
+    }
+
+    /*****************************************************************************************
+     * rotate
+     * 把[middle, last)换到[first, middle)之前, 返回原来的*first现在的位置.
+     * 逐段交换, 只需要前向迭代器, 每个元素最多交换两次
+     *****************************************************************************************/
+    template <class ForwardIter>
+    ForwardIter rotate(ForwardIter first, ForwardIter middle, ForwardIter last) {
+        if (first == middle)
+            return last;
+        if (middle == last)
+            return first;
+        auto next = middle;
+        while (true) {
+            my_stl::iter_swap(first, next);
+            ++first;
+            if (++next == last)
+                break;
+            if (first == middle)
+                middle = next;
+        }
+        auto result = first;
+        /* 剩下[first, middle)和[middle, last)两段还要交换 */
+        next = middle;
+        while (first != middle) {
+            my_stl::iter_swap(first, next);
+            ++first;
+            if (++next == last)
+                next = middle;
+            else if (first == middle)
+                middle = next;
+        }
+        return result;
+    }
+
+    /*****************************************************************************************
+     * inplace_merge
+     * [first, middle)和[middle, last)各自有序, 合并成一个有序区间, 稳定.
+     * 优先用temporary_buffer: 较短的一段能放进缓冲区时移出去再合并回来, O(n)次比较;
+     * 缓冲区不够时按二分切开, 用rotate交换中间两段后递归. 完全拿不到缓冲区时全部用rotate, O(nlogn)
+     *****************************************************************************************/
+    /* 不用缓冲区的合并 */
+    template <class BidIter, class Distance, class Compare>
+    void merge_without_buffer(BidIter first, BidIter middle, BidIter last,
+                              Distance len1, Distance len2, Compare comp) {
+        while (len1 != 0 && len2 != 0) {
+            if (len1 + len2 == 2) {
+                if (comp(*middle, *first))
+                    my_stl::iter_swap(first, middle);
+                return;
+            }
+            auto first_cut = first;
+            auto second_cut = middle;
+            Distance len11, len22;
+            if (len1 > len2) {
+                len11 = len1 / 2;
+                my_stl::advance(first_cut, len11);
+                second_cut = my_stl::lower_bound(middle, last, *first_cut, comp);
+                len22 = my_stl::distance(middle, second_cut);
+            }
+            else {
+                len22 = len2 / 2;
+                my_stl::advance(second_cut, len22);
+                first_cut = my_stl::upper_bound(first, middle, *second_cut, comp);
+                len11 = my_stl::distance(first, first_cut);
+            }
+            auto new_middle = my_stl::rotate(first_cut, middle, second_cut);
+            my_stl::merge_without_buffer(first, first_cut, new_middle, len11, len22, comp);
+            /* 右半部分不递归 */
+            first = new_middle;
+            middle = second_cut;
+            len1 -= len11;
+            len2 -= len22;
+        }
+    }
+
+    /* 较短的一段能放进缓冲区时借缓冲区搬动, 否则退回rotate */
+    template <class BidIter, class Pointer, class Distance>
+    BidIter rotate_adaptive(BidIter first, BidIter middle, BidIter last,
+                            Distance len1, Distance len2, Pointer buffer, Distance buffer_size) {
+        if (len1 > len2 && len2 <= buffer_size) {
+            if (len2 == 0)
+                return first;
+            auto buffer_end = my_stl::move(middle, last, buffer);
+            my_stl::move_backward(first, middle, last);
+            return my_stl::move(buffer, buffer_end, first);
+        }
+        if (len1 <= buffer_size) {
+            if (len1 == 0)
+                return last;
+            auto buffer_end = my_stl::move(first, middle, buffer);
+            my_stl::move(middle, last, first);
+            return my_stl::move_backward(buffer, buffer_end, last);
+        }
+        return my_stl::rotate(first, middle, last);
+    }
+
+    template <class BidIter, class Pointer, class Distance, class Compare>
+    void merge_adaptive(BidIter first, BidIter middle, BidIter last, Distance len1, Distance len2,
+                        Pointer buffer, Distance buffer_size, Compare comp) {
+        if (len1 <= len2 && len1 <= buffer_size) {
+            /* 前一段移到缓冲区, 从前往后合并; 后一段剩下的已经在原位 */
+            auto buf = buffer;
+            auto buffer_end = my_stl::move(first, middle, buffer);
+            for (; buf != buffer_end && middle != last; ++first) {
+                if (comp(*middle, *buf)) {
+                    *first = my_stl::move(*middle);
+                    ++middle;
+                }
+                else {
+                    *first = my_stl::move(*buf);
+                    ++buf;
+                }
+            }
+            my_stl::move(buf, buffer_end, first);
+        }
+        else if (len2 <= buffer_size) {
+            /* 后一段移到缓冲区, 从后往前合并; 前一段剩下的已经在原位 */
+            auto buffer_end = my_stl::move(middle, last, buffer);
+            while (first != middle && buffer != buffer_end) {
+                auto prev = middle;
+                --prev;
+                if (comp(*(buffer_end - 1), *prev)) {  /* 相等时后一段的元素放在后面 */
+                    *--last = my_stl::move(*prev);
+                    middle = prev;
+                }
+                else {
+                    *--last = my_stl::move(*--buffer_end);
+                }
+            }
+            my_stl::move_backward(buffer, buffer_end, last);
+        }
+        else {
+            auto first_cut = first;
+            auto second_cut = middle;
+            Distance len11, len22;
+            if (len1 > len2) {
+                len11 = len1 / 2;
+                my_stl::advance(first_cut, len11);
+                second_cut = my_stl::lower_bound(middle, last, *first_cut, comp);
+                len22 = my_stl::distance(middle, second_cut);
+            }
+            else {
+                len22 = len2 / 2;
+                my_stl::advance(second_cut, len22);
+                first_cut = my_stl::upper_bound(first, middle, *second_cut, comp);
+                len11 = my_stl::distance(first, first_cut);
+            }
+            auto new_middle = my_stl::rotate_adaptive(first_cut, middle, second_cut, len1 - len11, len22,
+                                                      buffer, buffer_size);
+            my_stl::merge_adaptive(first, first_cut, new_middle, len11, len22, buffer, buffer_size, comp);
+            my_stl::merge_adaptive(new_middle, second_cut, last, len1 - len11, len2 - len22,
+                                   buffer, buffer_size, comp);
+        }
+    }
+
+    template <class BidIter, class Compare>
+    void inplace_merge(BidIter first, BidIter middle, BidIter last, Compare comp) {
+        typedef typename iterator_traits<BidIter>::value_type      value_type;
+        typedef typename iterator_traits<BidIter>::difference_type Distance;
+        if (first == middle || middle == last)
+            return;
+        const Distance len1 = my_stl::distance(first, middle);
+        const Distance len2 = my_stl::distance(middle, last);
+        /* 缓冲区只需要放下较短的一段 */
+        temporary_buffer<BidIter, value_type> buf(len1 <= len2 ? first : middle, len1 <= len2 ? middle : last);
+        if (buf.begin() == nullptr)
+            my_stl::merge_without_buffer(first, middle, last, len1, len2, comp);
+        else
+            my_stl::merge_adaptive(first, middle, last, len1, len2,
+                                   buf.begin(), static_cast<Distance>(buf.size()), comp);
+    }
+
+    template <class BidIter>
+    void inplace_merge(BidIter first, BidIter middle, BidIter last) {
+        my_stl::inplace_merge(first, middle, last,
+                              my_stl::less<typename iterator_traits<BidIter>::value_type>());
+    }
+
+    /*****************************************************************************************
+     * stable_sort
+     * 归并排序, 稳定. 向temporary_buffer申请一半长度的缓冲区:
+     *   拿到一半:  两半各自在缓冲区的帮助下自底向上归并(先对每stable_sort_chunk个元素插入排序), 再合并
+     *   只拿到一部分: 递归切分到能放进缓冲区为止, 合并时用merge_adaptive
+     *   完全拿不到: 递归切分 + merge_without_buffer, O(nlog²n), 不需要额外内存
+     *****************************************************************************************/
+    constexpr ptrdiff_t stable_sort_chunk = 7;              /* 自底向上归并前插入排序的块长 */
+    constexpr ptrdiff_t inplace_stable_sort_threshold = 15; /* 无缓冲区时小于此长度直接插入排序 */
+
+    template <class RandomIter, class Compare>
+    void inplace_stable_sort(RandomIter first, RandomIter last, Compare comp) {
+        if (last - first < inplace_stable_sort_threshold) {
+            my_stl::insertion_sort(first, last, comp);
+            return;
+        }
+        auto middle = first + (last - first) / 2;
+        my_stl::inplace_stable_sort(first, middle, comp);
+        my_stl::inplace_stable_sort(middle, last, comp);
+        my_stl::merge_without_buffer(first, middle, last, middle - first, last - middle, comp);
+    }
+
+    /* 把[first, last)中相邻的长为step的两段合并到result */
+    template <class RandomIter1, class RandomIter2, class Distance, class Compare>
+    void merge_sort_loop(RandomIter1 first, RandomIter1 last, RandomIter2 result, Distance step, Compare comp) {
+        const Distance two_step = 2 * step;
+        while (last - first >= two_step) {
+            result = my_stl::move_merge(first, first + step, first + step, first + two_step, result, comp);
+            first += two_step;
+        }
+        step = my_stl::min(static_cast<Distance>(last - first), step);
+        my_stl::move_merge(first, first + step, first + step, last, result, comp);
+    }
+
+    /* 自底向上归并, 在区间和缓冲区之间来回, 缓冲区至少和区间一样长 */
+    template <class RandomIter, class Pointer, class Compare>
+    void merge_sort_with_buffer(RandomIter first, RandomIter last, Pointer buffer, Compare comp) {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        const Distance len = last - first;
+        const Pointer buffer_last = buffer + len;
+
+        Distance step = stable_sort_chunk;
+        for (auto p = first; p != last; ) {
+            auto q = last - p > step ? p + step : last;
+            my_stl::insertion_sort(p, q, comp);
+            p = q;
+        }
+        while (step < len) {
+            my_stl::merge_sort_loop(first, last, buffer, step, comp);
+            step *= 2;
+            my_stl::merge_sort_loop(buffer, buffer_last, first, step, comp);
+            step *= 2;
+        }
+    }
+
+    template <class RandomIter, class Pointer, class Distance, class Compare>
+    void stable_sort_adaptive(RandomIter first, RandomIter last, Pointer buffer, Distance buffer_size,
+                              Compare comp) {
+        const Distance len = (last - first + 1) / 2;
+        const RandomIter middle = first + len;
+        if (len > buffer_size) {
+            my_stl::stable_sort_adaptive(first, middle, buffer, buffer_size, comp);
+            my_stl::stable_sort_adaptive(middle, last, buffer, buffer_size, comp);
+        }
+        else {
+            my_stl::merge_sort_with_buffer(first, middle, buffer, comp);
+            my_stl::merge_sort_with_buffer(middle, last, buffer, comp);
+        }
+        my_stl::merge_adaptive(first, middle, last, static_cast<Distance>(middle - first),
+                               static_cast<Distance>(last - middle), buffer, buffer_size, comp);
+    }
+
+    template <class RandomIter, class Compare>
+    void stable_sort(RandomIter first, RandomIter last, Compare comp) {
+        typedef typename iterator_traits<RandomIter>::value_type      value_type;
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        if (last - first < 2)
+            return;
+        temporary_buffer<RandomIter, value_type> buf(first, first + (last - first + 1) / 2);
+        if (buf.begin() == nullptr)
+            my_stl::inplace_stable_sort(first, last, comp);
+        else
+            my_stl::stable_sort_adaptive(first, last, buf.begin(), static_cast<Distance>(buf.size()), comp);
+    }
+
+    template <class RandomIter>
+    void stable_sort(RandomIter first, RandomIter last) {
+        my_stl::stable_sort(first, last, my_stl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /*****************************************************************************************
+     * radix_sort
+     * 按字节从低到高的LSD基数排序, 每一趟把元素按当前字节分配到temporary_buffer里, 下一趟再分配回来.
+     * 先一次性统计所有字节的直方图, 某个字节在所有元素上都相同时跳过这一趟.
+     * 键由radix_traits<T>::key转换成无符号整数, 保证无符号整数的顺序就是原来的顺序:
+     *   无符号整数     原样
+     *   有符号整数     翻转符号位
+     *   float/double   正数翻转符号位, 负数全部取反(IEEE 754), -0.0排在+0.0之前, NaN按位排在两端
+     *   pair<K, V>     只用first的键, 排序是稳定的, first相同的元素保持原来的先后顺序
+     * 要求区间是连续存储的(my_stl::vector的迭代器, 原生指针).
+     * 拿不到和区间一样大的临时缓冲区时改用stable_sort, pair仍然保持稳定.
+     *****************************************************************************************/
+    constexpr ptrdiff_t radix_insertion_threshold = 64;   /* 小于此长度直接插入排序 */
+
+    template <class T, class = void>
+    struct radix_traits {};
+
+    template <class T>
+    struct radix_traits<T, typename std::enable_if<std::is_integral<T>::value &&
+                                                   std::is_unsigned<T>::value>::type> {
+        typedef T key_type;
+        static key_type key(T x) noexcept {return x;}
+    };
+
+    template <class T>
+    struct radix_traits<T, typename std::enable_if<std::is_integral<T>::value &&
+                                                   std::is_signed<T>::value>::type> {
+        typedef typename std::make_unsigned<T>::type key_type;
+        static key_type key(T x) noexcept {
+            return static_cast<key_type>(static_cast<key_type>(x) ^ (key_type(1) << (sizeof(T) * 8 - 1)));
+        }
+    };
+
+    template <>
+    struct radix_traits<float> {
+        typedef uint32_t key_type;
+        static key_type key(float x) noexcept {
+            key_type k;
+            std::memcpy(&k, &x, sizeof(k));
+            return (k & 0x80000000u) ? ~k : (k | 0x80000000u);
+        }
+    };
+
+    template <>
+    struct radix_traits<double> {
+        typedef uint64_t key_type;
+        static key_type key(double x) noexcept {
+            key_type k;
+            std::memcpy(&k, &x, sizeof(k));
+            return (k & 0x8000000000000000ull) ? ~k : (k | 0x8000000000000000ull);
+        }
+    };
+
+    template <class K, class V>
+    struct radix_traits<my_stl::pair<K, V>, typename std::enable_if<
+            sizeof(typename radix_traits<K>::key_type) != 0>::type> {
+        typedef typename radix_traits<K>::key_type key_type;
+        static key_type key(const my_stl::pair<K, V> &x) noexcept {return radix_traits<K>::key(x.first);}
+    };
+
+    /* 按键比较, 用于小区间的插入排序和缓冲区不足时的回退 */
+    template <class T>
+    struct radix_key_less {
+        bool operator()(const T &lhs, const T &rhs) const {
+            return radix_traits<T>::key(lhs) < radix_traits<T>::key(rhs);
+        }
+    };
+
+    /* 每一趟把src按第byte个字节分配到dst, count是这个字节的直方图 */
+    template <class T>
+    void radix_scatter(T *src, T *src_end, T *dst, const size_t *count, unsigned byte) {
+        typedef radix_traits<T> traits;
+        size_t offset[256];
+        size_t sum = 0;
+        for (int b = 0; b < 256; ++b) {
+            offset[b] = sum;
+            sum += count[b];
+        }
+        const unsigned shift = byte * 8;
+        for (; src != src_end; ++src)
+            dst[offset[(traits::key(*src) >> shift) & 0xff]++] = my_stl::move(*src);
+    }
+
+    template <class T>
+    void radix_sort_aux(T *first, T *last) {
+        typedef radix_traits<T> traits;
+        typedef typename traits::key_type key_type;
+        enum { key_bytes = sizeof(key_type) };
+
+        const ptrdiff_t len = last - first;
+        if (len < radix_insertion_threshold) {
+            my_stl::insertion_sort(first, last, radix_key_less<T>());
+            return;
+        }
+
+        temporary_buffer<T*, T> buf(first, last);
+        if (buf.size() != len) {
+            my_stl::stable_sort(first, last, radix_key_less<T>());
+            return;
+        }
+
+        /* 一次遍历统计所有字节的直方图 */
+        size_t count[key_bytes][256] = {};
+        for (auto p = first; p != last; ++p) {
+            const key_type k = traits::key(*p);
+            for (unsigned byte = 0; byte < key_bytes; ++byte)
+                ++count[byte][(k >> (byte * 8)) & 0xff];
+        }
+
+        T *src = first;
+        T *dst = buf.begin();
+        const key_type k0 = traits::key(*first);
+        for (unsigned byte = 0; byte < key_bytes; ++byte) {
+            /* 所有元素这个字节都相同, 分配之后顺序不变 */
+            if (count[byte][(k0 >> (byte * 8)) & 0xff] == static_cast<size_t>(len))
+                continue;
+            my_stl::radix_scatter(src, src + len, dst, count[byte], byte);
+            my_stl::swap(src, dst);
+        }
+        /* 做了奇数趟, 结果在缓冲区里 */
+        if (src != first)
+            my_stl::move(src, src + len, first);
+    }
+
+    template <class RandomIter>
+    void radix_sort(RandomIter first, RandomIter last) {
+        if (last - first > 1)
+            my_stl::radix_sort_aux(&*first, &*first + (last - first));
+    }
+}
+
+#endif //MY_STL_ALGO_H
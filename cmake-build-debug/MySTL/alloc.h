@@ -0,0 +1,518 @@
+//
+// Created by 陈燊 on 2021/12/8.
+//
+
+#ifndef MY_STL_ALLOC_H
+#define MY_STL_ALLOC_H
+
+#include <new>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "algobase.h"
+#include "allocator.h"
+#include "construct.h"
+#include "util.h"
+
+/*
+ * 参考《STL源码剖析》中SGI STL的两级空间配置器
+ * 第一级malloc_alloc直接使用malloc/realloc/free(大区块用mmap/mremap), 见下方说明.
+ * 第二级pool_alloc:
+ * 小于等于POOL_MAX_BYTES的区块按POOL_ALIGN上调成若干个大小等级(size class),
+ * 每个等级维护一条自由链表(free list), 释放的区块挂回链表供下次分配复用;
+ * 链表为空时从内存池中一次切出POOL_NOBJS个区块, 内存池不足时再向::operator new要一大块(chunk).
+ * 大于POOL_MAX_BYTES的区块直接交给::operator new / ::operator delete.
+ *
+ * 与SGI不同的是, 自由链表和内存池是每个线程独享的(thread_local), 分配和回收都不需要加锁;
+ * 线程退出时把手里的空闲区块交还给全局仓库, 其它线程refill时会优先从仓库取.
+ * 线程的thread_cache析构之后(例如静态或全局的list在退出时释放结点, 或者在别的thread_local的析构函数里释放),
+ * deallocate把区块直接挂到仓库, allocate先从仓库取, 仓库也没有就向malloc_alloc要;
+ * 仓库本身永不析构, 进程退出的任何阶段都可以使用.
+ * 和SGI一样, 申请来的chunk在进程结束前不会归还给系统.
+ */
+
+namespace my_stl {
+    /*****************************************************************************************
+     * malloc_alloc
+     * 对应SGI STL的第一级配置器, 直接使用malloc/realloc/free, 并提供reallocate:
+     * realloc能在原地向后扩展就不搬运, 不能时由它负责复制字节.
+     * Linux上不小于MALLOC_MAP_BYTES的大区块直接mmap, 扩展时用mremap重新映射页表,
+     * 数据不需要复制, 也不会出现新旧两份空间同时占用物理内存的峰值.
+     *****************************************************************************************/
+    enum { MALLOC_MAP_BYTES = 1 << 20 };                        /* 超过1MB的区块走mmap */
+
+    class malloc_alloc {
+    public:
+        static void* allocate(size_t bytes);
+        static void deallocate(void *ptr, size_t bytes) noexcept;
+        /* 把old_bytes大小的区块调整为new_bytes, 前min(old_bytes, new_bytes)个字节保持不变 */
+        static void* reallocate(void *ptr, size_t old_bytes, size_t new_bytes);
+
+    private:
+#if defined(__linux__)
+        static bool use_map(size_t bytes) {return bytes >= static_cast<size_t>(MALLOC_MAP_BYTES);}
+        static size_t map_size(size_t bytes) {
+            static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            return (bytes + page - 1) & ~(page - 1);
+        }
+#else
+        static bool use_map(size_t) {return false;}
+        static size_t map_size(size_t bytes) {return bytes;}
+#endif
+    };
+
+    inline void* malloc_alloc::allocate(size_t bytes) {
+        if (bytes == 0)
+            return nullptr;
+#if defined(__linux__)
+        if (use_map(bytes)) {
+            void *p = ::mmap(nullptr, map_size(bytes), PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED)
+                throw std::bad_alloc();
+            return p;
+        }
+#endif
+        void *p = std::malloc(bytes);
+        if (p == nullptr)
+            throw std::bad_alloc();
+        return p;
+    }
+
+    inline void malloc_alloc::deallocate(void *ptr, size_t bytes) noexcept {
+        if (ptr == nullptr)
+            return;
+#if defined(__linux__)
+        if (use_map(bytes)) {
+            ::munmap(ptr, map_size(bytes));
+            return;
+        }
+#endif
+        (void)bytes;
+        std::free(ptr);
+    }
+
+    inline void* malloc_alloc::reallocate(void *ptr, size_t old_bytes, size_t new_bytes) {
+        if (ptr == nullptr)
+            return allocate(new_bytes);
+        if (new_bytes == 0) {
+            deallocate(ptr, old_bytes);
+            return nullptr;
+        }
+#if defined(__linux__)
+        if (use_map(old_bytes) && use_map(new_bytes)) {
+            /* 只改页表, 必要时内核把映射挪到新的虚拟地址 */
+            void *p = ::mremap(ptr, map_size(old_bytes), map_size(new_bytes), MREMAP_MAYMOVE);
+            if (p == MAP_FAILED)
+                throw std::bad_alloc();
+            return p;
+        }
+#endif
+        if (!use_map(old_bytes) && !use_map(new_bytes)) {
+            void *p = std::realloc(ptr, new_bytes);
+            if (p == nullptr)
+                throw std::bad_alloc();
+            return p;
+        }
+        /* 跨越了malloc和mmap的分界, 只能重新分配再复制 */
+        void *p = allocate(new_bytes);
+        std::memcpy(p, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+        deallocate(ptr, old_bytes);
+        return p;
+    }
+
+    /*****************************************************************************************
+     * malloc_allocator
+     * 内存来自malloc_alloc. 提供reallocate, vector在元素可平凡重定位时会用它原地扩容:
+     *   my_stl::vector<int, my_stl::malloc_allocator<int>> v;
+     * 只支持对齐要求不超过max_align_t的型别.
+     *****************************************************************************************/
+    template <class T>
+    class malloc_allocator {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned type in malloc_allocator\n");
+
+    public:
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef const T*    const_pointer;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        typedef std::true_type  is_always_equal;
+
+        template <class U>
+        struct rebind {typedef malloc_allocator<U> other;};
+
+    public:
+        malloc_allocator() noexcept = default;
+        template <class U>
+        malloc_allocator(const malloc_allocator<U>&) noexcept {}
+
+        static T* allocate(size_type n) {
+            return static_cast<T*>(malloc_alloc::allocate(n * sizeof(T)));
+        }
+
+        static void deallocate(T *ptr, size_type n) {
+            malloc_alloc::deallocate(ptr, n * sizeof(T));
+        }
+
+        /* 按字节搬运, 调用者保证[ptr, ptr + old_n)上的对象可平凡重定位 */
+        static T* reallocate(T *ptr, size_type old_n, size_type new_n) {
+            return static_cast<T*>(malloc_alloc::reallocate(ptr, old_n * sizeof(T), new_n * sizeof(T)));
+        }
+    };
+
+    template <class T, class U>
+    bool operator==(const malloc_allocator<T>&, const malloc_allocator<U>&) noexcept {return true;}
+
+    template <class T, class U>
+    bool operator!=(const malloc_allocator<T>&, const malloc_allocator<U>&) noexcept {return false;}
+
+    /*****************************************************************************************
+     * pool_alloc
+     *****************************************************************************************/
+    enum { POOL_ALIGN = 8 };                                    /* 小型区块的上调边界 */
+    enum { POOL_MAX_BYTES = 128 };                              /* 小型区块的上限 */
+    enum { POOL_NFREELISTS = POOL_MAX_BYTES / POOL_ALIGN };     /* 自由链表的个数 */
+    enum { POOL_NOBJS = 20 };                                   /* 每次refill切出的区块数 */
+
+    /* 自由链表的结点, 区块空闲时借用区块本身存放next指针 */
+    union pool_obj {
+        union pool_obj *next;
+        char data[1];
+    };
+
+    template <int inst>
+    class pool_alloc_template {
+    private:
+        /* 每个线程独享的自由链表和内存池 */
+        struct thread_cache {
+            pool_obj *free_list[POOL_NFREELISTS];
+            char *start_free;                                   /* 内存池起始位置 */
+            char *end_free;                                     /* 内存池结束位置 */
+            size_t heap_size;                                   /* 累计向系统申请的大小 */
+
+            thread_cache() : start_free(nullptr), end_free(nullptr), heap_size(0) {
+                for (int i = 0; i < POOL_NFREELISTS; ++i)
+                    free_list[i] = nullptr;
+                live_cache() = this;
+            }
+            ~thread_cache() {
+                live_cache() = nullptr;
+                cache_destroyed() = true;
+                give_back(*this);
+            }
+        };
+
+        /* 全局仓库, 存放退出线程交还的空闲区块 */
+        struct depot {
+            std::mutex mtx;
+            pool_obj *free_list[POOL_NFREELISTS];
+
+            depot() {
+                for (int i = 0; i < POOL_NFREELISTS; ++i)
+                    free_list[i] = nullptr;
+            }
+        };
+
+    public:
+        static void* allocate(size_t bytes);
+        static void deallocate(void *ptr, size_t bytes);
+
+    private:
+        /*
+         * 本线程的thread_cache, 已经析构时返回nullptr.
+         * 平凡类型的thread_local没有析构也不需要初始化检查, 线程退出的全过程中都可以读,
+         * 常见路径只读一次live_cache()
+         */
+        static thread_cache* cache() {
+            thread_cache *c = live_cache();
+            if (c != nullptr)
+                return c;
+            if (cache_destroyed())
+                return nullptr;
+            static thread_local thread_cache tc;
+            return &tc;
+        }
+        static thread_cache*& live_cache() {static thread_local thread_cache *c = nullptr; return c;}
+        static bool& cache_destroyed() {static thread_local bool dead = false; return dead;}
+        /* 故意不析构: 静态对象析构时还可能有结点要还回来 */
+        static depot& global() {static depot *d = new depot; return *d;}
+
+        /* bytes上调至POOL_ALIGN的倍数 */
+        static size_t round_up(size_t bytes) {
+            return (bytes + POOL_ALIGN - 1) & ~(static_cast<size_t>(POOL_ALIGN) - 1);
+        }
+
+        /* 根据区块大小选择第几号自由链表, 从0开始 */
+        static size_t freelist_index(size_t bytes) {
+            return (bytes + POOL_ALIGN - 1) / POOL_ALIGN - 1;
+        }
+
+        static void* refill(thread_cache &c, size_t n);
+        static char* chunk_alloc(thread_cache &c, size_t size, size_t &nobjs);
+        static void give_back(thread_cache &c);
+        static void* depot_allocate(size_t bytes);
+        static void depot_deallocate(void *ptr, size_t bytes);
+    };
+
+    typedef pool_alloc_template<0> pool_alloc;
+
+    /* 分配bytes大小的空间 */
+    template <int inst>
+    void* pool_alloc_template<inst>::allocate(size_t bytes) {
+        if (bytes > static_cast<size_t>(POOL_MAX_BYTES))
+            return ::operator new(bytes);
+        thread_cache *c = cache();
+        if (c == nullptr)
+            return depot_allocate(bytes);
+        pool_obj *&head = c->free_list[freelist_index(bytes)];
+        if (head == nullptr)
+            return refill(*c, round_up(bytes));
+        pool_obj *result = head;
+        head = result->next;
+        return result;
+    }
+
+    /* 释放ptr所指的bytes大小的空间, 小型区块挂回自由链表 */
+    template <int inst>
+    void pool_alloc_template<inst>::deallocate(void *ptr, size_t bytes) {
+        if (ptr == nullptr)
+            return;
+        if (bytes > static_cast<size_t>(POOL_MAX_BYTES)) {
+            ::operator delete(ptr);
+            return;
+        }
+        thread_cache *c = cache();
+        if (c == nullptr) {
+            depot_deallocate(ptr, bytes);
+            return;
+        }
+        pool_obj *&head = c->free_list[freelist_index(bytes)];
+        pool_obj *q = static_cast<pool_obj*>(ptr);
+        q->next = head;
+        head = q;
+    }
+
+    /* 自由链表为空时重新填充, n已经上调过, 返回一个区块给调用者 */
+    template <int inst>
+    void* pool_alloc_template<inst>::refill(thread_cache &c, size_t n) {
+        const size_t index = freelist_index(n);
+        /* 先看看仓库里有没有别的线程留下的区块 */
+        depot &d = global();
+        {
+            std::lock_guard<std::mutex> lock(d.mtx);
+            if (d.free_list[index] != nullptr) {
+                pool_obj *result = d.free_list[index];
+                c.free_list[index] = result->next;
+                d.free_list[index] = nullptr;
+                return result;
+            }
+        }
+
+        size_t nobjs = POOL_NOBJS;
+        char *chunk = chunk_alloc(c, n, nobjs);
+        if (nobjs == 1)
+            return chunk;
+        /* 第一块返回给调用者, 其余串成自由链表 */
+        pool_obj *result = reinterpret_cast<pool_obj*>(chunk);
+        pool_obj *cur = reinterpret_cast<pool_obj*>(chunk + n);
+        c.free_list[index] = cur;
+        for (size_t i = 2; i < nobjs; ++i) {
+            pool_obj *next = reinterpret_cast<pool_obj*>(reinterpret_cast<char*>(cur) + n);
+            cur->next = next;
+            cur = next;
+        }
+        cur->next = nullptr;
+        return result;
+    }
+
+    /* 从内存池中取出nobjs个size大小的区块, 不足时nobjs会被改小 */
+    template <int inst>
+    char* pool_alloc_template<inst>::chunk_alloc(thread_cache &c, size_t size, size_t &nobjs) {
+        const size_t total_bytes = size * nobjs;
+        const size_t bytes_left = static_cast<size_t>(c.end_free - c.start_free);
+        char *result;
+        if (bytes_left >= total_bytes) {
+            /* 内存池剩余空间完全满足需求 */
+            result = c.start_free;
+            c.start_free += total_bytes;
+            return result;
+        }
+        if (bytes_left >= size) {
+            /* 至少能供应一个区块 */
+            nobjs = bytes_left / size;
+            result = c.start_free;
+            c.start_free += size * nobjs;
+            return result;
+        }
+        /* 一个都供应不了, 先把残余零头挂到合适的自由链表上 */
+        if (bytes_left > 0) {
+            pool_obj *&head = c.free_list[freelist_index(bytes_left)];
+            reinterpret_cast<pool_obj*>(c.start_free)->next = head;
+            head = reinterpret_cast<pool_obj*>(c.start_free);
+        }
+        const size_t bytes_to_get = 2 * total_bytes + round_up(c.heap_size >> 4);
+        try {
+            c.start_free = static_cast<char*>(::operator new(bytes_to_get));
+        } catch (...) {
+            /* 系统内存不足, 从更大的自由链表中借一个区块当作内存池 */
+            c.start_free = c.end_free = nullptr;
+            for (size_t i = size; i <= static_cast<size_t>(POOL_MAX_BYTES); i += POOL_ALIGN) {
+                pool_obj *&head = c.free_list[freelist_index(i)];
+                if (head != nullptr) {
+                    c.start_free = reinterpret_cast<char*>(head);
+                    head = head->next;
+                    c.end_free = c.start_free + i;
+                    return chunk_alloc(c, size, nobjs);
+                }
+            }
+            throw;
+        }
+        c.heap_size += bytes_to_get;
+        c.end_free = c.start_free + bytes_to_get;
+        return chunk_alloc(c, size, nobjs);
+    }
+
+    /* 本线程的thread_cache已经析构: 从仓库取一个区块, 仓库没有就直接向malloc_alloc要 */
+    template <int inst>
+    void* pool_alloc_template<inst>::depot_allocate(size_t bytes) {
+        depot &d = global();
+        {
+            std::lock_guard<std::mutex> lock(d.mtx);
+            pool_obj *&head = d.free_list[freelist_index(bytes)];
+            if (head != nullptr) {
+                pool_obj *result = head;
+                head = result->next;
+                return result;
+            }
+        }
+        return malloc_alloc::allocate(round_up(bytes));
+    }
+
+    /* 本线程的thread_cache已经析构: 区块挂到仓库, 以后由别的线程复用 */
+    template <int inst>
+    void pool_alloc_template<inst>::depot_deallocate(void *ptr, size_t bytes) {
+        depot &d = global();
+        std::lock_guard<std::mutex> lock(d.mtx);
+        pool_obj *&head = d.free_list[freelist_index(bytes)];
+        pool_obj *q = static_cast<pool_obj*>(ptr);
+        q->next = head;
+        head = q;
+    }
+
+    /* 线程退出时把内存池零头和自由链表交还给全局仓库 */
+    template <int inst>
+    void pool_alloc_template<inst>::give_back(thread_cache &c) {
+        size_t bytes_left = static_cast<size_t>(c.end_free - c.start_free);
+        while (bytes_left > 0) {
+            const size_t n = my_stl::min(bytes_left, static_cast<size_t>(POOL_MAX_BYTES));
+            pool_obj *&head = c.free_list[freelist_index(n)];
+            reinterpret_cast<pool_obj*>(c.start_free)->next = head;
+            head = reinterpret_cast<pool_obj*>(c.start_free);
+            c.start_free += n;
+            bytes_left -= n;
+        }
+        c.start_free = c.end_free = nullptr;
+
+        depot &d = global();
+        std::lock_guard<std::mutex> lock(d.mtx);
+        for (int i = 0; i < POOL_NFREELISTS; ++i) {
+            pool_obj *head = c.free_list[i];
+            if (head == nullptr)
+                continue;
+            pool_obj *tail = head;
+            while (tail->next != nullptr)
+                tail = tail->next;
+            tail->next = d.free_list[i];
+            d.free_list[i] = head;
+            c.free_list[i] = nullptr;
+        }
+    }
+
+    /*****************************************************************************************
+     * pool_allocator
+     * 接口与allocator<T>一致, 内存来自pool_alloc, 适合链表结点这类频繁分配释放的小对象.
+     * 对齐要求超过POOL_ALIGN的型别直接走::operator new.
+     *****************************************************************************************/
+    template <class T>
+    class pool_allocator {
+    public:
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef const T*    const_pointer;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        /* 内存池是全局的, 任意两个pool_allocator都相等 */
+        typedef std::true_type  is_always_equal;
+
+        template <class U>
+        struct rebind {typedef pool_allocator<U> other;};
+
+    public:
+        pool_allocator() noexcept = default;
+        template <class U>
+        pool_allocator(const pool_allocator<U>&) noexcept {}
+
+        /* 分配内存空间 */
+        static T* allocate() {return allocate(1);}
+        static T* allocate(size_type n);
+
+        /* 释放内存, 不带n的版本对应allocate() */
+        static void deallocate(T *ptr) {deallocate(ptr, 1);}
+        static void deallocate(T *ptr, size_type n);
+
+        /* 构造对象 */
+        static void construct(T *ptr) {my_stl::construct(ptr);}
+        static void construct(T *ptr, const T &value) {my_stl::construct(ptr, value);}
+        static void construct(T *ptr, T &&value) {my_stl::construct(ptr, my_stl::move(value));}
+
+        template <class ... Args>
+        static void construct(T *ptr, Args &&...args) {my_stl::construct(ptr, my_stl::forward<Args>(args)...);}
+
+        /* 析构对象 */
+        static void destroy(T *ptr) {my_stl::destroy(ptr);}
+        static void destroy(T *first, T *last) {my_stl::destroy(first, last);}
+
+    private:
+        static constexpr bool use_pool() {return alignof(T) <= static_cast<size_t>(POOL_ALIGN);}
+    };
+
+    template <class T>
+    T* pool_allocator<T>::allocate(size_type n) {
+        if (n == 0)
+            return nullptr;
+        if (!use_pool())
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(pool_alloc::allocate(n * sizeof(T)));
+    }
+
+    template <class T>
+    void pool_allocator<T>::deallocate(T *ptr, size_type n) {
+        if (ptr == nullptr)
+            return;
+        if (!use_pool()) {
+            ::operator delete(ptr);
+            return;
+        }
+        pool_alloc::deallocate(ptr, n * sizeof(T));
+    }
+
+    template <class T, class U>
+    bool operator==(const pool_allocator<T>&, const pool_allocator<U>&) noexcept {return true;}
+
+    template <class T, class U>
+    bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&) noexcept {return false;}
+}
+
+#endif //MY_STL_ALLOC_H
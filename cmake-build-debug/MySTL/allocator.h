@@ -10,6 +10,10 @@
  * 头文件包含模版类allocator，空间配置器，用于管理内存分配，对象构造和析构
  * 其中申请和释放内存调用标准库的operator new 和 operator delete
  * 构造和析构调用construct.h中封装的各种构造和析构函数.
+ *
+ * 另外包含allocator_traits和alloc_holder, 容器通过它们持有并使用任意(可能有状态的)空间配置器:
+ *   allocator_traits  统一的分发接口, 配置器没有提供的成员用默认实现补上
+ *   alloc_holder      容器的基类, 空的配置器利用空基类优化(EBO)不占空间
  */
 
 namespace my_stl {
@@ -24,7 +28,17 @@ namespace my_stl {
         typedef size_t      size_type;
         typedef ptrdiff_t   difference_type;
 
+        /* 无状态, 任意两个allocator都相等 */
+        typedef std::true_type  is_always_equal;
+
+        template <class U>
+        struct rebind {typedef allocator<U> other;};
+
     public:
+        allocator() noexcept = default;
+        template <class U>
+        allocator(const allocator<U>&) noexcept {}
+
         /* 分配内存空间 */
         static T* allocate();
         static T* allocate(size_type n);
@@ -105,6 +119,259 @@ namespace my_stl {
         /* 调用下层，下层会构造第三参数激活型别推导 */
         my_stl::destroy(first, last);
     }
+
+    template <class T, class U>
+    bool operator==(const allocator<T>&, const allocator<U>&) noexcept {return true;}
+
+    template <class T, class U>
+    bool operator!=(const allocator<T>&, const allocator<U>&) noexcept {return false;}
+
+    /*****************************************************************************************
+     * allocator_traits
+     * 容器不直接调用配置器的静态函数, 而是通过allocator_traits作用于配置器对象.
+     * 配置器缺少的成员(construct, destroy, rebind, propagate_on_* ...)由这里给出默认实现.
+     * 容器的迭代器是原生指针, 所以这里的pointer固定为value_type*.
+     *****************************************************************************************/
+    template <class...>
+    struct make_void {typedef void type;};
+
+    /* 探测Alloc的成员型别Name, 没有就用Default */
+    #define MYSTL_ALLOC_TRAIT_MEMBER(Name, Default)                                    \
+    template <class Alloc, class = void>                                               \
+    struct alloc_##Name {typedef Default type;};                                       \
+    template <class Alloc>                                                             \
+    struct alloc_##Name<Alloc, typename make_void<typename Alloc::Name>::type>        \
+    {typedef typename Alloc::Name type;};
+
+    MYSTL_ALLOC_TRAIT_MEMBER(propagate_on_container_copy_assignment, std::false_type)
+    MYSTL_ALLOC_TRAIT_MEMBER(propagate_on_container_move_assignment, std::false_type)
+    MYSTL_ALLOC_TRAIT_MEMBER(propagate_on_container_swap, std::false_type)
+    MYSTL_ALLOC_TRAIT_MEMBER(is_always_equal, typename std::is_empty<Alloc>::type)
+
+    #undef MYSTL_ALLOC_TRAIT_MEMBER
+
+    /* rebind: 优先用Alloc::rebind<U>::other, 否则把Alloc<T, Args...>的第一个参数换成U */
+    template <class Alloc, class U>
+    struct alloc_rebind_first;
+
+    template <template <class, class...> class Alloc, class T, class... Args, class U>
+    struct alloc_rebind_first<Alloc<T, Args...>, U> {typedef Alloc<U, Args...> type;};
+
+    template <class Alloc, class U, class = void>
+    struct alloc_rebind : public alloc_rebind_first<Alloc, U> {};
+
+    template <class Alloc, class U>
+    struct alloc_rebind<Alloc, U, typename make_void<typename Alloc::template rebind<U>::other>::type> {
+        typedef typename Alloc::template rebind<U>::other type;
+    };
+
+    /* 探测a.construct(p, args...)和a.destroy(p)是否可用 */
+    template <class Alloc, class Ptr, class... Args>
+    struct alloc_has_construct {
+    private:
+        template <class A>
+        static long check(int, decltype(std::declval<A&>().construct(std::declval<Ptr>(),
+                                                                     std::declval<Args>()...), 0) = 0);
+        template <class A>
+        static char check(...);
+    public:
+        static const bool value = sizeof(check<Alloc>(0)) == sizeof(long);
+    };
+
+    template <class Alloc, class Ptr>
+    struct alloc_has_destroy {
+    private:
+        template <class A>
+        static long check(int, decltype(std::declval<A&>().destroy(std::declval<Ptr>()), 0) = 0);
+        template <class A>
+        static char check(...);
+    public:
+        static const bool value = sizeof(check<Alloc>(0)) == sizeof(long);
+    };
+
+    template <class Alloc>
+    struct alloc_has_select_copy {
+    private:
+        template <class A>
+        static long check(int, decltype(std::declval<const A&>().select_on_container_copy_construction(), 0) = 0);
+        template <class A>
+        static char check(...);
+    public:
+        static const bool value = sizeof(check<Alloc>(0)) == sizeof(long);
+    };
+
+    /* 配置器是否提供reallocate(p, old_n, new_n): 按字节扩展/收缩已分配的空间, 见alloc.h的malloc_allocator */
+    template <class Alloc>
+    struct alloc_has_reallocate {
+    private:
+        template <class A>
+        static long check(int, decltype(std::declval<A&>().reallocate(
+                std::declval<typename A::value_type*>(), size_t(), size_t()), 0) = 0);
+        template <class A>
+        static char check(...);
+    public:
+        static const bool value = sizeof(check<Alloc>(0)) == sizeof(long);
+    };
+
+    template <class Alloc>
+    struct allocator_traits {
+        typedef Alloc                               allocator_type;
+        typedef typename Alloc::value_type          value_type;
+        typedef value_type*                         pointer;
+        typedef const value_type*                   const_pointer;
+        typedef size_t                              size_type;
+        typedef ptrdiff_t                           difference_type;
+
+        typedef typename alloc_propagate_on_container_copy_assignment<Alloc>::type
+                propagate_on_container_copy_assignment;
+        typedef typename alloc_propagate_on_container_move_assignment<Alloc>::type
+                propagate_on_container_move_assignment;
+        typedef typename alloc_propagate_on_container_swap<Alloc>::type
+                propagate_on_container_swap;
+        typedef typename alloc_is_always_equal<Alloc>::type
+                is_always_equal;
+
+        template <class U>
+        using rebind_alloc = typename alloc_rebind<Alloc, U>::type;
+
+        template <class U>
+        using rebind_traits = allocator_traits<rebind_alloc<U>>;
+
+        static pointer allocate(Alloc &a, size_type n) {return a.allocate(n);}
+        static void deallocate(Alloc &a, pointer p, size_type n) {a.deallocate(p, n);}
+
+        /* 只有has_reallocate为真时才能调用, 空间里的字节被原样保留(可能搬到新地址) */
+        typedef m_bool_constant<alloc_has_reallocate<Alloc>::value> has_reallocate;
+        static pointer reallocate(Alloc &a, pointer p, size_type old_n, size_type new_n) {
+            return a.reallocate(p, old_n, new_n);
+        }
+
+        /* 配置器提供了对应的construct就用它的, 否则placement new */
+        template <class U, class... Args>
+        static void construct(Alloc &a, U *p, Args &&...args) {
+            construct_dispatch(m_bool_constant<alloc_has_construct<Alloc, U*, Args&&...>::value>(),
+                               a, p, my_stl::forward<Args>(args)...);
+        }
+
+        template <class U>
+        static void destroy(Alloc &a, U *p) {
+            destroy_dispatch(m_bool_constant<alloc_has_destroy<Alloc, U*>::value>(), a, p);
+        }
+
+        /* 析构[first, last), 配置器没有destroy时交给my_stl::destroy判断是否需要析构 */
+        template <class U>
+        static void destroy(Alloc &a, U *first, U *last) {
+            destroy_range_dispatch(m_bool_constant<alloc_has_destroy<Alloc, U*>::value>(), a, first, last);
+        }
+
+        static size_type max_size(const Alloc&) noexcept {
+            return static_cast<size_type>(-1) / sizeof(value_type);
+        }
+
+        static Alloc select_on_container_copy_construction(const Alloc &a) {
+            return select_dispatch(m_bool_constant<alloc_has_select_copy<Alloc>::value>(), a);
+        }
+
+    private:
+        template <class U, class... Args>
+        static void construct_dispatch(m_true_type, Alloc &a, U *p, Args &&...args) {
+            a.construct(p, my_stl::forward<Args>(args)...);
+        }
+
+        template <class U, class... Args>
+        static void construct_dispatch(m_false_type, Alloc &, U *p, Args &&...args) {
+            my_stl::construct(p, my_stl::forward<Args>(args)...);
+        }
+
+        template <class U>
+        static void destroy_dispatch(m_true_type, Alloc &a, U *p) {a.destroy(p);}
+
+        template <class U>
+        static void destroy_dispatch(m_false_type, Alloc &, U *p) {my_stl::destroy(p);}
+
+        template <class U>
+        static void destroy_range_dispatch(m_true_type, Alloc &a, U *first, U *last) {
+            for (; first != last; ++first)
+                a.destroy(first);
+        }
+
+        template <class U>
+        static void destroy_range_dispatch(m_false_type, Alloc &, U *first, U *last) {
+            my_stl::destroy(first, last);
+        }
+
+        static Alloc select_dispatch(m_true_type, const Alloc &a) {return a.select_on_container_copy_construction();}
+        static Alloc select_dispatch(m_false_type, const Alloc &a) {return a;}
+    };
+
+    /* 容器拷贝赋值, 移动赋值, swap时按propagate_on_container_*决定是否传播配置器 */
+    template <class Alloc>
+    void alloc_on_copy(Alloc &to, const Alloc &from, m_true_type) {to = from;}
+    template <class Alloc>
+    void alloc_on_copy(Alloc &, const Alloc &, m_false_type) {}
+
+    template <class Alloc>
+    void alloc_on_move(Alloc &to, Alloc &from, m_true_type) {to = my_stl::move(from);}
+    template <class Alloc>
+    void alloc_on_move(Alloc &, Alloc &, m_false_type) {}
+
+    template <class Alloc>
+    void alloc_on_swap(Alloc &lhs, Alloc &rhs, m_true_type) {my_stl::swap(lhs, rhs);}
+    template <class Alloc>
+    void alloc_on_swap(Alloc &, Alloc &, m_false_type) {}
+
+    template <class Alloc>
+    void alloc_on_copy(Alloc &to, const Alloc &from) {
+        alloc_on_copy(to, from, m_bool_constant<
+                allocator_traits<Alloc>::propagate_on_container_copy_assignment::value>());
+    }
+
+    template <class Alloc>
+    void alloc_on_move(Alloc &to, Alloc &from) {
+        alloc_on_move(to, from, m_bool_constant<
+                allocator_traits<Alloc>::propagate_on_container_move_assignment::value>());
+    }
+
+    template <class Alloc>
+    void alloc_on_swap(Alloc &lhs, Alloc &rhs) {
+        alloc_on_swap(lhs, rhs, m_bool_constant<
+                allocator_traits<Alloc>::propagate_on_container_swap::value>());
+    }
+
+    /* 两个配置器是否可以互相释放对方分配的内存 */
+    template <class Alloc>
+    bool alloc_equal(const Alloc &lhs, const Alloc &rhs) {
+        return allocator_traits<Alloc>::is_always_equal::value || lhs == rhs;
+    }
+
+    /*****************************************************************************************
+     * alloc_holder
+     * 容器私有继承它来保存配置器对象. 空且非final的配置器走空基类优化, 不增加容器大小.
+     *****************************************************************************************/
+    template <class Alloc, bool = std::is_empty<Alloc>::value && !std::is_final<Alloc>::value>
+    class alloc_holder : private Alloc {
+    public:
+        alloc_holder() = default;
+        explicit alloc_holder(const Alloc &a) : Alloc(a) {}
+        explicit alloc_holder(Alloc &&a) : Alloc(my_stl::move(a)) {}
+
+        Alloc& alloc_ref() noexcept {return *this;}
+        const Alloc& alloc_ref() const noexcept {return *this;}
+    };
+
+    template <class Alloc>
+    class alloc_holder<Alloc, false> {
+    public:
+        alloc_holder() = default;
+        explicit alloc_holder(const Alloc &a) : a_(a) {}
+        explicit alloc_holder(Alloc &&a) : a_(my_stl::move(a)) {}
+
+        Alloc& alloc_ref() noexcept {return a_;}
+        const Alloc& alloc_ref() const noexcept {return a_;}
+
+    private:
+        Alloc a_;
+    };
 }
 
 
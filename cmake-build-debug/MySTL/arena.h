@@ -0,0 +1,182 @@
+//
+// Created by 陈燊 on 2021/12/10.
+//
+
+#ifndef MY_STL_ARENA_H
+#define MY_STL_ARENA_H
+
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include "allocator.h"
+#include "util.h"
+
+/*
+ * 单调内存资源(monotonic buffer resource)和基于它的配置器arena_allocator
+ *
+ * monotonic_buffer_resource 从一串内存块(block)中顺序切出空间(bump allocate), deallocate什么也不做,
+ * 当前块用完就向::operator new再要一块, 块的大小成倍增长. 所有内存在release()或析构时一次性归还.
+ * 适合"一个请求内建很多短命容器, 请求结束时全部丢弃"的场景: 释放时不再是每个结点一次::operator delete,
+ * 而是每个块一次.
+ *
+ * arena_allocator<T> 只保存一个指向资源的指针, 可以交给vector/list作为有状态配置器使用:
+ *   my_stl::monotonic_buffer_resource arena;
+ *   my_stl::vector<int, my_stl::arena_allocator<int>> v{my_stl::arena_allocator<int>(&arena)};
+ * 注意资源的生命周期必须长于使用它的容器.
+ */
+
+namespace my_stl {
+    class monotonic_buffer_resource {
+    public:
+        /* initial_size: 第一个块的大小 */
+        explicit monotonic_buffer_resource(size_t initial_size = 4096) noexcept
+                : blocks_(nullptr), cur_(nullptr), end_(nullptr),
+                  next_size_(initial_size < min_block ? size_t(min_block) : initial_size),
+                  initial_size_(next_size_), upstream_bytes_(0),
+                  buffer_(nullptr), buffer_size_(0) {}
+
+        /* 先使用调用者提供的缓冲区(比如栈上的数组), 用完再向系统申请, 缓冲区本身不会被释放 */
+        monotonic_buffer_resource(void *buffer, size_t size) noexcept
+                : blocks_(nullptr), cur_(static_cast<char*>(buffer)), end_(static_cast<char*>(buffer) + size),
+                  next_size_(size < min_block ? size_t(min_block) : size * 2),
+                  initial_size_(next_size_), upstream_bytes_(0),
+                  buffer_(static_cast<char*>(buffer)), buffer_size_(size) {}
+
+        monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+        monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+        ~monotonic_buffer_resource() {release();}
+
+    public:
+        void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+        /* 单调资源不回收单个区块 */
+        void deallocate(void*, size_t, size_t = alignof(std::max_align_t)) noexcept {}
+
+        /* 一次性归还所有块, 之后可以继续使用 */
+        void release() noexcept;
+
+        /* 向系统申请的总字节数 */
+        size_t upstream_bytes() const noexcept {return upstream_bytes_;}
+
+    private:
+        /* 每个块头部记录下一个块, 形成单链表 */
+        struct block_header {
+            block_header *next;
+            size_t        size;
+        };
+
+        static constexpr size_t min_block = 256;      /* 块的最小大小 */
+
+        void new_block(size_t bytes, size_t alignment);
+
+        static char* align_up(char *p, size_t alignment) {
+            const auto v = reinterpret_cast<std::uintptr_t>(p);
+            return reinterpret_cast<char*>((v + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1));
+        }
+
+    private:
+        block_header *blocks_;          /* 已申请的块链表 */
+        char         *cur_;             /* 当前块的空闲起点 */
+        char         *end_;             /* 当前块的结束位置 */
+        size_t        next_size_;       /* 下一个块的大小 */
+        size_t        initial_size_;    /* release之后重新从这个大小开始 */
+        size_t        upstream_bytes_;
+        char         *buffer_;          /* 调用者提供的初始缓冲区 */
+        size_t        buffer_size_;
+    };
+
+    /* 在当前块中切出bytes大小的空间, 不够再换新块 */
+    inline void* monotonic_buffer_resource::allocate(size_t bytes, size_t alignment) {
+        char *p = align_up(cur_, alignment);
+        if (cur_ == nullptr || p > end_ || static_cast<size_t>(end_ - p) < bytes) {
+            new_block(bytes, alignment);
+            p = align_up(cur_, alignment);
+        }
+        cur_ = p + bytes;
+        return p;
+    }
+
+    /* 申请一个能容纳bytes的新块, 块大小成倍增长, 超大的请求单独成块 */
+    inline void monotonic_buffer_resource::new_block(size_t bytes, size_t alignment) {
+        const size_t header = sizeof(block_header);
+        /* 超大的请求加上块头和对齐会回绕成一个很小的数 */
+        if (bytes > SIZE_MAX - header - alignment)
+            throw std::bad_alloc();
+        size_t need = header + bytes + alignment;
+        size_t size = next_size_ < need ? need : next_size_;
+        auto block = static_cast<block_header*>(::operator new(size));
+        block->next = blocks_;
+        block->size = size;
+        blocks_ = block;
+        upstream_bytes_ += size;
+        cur_ = reinterpret_cast<char*>(block) + header;
+        end_ = reinterpret_cast<char*>(block) + size;
+        if (next_size_ < size)
+            next_size_ = size;
+        if (next_size_ <= SIZE_MAX / 2)
+            next_size_ *= 2;
+    }
+
+    inline void monotonic_buffer_resource::release() noexcept {
+        while (blocks_ != nullptr) {
+            block_header *next = blocks_->next;
+            ::operator delete(blocks_);
+            blocks_ = next;
+        }
+        cur_ = buffer_;
+        end_ = buffer_ == nullptr ? nullptr : buffer_ + buffer_size_;
+        next_size_ = initial_size_;
+        upstream_bytes_ = 0;
+    }
+
+    /*****************************************************************************************
+     * arena_allocator
+     * 从monotonic_buffer_resource分配内存, deallocate是空操作.
+     * 配置器之间比较的是所指向的资源, 拷贝/移动/swap时不传播(与std::pmr的约定一致).
+     *****************************************************************************************/
+    template <class T>
+    class arena_allocator {
+    public:
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef const T*    const_pointer;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        template <class U>
+        struct rebind {typedef arena_allocator<U> other;};
+
+    public:
+        explicit arena_allocator(monotonic_buffer_resource *r) noexcept : resource_(r) {}
+        template <class U>
+        arena_allocator(const arena_allocator<U> &rhs) noexcept : resource_(rhs.resource()) {}
+
+        T* allocate(size_type n) {
+            if (n == 0)
+                return nullptr;
+            return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T*, size_type) noexcept {}
+
+        monotonic_buffer_resource* resource() const noexcept {return resource_;}
+
+    private:
+        monotonic_buffer_resource *resource_;
+    };
+
+    template <class T, class U>
+    bool operator==(const arena_allocator<T> &lhs, const arena_allocator<U> &rhs) noexcept {
+        return lhs.resource() == rhs.resource();
+    }
+
+    template <class T, class U>
+    bool operator!=(const arena_allocator<T> &lhs, const arena_allocator<U> &rhs) noexcept {
+        return !(lhs == rhs);
+    }
+}
+
+#endif //MY_STL_ARENA_H
@@ -0,0 +1,381 @@
+//
+// Created by 陈燊 on 2021/12/15.
+//
+
+#ifndef MY_STL_BIT_VECTOR_H
+#define MY_STL_BIT_VECTOR_H
+#include <cstdint>
+#include <initializer_list>
+#include "vector.h"
+#include "exceptdef.h"
+#include <iostream>
+
+/*
+ * bit_vector
+ * 紧凑存储的布尔向量, 每个64位字(word)存放64个标志, 代替被禁用的vector<bool>.
+ * 除了逐位的访问(operator[]返回代理对象reference), 还提供按字处理的批量操作:
+ *   count()                          每个字一次popcount
+ *   find_first() / find_next(pos)    跳过全0的字, 用ctz定位, 找不到返回size()
+ *   &= |= ^= flip()                  逐字运算, 两个bit_vector的长度不同时抛出length_error
+ *   any() / none() / all()
+ * set/reset/flip和&= |= ^=是没有跨迭代依赖的逐字循环, -O2/-O3下编译器会把它们向量化(SSE/AVX);
+ * count用4路累加打破依赖链. find_*和any遇到非0字就提前退出, 不会被自动向量化,
+ * 它们每次把4个字或在一起再判断, 全0的区域每4个字只有一次分支. 都不依赖特定指令集的intrinsics.
+ *
+ * 不变式: 最后一个字里超出size()的位始终为0, count, ==, find_*都依赖这一点.
+ */
+
+namespace my_stl {
+    /* 字级别的位运算, GCC/Clang使用内建函数, 会编译成popcnt/tzcnt指令 */
+    inline size_t popcount64(uint64_t x) noexcept {
+#if defined(__GNUC__)
+        return static_cast<size_t>(__builtin_popcountll(x));
+#else
+        x = x - ((x >> 1) & 0x5555555555555555ull);
+        x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return static_cast<size_t>((x * 0x0101010101010101ull) >> 56);
+#endif
+    }
+
+    /* x不能为0 */
+    inline size_t ctz64(uint64_t x) noexcept {
+#if defined(__GNUC__)
+        return static_cast<size_t>(__builtin_ctzll(x));
+#else
+        size_t n = 0;
+        while ((x & 1) == 0) {
+            x >>= 1;
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    template <class Alloc = my_stl::allocator<uint64_t>>
+    class bit_vector {
+    public:
+        typedef uint64_t                                    word_type;
+        typedef bool                                        value_type;
+        typedef size_t                                      size_type;
+        typedef bool                                        const_reference;
+        typedef Alloc                                       allocator_type;
+
+        enum { word_bits = 64 };
+
+        /* operator[]返回的代理对象, 行为类似bool& */
+        class reference {
+        public:
+            reference(word_type *word, word_type mask) noexcept : word_(word), mask_(mask) {}
+
+            operator bool() const noexcept {return (*word_ & mask_) != 0;}
+            reference& operator=(bool x) noexcept {
+                if (x)
+                    *word_ |= mask_;
+                else
+                    *word_ &= ~mask_;
+                return *this;
+            }
+            reference& operator=(const reference &rhs) noexcept {return *this = static_cast<bool>(rhs);}
+            void flip() noexcept {*word_ ^= mask_;}
+
+        private:
+            word_type *word_;
+            word_type mask_;
+        };
+
+    private:
+        my_stl::vector<word_type, Alloc> words_;
+        size_type size_;
+
+    public:
+        bit_vector() noexcept : size_(0) {}
+        explicit bit_vector(const allocator_type &a) noexcept : words_(a), size_(0) {}
+        explicit bit_vector(size_type n, bool value = false, const allocator_type &a = allocator_type())
+                : words_(words_for(n), value ? ~word_type(0) : word_type(0), a), size_(n) {
+            clear_tail();
+        }
+        bit_vector(std::initializer_list<bool> list, const allocator_type &a = allocator_type())
+                : words_(words_for(list.size()), word_type(0), a), size_(list.size()) {
+            size_type i = 0;
+            for (bool b : list)
+                set(i++, b);
+        }
+
+    public:
+        /* 容量操作 */
+        bool empty() const noexcept {return size_ == 0;}
+        size_type size() const noexcept {return size_;}
+        size_type capacity() const noexcept {return words_.capacity() * word_bits;}
+        size_type num_words() const noexcept {return words_.size();}
+        void reverse(size_type n) {words_.reverse(words_for(n));}
+
+        /* 元素访问 */
+        reference operator[](size_type i) noexcept {
+            MYSTL_DEBUG(i < size_);
+            return reference(&words_[i / word_bits], mask(i));
+        }
+        const_reference operator[](size_type i) const noexcept {return test(i);}
+
+        bool test(size_type i) const noexcept {
+            MYSTL_DEBUG(i < size_);
+            return (words_[i / word_bits] & mask(i)) != 0;
+        }
+        bool at(size_type i) const {
+            THROW_OUT_OF_RANGE_IF(!(i < size_), "bit_vector::at() subscript out of range.\n");
+            return test(i);
+        }
+
+        void set(size_type i, bool value = true) noexcept {(*this)[i] = value;}
+        void reset(size_type i) noexcept {(*this)[i] = false;}
+        void flip(size_type i) noexcept {(*this)[i].flip();}
+
+        /* 底层的字, 最后一个字超出size()的位为0 */
+        word_type* data() noexcept {return words_.data();}
+        const word_type* data() const noexcept {return words_.data();}
+
+        /* 修改 */
+        void push_back(bool value) {
+            if (size_ % word_bits == 0)
+                words_.push_back(0);
+            ++size_;
+            set(size_ - 1, value);
+        }
+        void pop_back() noexcept {
+            MYSTL_DEBUG(!empty());
+            reset(size_ - 1);
+            --size_;
+            if (size_ % word_bits == 0)
+                words_.pop_back();
+        }
+        void resize(size_type n, bool value = false);
+        void clear() noexcept {
+            words_.clear();
+            size_ = 0;
+        }
+        void swap(bit_vector &rhs) noexcept {
+            words_.swap(rhs.words_);
+            my_stl::swap(size_, rhs.size_);
+        }
+
+        /* 整体置位/清零/取反 */
+        bit_vector& set() noexcept;
+        bit_vector& reset() noexcept;
+        bit_vector& flip() noexcept;
+
+        /* 批量位运算, 长度不同时抛出length_error */
+        bit_vector& operator&=(const bit_vector &rhs);
+        bit_vector& operator|=(const bit_vector &rhs);
+        bit_vector& operator^=(const bit_vector &rhs);
+        bit_vector operator~() const {
+            bit_vector r(*this);
+            r.flip();
+            return r;
+        }
+
+        /* 统计与查找 */
+        size_type count() const noexcept;
+        bool any() const noexcept;
+        bool none() const noexcept {return !any();}
+        bool all() const noexcept {return count() == size_;}
+
+        /* 第一个/pos之后第一个为1的位置, 没有则返回size() */
+        size_type find_first() const noexcept {return find_from_word(0);}
+        size_type find_next(size_type pos) const noexcept;
+
+        bool operator==(const bit_vector &rhs) const noexcept {
+            return size_ == rhs.size_ && words_ == rhs.words_;
+        }
+        bool operator!=(const bit_vector &rhs) const noexcept {return !(*this == rhs);}
+
+        void print(const char *ends = "");
+
+    private:
+        static size_type words_for(size_type n) noexcept {return (n + word_bits - 1) / word_bits;}
+        static word_type mask(size_type i) noexcept {return word_type(1) << (i % word_bits);}
+
+        /* 把最后一个字中超出size()的位清零, 维持不变式 */
+        void clear_tail() noexcept {
+            const size_type extra = size_ % word_bits;
+            if (extra != 0)
+                words_.back() &= (word_type(1) << extra) - 1;
+        }
+
+        /* 从第w个字开始找第一个非0字 */
+        size_type find_from_word(size_type w) const noexcept;
+    };
+
+    /**************************************************************************************
+     * 实现
+     **************************************************************************************/
+    template <class Alloc>
+    void bit_vector<Alloc>::resize(size_type n, bool value) {
+        if (n > size_ && value) {
+            /* 先把当前最后一个字里新增的位补上 */
+            const size_type extra = size_ % word_bits;
+            if (extra != 0)
+                words_.back() |= ~word_type(0) << extra;
+        }
+        words_.resize(words_for(n), value ? ~word_type(0) : word_type(0));
+        size_ = n;
+        clear_tail();
+    }
+
+    template <class Alloc>
+    bit_vector<Alloc>& bit_vector<Alloc>::set() noexcept {
+        word_type *w = words_.data();
+        const size_type nw = words_.size();
+        for (size_type i = 0; i < nw; ++i)
+            w[i] = ~word_type(0);
+        clear_tail();
+        return *this;
+    }
+
+    template <class Alloc>
+    bit_vector<Alloc>& bit_vector<Alloc>::reset() noexcept {
+        word_type *w = words_.data();
+        const size_type nw = words_.size();
+        for (size_type i = 0; i < nw; ++i)
+            w[i] = 0;
+        return *this;
+    }
+
+    template <class Alloc>
+    bit_vector<Alloc>& bit_vector<Alloc>::flip() noexcept {
+        word_type *w = words_.data();
+        const size_type nw = words_.size();
+        for (size_type i = 0; i < nw; ++i)
+            w[i] = ~w[i];
+        clear_tail();
+        return *this;
+    }
+
+    template <class Alloc>
+    bit_vector<Alloc>& bit_vector<Alloc>::operator&=(const bit_vector &rhs) {
+        THROW_LENGTH_ERROR_IF(size_ != rhs.size_, "bit_vector::operator&= size mismatch.\n");
+        word_type *w = words_.data();
+        const word_type *r = rhs.words_.data();
+        const size_type nw = words_.size();
+        for (size_type i = 0; i < nw; ++i)
+            w[i] &= r[i];
+        return *this;
+    }
+
+    template <class Alloc>
+    bit_vector<Alloc>& bit_vector<Alloc>::operator|=(const bit_vector &rhs) {
+        THROW_LENGTH_ERROR_IF(size_ != rhs.size_, "bit_vector::operator|= size mismatch.\n");
+        word_type *w = words_.data();
+        const word_type *r = rhs.words_.data();
+        const size_type nw = words_.size();
+        for (size_type i = 0; i < nw; ++i)
+            w[i] |= r[i];
+        return *this;
+    }
+
+    template <class Alloc>
+    bit_vector<Alloc>& bit_vector<Alloc>::operator^=(const bit_vector &rhs) {
+        THROW_LENGTH_ERROR_IF(size_ != rhs.size_, "bit_vector::operator^= size mismatch.\n");
+        word_type *w = words_.data();
+        const word_type *r = rhs.words_.data();
+        const size_type nw = words_.size();
+        for (size_type i = 0; i < nw; ++i)
+            w[i] ^= r[i];
+        return *this;
+    }
+
+    /* 4路累加打破依赖链, 方便流水线和向量化 */
+    template <class Alloc>
+    typename bit_vector<Alloc>::size_type bit_vector<Alloc>::count() const noexcept {
+        const word_type *w = words_.data();
+        const size_type nw = words_.size();
+        size_type c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+        size_type i = 0;
+        for (; i + 4 <= nw; i += 4) {
+            c0 += popcount64(w[i]);
+            c1 += popcount64(w[i + 1]);
+            c2 += popcount64(w[i + 2]);
+            c3 += popcount64(w[i + 3]);
+        }
+        for (; i < nw; ++i)
+            c0 += popcount64(w[i]);
+        return c0 + c1 + c2 + c3;
+    }
+
+    template <class Alloc>
+    bool bit_vector<Alloc>::any() const noexcept {
+        return find_from_word(0) != size_;
+    }
+
+    /* 一次检查4个字的或, 全0的区域跳得很快 */
+    template <class Alloc>
+    typename bit_vector<Alloc>::size_type bit_vector<Alloc>::find_from_word(size_type w) const noexcept {
+        const word_type *p = words_.data();
+        const size_type nw = words_.size();
+        for (; w + 4 <= nw; w += 4) {
+            if ((p[w] | p[w + 1] | p[w + 2] | p[w + 3]) != 0)
+                break;
+        }
+        for (; w < nw; ++w) {
+            if (p[w] != 0)
+                return w * word_bits + ctz64(p[w]);
+        }
+        return size_;
+    }
+
+    template <class Alloc>
+    typename bit_vector<Alloc>::size_type bit_vector<Alloc>::find_next(size_type pos) const noexcept {
+        ++pos;
+        if (pos >= size_)
+            return size_;
+        const size_type w = pos / word_bits;
+        /* 当前字中pos之前的位屏蔽掉 */
+        const word_type cur = words_[w] & (~word_type(0) << (pos % word_bits));
+        if (cur != 0)
+            return w * word_bits + ctz64(cur);
+        return find_from_word(w + 1);
+    }
+
+    template <class Alloc>
+    void bit_vector<Alloc>::print(const char *ends) {
+        for (size_type i = 0; i < size_; ++i)
+            std::cout << test(i) << ends;
+        std::cout << std::endl;
+    }
+
+    /* 重载运算符 */
+    template <class Alloc>
+    bit_vector<Alloc> operator&(const bit_vector<Alloc> &lhs, const bit_vector<Alloc> &rhs) {
+        bit_vector<Alloc> r(lhs);
+        r &= rhs;
+        return r;
+    }
+
+    template <class Alloc>
+    bit_vector<Alloc> operator|(const bit_vector<Alloc> &lhs, const bit_vector<Alloc> &rhs) {
+        bit_vector<Alloc> r(lhs);
+        r |= rhs;
+        return r;
+    }
+
+    template <class Alloc>
+    bit_vector<Alloc> operator^(const bit_vector<Alloc> &lhs, const bit_vector<Alloc> &rhs) {
+        bit_vector<Alloc> r(lhs);
+        r ^= rhs;
+        return r;
+    }
+
+    template <class Alloc>
+    std::ostream& operator<<(std::ostream &os, const bit_vector<Alloc> &bits) {
+        for (size_t i = 0; i < bits.size(); ++i)
+            os << bits.test(i);
+        os << std::endl;
+        return os;
+    }
+
+    template <class Alloc>
+    void swap(bit_vector<Alloc> &lhs, bit_vector<Alloc> &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+}
+
+#endif //MY_STL_BIT_VECTOR_H
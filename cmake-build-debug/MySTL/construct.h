@@ -25,6 +25,12 @@ namespace my_stl {
         ::new ( (void*)ptr ) T();
     }
 
+    /* 默认初始化(没有括号), 平凡类型不会被清零 */
+    template <class T>
+    void construct_default(T *ptr) {
+        ::new ( (void*)ptr ) T;
+    }
+
     template <class T1, class T2>
     void construct(T1 *ptr, const T2 &value) {
         /* 调用placement_new，定点拷贝构造*/
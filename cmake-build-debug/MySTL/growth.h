@@ -0,0 +1,59 @@
+//
+// Created by 陈燊 on 2021/12/12.
+//
+
+#ifndef MY_STL_GROWTH_H
+#define MY_STL_GROWTH_H
+
+#include <cstddef>
+
+/*
+ * 容器的增长策略, 作为vector的第三个模板参数在编译期选定.
+ * 策略只需要提供一个静态函数:
+ *   static size_t new_cap(size_t cap, size_t need, size_t max);
+ * cap为当前容量, need为放下所有元素至少需要的容量(need <= max), 返回值必须落在[need, max]之内.
+ * 只影响扩容; 构造和reserve都按请求的大小精确分配, 空容器不分配任何空间.
+ *
+ *   growth_factor<Num, Den, Min>  每次扩到Num/Den倍, 至少Min个元素(默认1.5倍, 至少16个)
+ *   growth_exact                  恰好扩到need, 适合一次性批量构建后不再增长的vector
+ *   growth_pow2<Min>              扩到不小于need的2的幂, 与按2的幂分级的配置器配合不浪费空间
+ */
+
+namespace my_stl {
+    template <size_t Num = 3, size_t Den = 2, size_t Min = 16>
+    struct growth_factor {
+        static_assert(Den > 0 && Num > Den, "growth factor must be greater than 1\n");
+
+        static size_t new_cap(size_t cap, size_t need, size_t max) {
+            /* cap * Num / Den会溢出或者超过max时直接取max */
+            size_t grown = cap > max / Num * Den ? max : cap / Den * Num + cap % Den * Num / Den;
+            if (grown < Min)
+                grown = Min > max ? max : Min;
+            return grown < need ? need : grown;
+        }
+    };
+
+    struct growth_exact {
+        static size_t new_cap(size_t, size_t need, size_t) {return need;}
+    };
+
+    template <size_t Min = 1>
+    struct growth_pow2 {
+        static_assert(Min > 0 && (Min & (Min - 1)) == 0, "minimum capacity must be a power of two\n");
+
+        static size_t new_cap(size_t, size_t need, size_t max) {
+            size_t n = Min;
+            while (n < need) {
+                if (n > max / 2)
+                    return max;
+                n <<= 1;
+            }
+            return n > max ? max : n;
+        }
+    };
+
+    /* vector默认的增长策略, 与原来的经验算法一致 */
+    typedef growth_factor<3, 2, 16> default_growth;
+}
+
+#endif //MY_STL_GROWTH_H
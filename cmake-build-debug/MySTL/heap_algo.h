@@ -0,0 +1,131 @@
+//
+// Created by 陈燊 on 2021/12/20.
+//
+
+#ifndef MY_STL_HEAP_ALGO_H
+#define MY_STL_HEAP_ALGO_H
+
+#include "iterator.h"
+#include "util.h"
+#include "functional.h"
+
+/*
+ * 堆算法: push_heap, pop_heap, make_heap, sort_heap
+ * 参考《STL源码剖析》, 作用于随机访问迭代器区间, 默认是以operator<比较的大根堆,
+ * 每个函数都有一个接受比较函数comp的重载.
+ * sort(algo.h)在递归过深时用make_heap + sort_heap兜底, 保证O(nlogn).
+ */
+
+namespace my_stl {
+    /*****************************************************************************************
+     * push_heap
+     * [first, last - 1)已经是堆, 把*(last - 1)上浮到合适的位置
+     *****************************************************************************************/
+    template <class RandomIter, class Distance, class T, class Compare>
+    void push_heap_aux(RandomIter first, Distance hole, Distance top, T value, Compare comp) {
+        auto parent = (hole - 1) / 2;
+        while (hole > top && comp(*(first + parent), value)) {
+            *(first + hole) = my_stl::move(*(first + parent));
+            hole = parent;
+            parent = (hole - 1) / 2;
+        }
+        *(first + hole) = my_stl::move(value);
+    }
+
+    template <class RandomIter, class Compare>
+    void push_heap(RandomIter first, RandomIter last, Compare comp) {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        if (last - first < 2)
+            return;
+        auto value = my_stl::move(*(last - 1));
+        push_heap_aux(first, static_cast<Distance>(last - first - 1), Distance(0), my_stl::move(value), comp);
+    }
+
+    template <class RandomIter>
+    void push_heap(RandomIter first, RandomIter last) {
+        my_stl::push_heap(first, last, my_stl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /*****************************************************************************************
+     * adjust_heap
+     * 以hole为根的子树除根外满足堆性质, 把value放进去: 先让空洞一路下沉到叶子, 再上浮
+     *****************************************************************************************/
+    template <class RandomIter, class Distance, class T, class Compare>
+    void adjust_heap(RandomIter first, Distance hole, Distance len, T value, Compare comp) {
+        const Distance top = hole;
+        Distance child = 2 * hole + 2;
+        while (child < len) {
+            if (comp(*(first + child), *(first + (child - 1))))
+                --child;
+            *(first + hole) = my_stl::move(*(first + child));
+            hole = child;
+            child = 2 * child + 2;
+        }
+        if (child == len) {
+            /* 只有左孩子 */
+            *(first + hole) = my_stl::move(*(first + (child - 1)));
+            hole = child - 1;
+        }
+        push_heap_aux(first, hole, top, my_stl::move(value), comp);
+    }
+
+    /*****************************************************************************************
+     * pop_heap
+     * 把堆顶移到last - 1, [first, last - 1)重新调整为堆
+     *****************************************************************************************/
+    template <class RandomIter, class Compare>
+    void pop_heap(RandomIter first, RandomIter last, Compare comp) {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        if (last - first < 2)
+            return;
+        --last;
+        auto value = my_stl::move(*last);
+        *last = my_stl::move(*first);
+        my_stl::adjust_heap(first, Distance(0), static_cast<Distance>(last - first), my_stl::move(value), comp);
+    }
+
+    template <class RandomIter>
+    void pop_heap(RandomIter first, RandomIter last) {
+        my_stl::pop_heap(first, last, my_stl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /*****************************************************************************************
+     * make_heap
+     * 从最后一个非叶子结点开始逐个下沉, O(n)
+     *****************************************************************************************/
+    template <class RandomIter, class Compare>
+    void make_heap(RandomIter first, RandomIter last, Compare comp) {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        const Distance len = last - first;
+        if (len < 2)
+            return;
+        for (Distance hole = (len - 2) / 2; ; --hole) {
+            auto value = my_stl::move(*(first + hole));
+            my_stl::adjust_heap(first, hole, len, my_stl::move(value), comp);
+            if (hole == 0)
+                return;
+        }
+    }
+
+    template <class RandomIter>
+    void make_heap(RandomIter first, RandomIter last) {
+        my_stl::make_heap(first, last, my_stl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /*****************************************************************************************
+     * sort_heap
+     * 不断pop_heap, 结束后区间按升序排列
+     *****************************************************************************************/
+    template <class RandomIter, class Compare>
+    void sort_heap(RandomIter first, RandomIter last, Compare comp) {
+        while (last - first > 1)
+            my_stl::pop_heap(first, last--, comp);
+    }
+
+    template <class RandomIter>
+    void sort_heap(RandomIter first, RandomIter last) {
+        my_stl::sort_heap(first, last, my_stl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+}
+
+#endif //MY_STL_HEAP_ALGO_H
@@ -0,0 +1,512 @@
+//
+// Created by 陈燊 on 2021/12/14.
+//
+
+#ifndef MY_STL_INPLACE_VECTOR_H
+#define MY_STL_INPLACE_VECTOR_H
+#include <initializer_list>
+#include <cstring>
+#include <type_traits>
+#include "iterator.h"
+#include "mymemory.h"
+#include "util.h"
+#include "exceptdef.h"
+#include <iostream>
+
+/*
+ * inplace_vector<T, N>
+ * 容量固定为N的vector, 元素全部存放在对象内部, 从不申请堆内存, 也没有配置器.
+ * 接口与my_stl::vector一致(emplace_back, insert, erase, print, operator<<...),
+ * 超过容量时抛出length_error, 迭代器只在插入/删除位置之后失效, 不会因为扩容整体失效.
+ *
+ * 对象里只有元素个数和元素缓冲区, 没有指针:
+ *   T可平凡复制时inplace_vector<T, N>本身也可平凡复制(std::is_trivially_copyable),
+ *   可以放在栈上, 也可以直接memcpy到下一个处理阶段.
+ */
+
+namespace my_stl {
+    /*
+     * inplace_vector_base
+     * 按T是否可平凡复制分成两个版本: 可平凡复制时拷贝, 移动, 析构全部由编译器生成(平凡的),
+     * 否则逐个拷贝/移动/析构已构造的元素.
+     */
+    template <class T, size_t N, bool = std::is_trivially_copyable<T>::value>
+    struct inplace_vector_base {
+        size_t size_;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type buf_[N];
+
+        inplace_vector_base() noexcept : size_(0) {}
+
+        T* ptr() noexcept {return reinterpret_cast<T*>(buf_);}
+        const T* ptr() const noexcept {return reinterpret_cast<const T*>(buf_);}
+    };
+
+    template <class T, size_t N>
+    struct inplace_vector_base<T, N, false> {
+        size_t size_;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type buf_[N];
+
+        inplace_vector_base() noexcept : size_(0) {}
+
+        inplace_vector_base(const inplace_vector_base &rhs) : size_(0) {
+            my_stl::uninitialized_copy(rhs.ptr(), rhs.ptr() + rhs.size_, ptr());
+            size_ = rhs.size_;
+        }
+
+        /* 逐个移动, rhs保留移动后的元素 */
+        inplace_vector_base(inplace_vector_base &&rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+                : size_(0) {
+            my_stl::uninitialized_move(rhs.ptr(), rhs.ptr() + rhs.size_, ptr());
+            size_ = rhs.size_;
+        }
+
+        inplace_vector_base& operator=(const inplace_vector_base &rhs) {
+            if (this != &rhs)
+                assign_from(rhs.ptr(), rhs.size_, m_false_type());
+            return *this;
+        }
+
+        inplace_vector_base& operator=(inplace_vector_base &&rhs) {
+            if (this != &rhs)
+                assign_from(rhs.ptr(), rhs.size_, m_true_type());
+            return *this;
+        }
+
+        ~inplace_vector_base() {my_stl::destroy(ptr(), ptr() + size_);}
+
+        T* ptr() noexcept {return reinterpret_cast<T*>(buf_);}
+        const T* ptr() const noexcept {return reinterpret_cast<const T*>(buf_);}
+
+        /* 共同的部分直接赋值, 多出来的构造或析构; m_true_type表示移动rhs的元素 */
+        void assign_from(const T *first, size_t n, m_false_type) {
+            if (size_ >= n) {
+                my_stl::copy(first, first + n, ptr());
+                my_stl::destroy(ptr() + n, ptr() + size_);
+            }
+            else {
+                my_stl::copy(first, first + size_, ptr());
+                my_stl::uninitialized_copy(first + size_, first + n, ptr() + size_);
+            }
+            size_ = n;
+        }
+
+        void assign_from(T *first, size_t n, m_true_type) {
+            if (size_ >= n) {
+                my_stl::move(first, first + n, ptr());
+                my_stl::destroy(ptr() + n, ptr() + size_);
+            }
+            else {
+                my_stl::move(first, first + size_, ptr());
+                my_stl::uninitialized_move(first + size_, first + n, ptr() + size_);
+            }
+            size_ = n;
+        }
+    };
+
+    template <class T, size_t N>
+    class inplace_vector : private inplace_vector_base<T, N> {
+        static_assert(N > 0, "inplace_vector needs a positive capacity\n");
+        static_assert(!std::is_same<bool, T>::value, "inplace_vector<bool> not in my_stl\n");
+
+    public:
+        typedef T                                           value_type;
+        typedef T*                                          pointer;
+        typedef const T*                                    const_pointer;
+        typedef value_type&                                 reference;
+        typedef const value_type&                           const_reference;
+        typedef size_t                                      size_type;
+        typedef ptrdiff_t                                   difference_type;
+
+        typedef value_type*                                 iterator;
+        typedef const value_type*                           const_iterator;
+        typedef my_stl::reverse_iterator<iterator>          reverse_iterator;
+        typedef my_stl::reverse_iterator<const_iterator>    const_reverse_iterator;
+
+    private:
+        typedef inplace_vector_base<T, N>                   base;
+        using base::size_;
+        using base::ptr;
+
+    public:
+        /* 拷贝, 移动, 析构由inplace_vector_base决定, 这里不声明, 保证可平凡复制 */
+        inplace_vector() noexcept = default;
+
+        explicit inplace_vector(size_type n) {fill_insert(end(), n, value_type());}
+        inplace_vector(size_type n, const value_type &value) {fill_insert(end(), n, value);}
+
+        template<class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        inplace_vector(Iter first, Iter last) {
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+
+        inplace_vector(std::initializer_list<value_type> list) {copy_insert(end(), list.begin(), list.end());}
+
+        inplace_vector& operator=(std::initializer_list<value_type> list) {
+            assign(list.begin(), list.end());
+            return *this;
+        }
+
+    public:
+        /* 迭代器操作 */
+        iterator begin()        noexcept {return ptr();}
+        const_iterator begin()  const noexcept {return ptr();}
+        iterator end()          noexcept {return ptr() + size_;}
+        const_iterator end()    const noexcept {return ptr() + size_;}
+
+        reverse_iterator rbegin()           noexcept {return reverse_iterator(end());}
+        const_reverse_iterator  rbegin()    const noexcept {return const_reverse_iterator(end());}
+        reverse_iterator rend()             noexcept {return reverse_iterator(begin());}
+        const_reverse_iterator rend()       const noexcept {return const_reverse_iterator(begin());}
+
+        const_iterator cbegin()             const noexcept {return begin();}
+        const_iterator cend()               const noexcept {return end();}
+        const_reverse_iterator crbegin()    const noexcept {return rbegin();}
+        const_reverse_iterator crend()      const noexcept {return rend();}
+
+        /* 容量操作, 容量恒为N */
+        bool empty() const noexcept {return size_ == 0;}
+        bool full() const noexcept {return size_ == N;}
+        size_type size() const noexcept {return size_;}
+        static constexpr size_type max_size() noexcept {return N;}
+        static constexpr size_type capacity() noexcept {return N;}
+
+        /* 与vector一致, reverse(n)预留空间; 这里只检查n不超过容量 */
+        void reverse(size_type n) {
+            THROW_LENGTH_ERROR_IF(n > N, "can not larger than capacity() in inplace_vector<T>::reverse(n)");
+        }
+        void shrink_to_fit() noexcept {}
+
+        /* 元素访问操作 */
+        reference operator[](size_type n) {
+            MYSTL_DEBUG(n < size());
+            return ptr()[n];
+        }
+
+        const_reference operator[](size_type n) const {
+            MYSTL_DEBUG(n < size());
+            return ptr()[n];
+        }
+
+        reference at(size_type n) {
+            THROW_OUT_OF_RANGE_IF(!(n < size()), "inplace_vector<T>::at() subscript out of range.\n");
+            return (*this)[n];
+        }
+
+        const_reference at(size_type n) const {
+            THROW_OUT_OF_RANGE_IF(!(n < size()), "inplace_vector<T>::at() subscript out of range.\n");
+            return (*this)[n];
+        }
+
+        reference front() {
+            MYSTL_DEBUG(!empty());
+            return ptr()[0];
+        }
+
+        const_reference front() const {
+            MYSTL_DEBUG(!empty());
+            return ptr()[0];
+        }
+
+        reference back() {
+            MYSTL_DEBUG(!empty());
+            return ptr()[size_ - 1];
+        }
+
+        const_reference back() const {
+            MYSTL_DEBUG(!empty());
+            return ptr()[size_ - 1];
+        }
+
+        pointer data() noexcept {return ptr();}
+        const_pointer data() const noexcept {return ptr();}
+
+        /* assign */
+        template<class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        void assign(Iter first, Iter last) {
+            clear();
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+        void assign(size_type n, const value_type &value) {
+            clear();
+            fill_insert(end(), n, value);
+        }
+        void assign(std::initializer_list<value_type> list) {assign(list.begin(), list.end());}
+
+        /* emplace / emplace_back / push_back / pop_back */
+        template<class ...Args>
+        iterator emplace(const_iterator pos, Args &&...args);
+
+        template<class ...Args>
+        void emplace_back(Args &&...args) {
+            THROW_LENGTH_ERROR_IF(size_ == N, "inplace_vector<T>'s size too big..\n");
+            my_stl::construct(end(), my_stl::forward<Args>(args)...);
+            ++size_;
+        }
+
+        void push_back(const value_type &value) {emplace_back(value);}
+        void push_back(value_type &&value) {emplace_back(my_stl::move(value));}
+
+        void pop_back() {
+            MYSTL_DEBUG(!empty());
+            my_stl::destroy(end() - 1);
+            --size_;
+        }
+
+        void print(const char *ends = " ");
+
+        /* insert */
+        template <class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        void insert(const_iterator pos, Iter first, Iter last) {
+            MYSTL_DEBUG(pos >= begin() && pos <= end());
+            copy_insert(const_cast<iterator>(pos), first, last);
+        }
+
+        iterator insert(const_iterator pos, const value_type &value) {return emplace(pos, value);}
+        iterator insert(const_iterator pos, value_type &&value) {return emplace(pos, my_stl::move(value));}
+        iterator insert(const_iterator pos, size_type n, const value_type &value) {
+            MYSTL_DEBUG(pos >= begin() && pos <= end());
+            return fill_insert(const_cast<iterator>(pos), n, value);
+        }
+
+        /* erase / clear */
+        iterator erase(const_iterator pos) {
+            MYSTL_DEBUG(pos >= begin() && pos < end());
+            return erase(pos, pos + 1);
+        }
+        iterator erase(const_iterator first, const_iterator last);
+        void clear() noexcept {
+            my_stl::destroy(begin(), end());
+            size_ = 0;
+        }
+
+        /* resize / reverse */
+        void resize(size_type new_size) {resize(new_size, value_type());}
+        void resize(size_type new_size, const value_type &value) {
+            if (new_size < size_)
+                erase(begin() + new_size, end());
+            else
+                fill_insert(end(), new_size - size_, value);
+        }
+        void reverse() {
+            if (size_ > 1) {
+                for (auto l = begin(), r = end() - 1; l < r; ++l, --r)
+                    my_stl::swap(*l, *r);
+            }
+        }
+
+        /* 元素都在对象内部, 只能逐个交换 */
+        void swap(inplace_vector &rhs);
+
+    private:
+        /* 元素是否可以按字节搬运 */
+        static constexpr bool relocatable() {return is_trivially_relocatable<T>::value;}
+
+        /* 在pos处空出n个未初始化的位置, 返回空出的位置; 只用于可平凡重定位的元素 */
+        void shift_right(iterator pos, size_type n) {
+            std::memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos),
+                         static_cast<size_t>(end() - pos) * sizeof(T));
+        }
+        void shift_left(iterator pos, size_type n) {
+            std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + n),
+                         static_cast<size_t>(end() - pos) * sizeof(T));
+        }
+
+        template <class Iter>
+        void copy_insert(iterator pos, Iter first, Iter last);
+        iterator fill_insert(iterator pos, size_type n, const value_type &value);
+    };
+
+    /**************************************************************************************
+     * 实现
+     **************************************************************************************/
+    template <class T, size_t N>
+    template <class ...Args>
+    typename inplace_vector<T, N>::iterator
+    inplace_vector<T, N>::emplace(const_iterator pos, Args &&...args) {
+        MYSTL_DEBUG(pos >= begin() && pos <= end());
+        iterator x_pos = const_cast<iterator>(pos);
+        if (x_pos == end()) {
+            emplace_back(my_stl::forward<Args>(args)...);
+            return x_pos;
+        }
+        THROW_LENGTH_ERROR_IF(size_ == N, "inplace_vector<T>'s size too big..\n");
+        /* 先构造出新元素, 防止args引用的正是要后移的元素 */
+        value_type value(my_stl::forward<Args>(args)...);
+        if (relocatable()) {
+            shift_right(x_pos, 1);
+            try {
+                my_stl::construct(x_pos, my_stl::move(value));
+            } catch (...) {
+                shift_left(x_pos, 1);
+                throw;
+            }
+        }
+        else {
+            iterator last = end();
+            my_stl::construct(last, my_stl::move(*(last - 1)));
+            my_stl::move_backward(x_pos, last - 1, last);
+            *x_pos = my_stl::move(value);
+        }
+        ++size_;
+        return x_pos;
+    }
+
+    template <class T, size_t N>
+    typename inplace_vector<T, N>::iterator
+    inplace_vector<T, N>::erase(const_iterator first, const_iterator last) {
+        MYSTL_DEBUG(first >= begin() && last <= end() && !(last < first));
+        iterator r = const_cast<iterator>(first);
+        const size_type len = last - first;
+        if (len == 0)
+            return r;
+        if (relocatable()) {
+            my_stl::destroy(r, r + len);
+            size_ -= len;
+            shift_left(r, len);
+        }
+        else {
+            my_stl::destroy(my_stl::move(r + len, end(), r), end());
+            size_ -= len;
+        }
+        return r;
+    }
+
+    template <class T, size_t N>
+    typename inplace_vector<T, N>::iterator
+    inplace_vector<T, N>::fill_insert(iterator pos, size_type n, const value_type &value) {
+        if (n == 0)
+            return pos;
+        THROW_LENGTH_ERROR_IF(n > N - size_, "inplace_vector<T>'s size too big..\n");
+        const value_type value_copy = value;                /* 避免原值被覆盖 */
+        iterator old_end = end();
+        const size_type after_elements = old_end - pos;
+        if (relocatable()) {
+            shift_right(pos, n);
+            try {
+                my_stl::uninitialized_fill_n(pos, n, value_copy);
+            } catch (...) {
+                shift_left(pos, n);
+                throw;
+            }
+            size_ += n;
+        }
+        else if (after_elements > n) {
+            my_stl::uninitialized_move(old_end - n, old_end, old_end);
+            size_ += n;
+            my_stl::move_backward(pos, old_end - n, old_end);
+            my_stl::fill_n(pos, n, value_copy);
+        }
+        else {
+            iterator new_end = my_stl::uninitialized_fill_n(old_end, n - after_elements, value_copy);
+            my_stl::uninitialized_move(pos, old_end, new_end);
+            size_ += n;
+            my_stl::fill_n(pos, after_elements, value_copy);
+        }
+        return pos;
+    }
+
+    template <class T, size_t N>
+    template <class Iter>
+    void inplace_vector<T, N>::copy_insert(iterator pos, Iter first, Iter last) {
+        if (first == last)
+            return;
+        const size_type n = my_stl::distance(first, last);
+        THROW_LENGTH_ERROR_IF(n > N - size_, "inplace_vector<T>'s size too big..\n");
+        iterator old_end = end();
+        const size_type after_elements = old_end - pos;
+        if (relocatable()) {
+            shift_right(pos, n);
+            try {
+                my_stl::uninitialized_copy(first, last, pos);
+            } catch (...) {
+                shift_left(pos, n);
+                throw;
+            }
+            size_ += n;
+        }
+        else if (after_elements > n) {
+            my_stl::uninitialized_move(old_end - n, old_end, old_end);
+            size_ += n;
+            my_stl::move_backward(pos, old_end - n, old_end);
+            my_stl::copy(first, last, pos);
+        }
+        else {
+            auto mid = first;
+            my_stl::advance(mid, after_elements);
+            iterator new_end = my_stl::uninitialized_copy(mid, last, old_end);
+            my_stl::uninitialized_move(pos, old_end, new_end);
+            size_ += n;
+            my_stl::copy(first, mid, pos);
+        }
+    }
+
+    template <class T, size_t N>
+    void inplace_vector<T, N>::swap(inplace_vector &rhs) {
+        if (this == &rhs)
+            return;
+        inplace_vector temp(my_stl::move(rhs));
+        rhs = my_stl::move(*this);
+        *this = my_stl::move(temp);
+    }
+
+    template <class T, size_t N>
+    void inplace_vector<T, N>::print(const char *ends) {
+        for (auto first = begin(); first != end(); ++first)
+            std::cout << *first << ends;
+        std::cout << std::endl;
+    }
+
+    /**************************************************************************************
+    * 重载比较运算符
+    **************************************************************************************/
+    template <class T, size_t N>
+    std::ostream& operator<<(std::ostream &os, const inplace_vector<T, N> &vec) {
+        for (auto it = vec.begin(); it != vec.end(); ++it) {
+            os << *it << " ";
+        }
+        os << std::endl;
+        return os;
+    }
+
+    template <class T, size_t N>
+    bool operator==(const inplace_vector<T, N> &lhs, const inplace_vector<T, N> &rhs) {
+        return lhs.size() == rhs.size() && my_stl::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <class T, size_t N>
+    bool operator<(const inplace_vector<T, N> &lhs, const inplace_vector<T, N> &rhs) {
+        return my_stl::s_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    template <class T, size_t N>
+    bool operator!=(const inplace_vector<T, N> &lhs, const inplace_vector<T, N> &rhs) {
+        return !(lhs == rhs);
+    }
+
+    template <class T, size_t N>
+    bool operator>(const inplace_vector<T, N> &lhs, const inplace_vector<T, N> &rhs) {
+        return rhs < lhs;
+    }
+
+    template <class T, size_t N>
+    bool operator<=(const inplace_vector<T, N> &lhs, const inplace_vector<T, N> &rhs) {
+        return !(rhs < lhs);
+    }
+
+    template <class T, size_t N>
+    bool operator>=(const inplace_vector<T, N> &lhs, const inplace_vector<T, N> &rhs) {
+        return !(lhs < rhs);
+    }
+
+    template <class T, size_t N>
+    void swap(inplace_vector<T, N> &lhs, inplace_vector<T, N> &rhs) {
+        lhs.swap(rhs);
+    }
+}
+
+#endif //MY_STL_INPLACE_VECTOR_H
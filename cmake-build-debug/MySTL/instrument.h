@@ -0,0 +1,267 @@
+//
+// Created by 陈燊 on 2021/12/18.
+//
+
+#ifndef MY_STL_INSTRUMENT_H
+#define MY_STL_INSTRUMENT_H
+
+#include <cstddef>
+#include <iostream>
+
+/*
+ * 容器内存分配的统计(可选)
+ * 编译时定义MYSTL_INSTRUMENT才会开启, 否则下面的宏全部展开为空, 容器代码和没有插桩时完全一样.
+ *
+ * 容器在每次申请/释放存储空间的地方调用:
+ *   MYSTL_INSTRUMENT_ALLOC(Container, old_bytes, new_bytes)
+ *       申请new_bytes, old_bytes不为0说明是扩容, 旧空间随后会被释放
+ *   MYSTL_INSTRUMENT_FREE(Container, bytes, used_bytes)
+ *       释放bytes, 其中只用到了used_bytes, 差值记为浪费的容量
+ * 统计按容器类型汇总(申请次数, 扩容次数, 字节数, 浪费的容量, 同时存活的峰值), 再按调用点细分.
+ *
+ * 调用点是用户代码里的文件和行号: 公开的扩容接口(vector的push_back, insert, resize, reverse...)
+ * 声明时带上MYSTL_INSTRUMENT_SITE_PARAM, 多出一个默认参数call_site::current(), 默认参数在调用处求值,
+ * 拿到的是调用者的__builtin_FILE()/__builtin_LINE(); 函数体开头MYSTL_INSTRUMENT_ENTER()把它记到当前线程上,
+ * 最外层的接口生效, 内部再调用其它公开接口时不覆盖. 报告里的调用点形如"main.cpp:42 reallocate_insert",
+ * 后半部分是实际申请内存的内部函数.
+ * emplace/emplace_back是可变参数模板, 参数包后面不能加默认参数; 没有记到调用点的申请(包括list的get_node)
+ * 只按内部函数名归类, 需要细分时在调用处用MYSTL_INSTRUMENT_SCOPE()标出所在的行.
+ * 扩容次数多的类型和调用点就是该提前reserve的地方.
+ *
+ *   my_stl::instrument::report(std::cerr);   输出报告
+ *   my_stl::instrument::reset();             清空统计
+ *   my_stl::instrument::stats(typeid(C));    取出容器类型C的统计(只在定义MYSTL_INSTRUMENT时提供)
+ * 统计表由互斥锁保护, 可以在多线程中使用.
+ */
+
+#ifdef MYSTL_INSTRUMENT
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <typeindex>
+#include <cstdlib>
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+namespace my_stl {
+    namespace instrument {
+        struct alloc_stats {
+            size_t allocs = 0;          /* 申请次数 */
+            size_t reallocs = 0;        /* 其中属于扩容的次数 */
+            size_t frees = 0;           /* 释放次数 */
+            size_t bytes = 0;           /* 累计申请字节数 */
+            size_t wasted_bytes = 0;    /* 释放时没有用到的容量 */
+            size_t live_bytes = 0;      /* 当前存活字节数 */
+            size_t peak_bytes = 0;      /* 存活字节数峰值 */
+        };
+
+        /* 一种容器类型的汇总以及各调用点的明细 */
+        struct type_stats {
+            std::string name;
+            alloc_stats total;
+            std::map<std::string, alloc_stats> sites;
+        };
+
+        /* 用户代码里的调用位置, 作为默认参数时在调用处求值 */
+        struct call_site {
+            const char *file;
+            unsigned line;
+
+#if defined(__GNUC__) || defined(__clang__)
+            static call_site current(const char *file = __builtin_FILE(), unsigned line = __builtin_LINE()) noexcept {
+                return {file, line};
+            }
+#else
+            static call_site current(const char *file = "?", unsigned line = 0) noexcept {return {file, line};}
+#endif
+        };
+
+        /* 把调用点记到当前线程上, 已经有外层记录时什么也不做 */
+        class site_scope {
+        public:
+            explicit site_scope(const call_site &site) noexcept : owner_(!state().active) {
+                if (owner_) {
+                    state().site = site;
+                    state().active = true;
+                }
+            }
+            ~site_scope() {
+                if (owner_)
+                    state().active = false;
+            }
+            site_scope(const site_scope&) = delete;
+            site_scope& operator=(const site_scope&) = delete;
+
+            static const call_site* current() noexcept {return state().active ? &state().site : nullptr;}
+
+        private:
+            struct site_state {
+                call_site site;
+                bool active;
+            };
+
+            /* 平凡析构的thread_local, 线程退出时不需要析构 */
+            static site_state& state() noexcept {
+                static thread_local site_state s = {{nullptr, 0}, false};
+                return s;
+            }
+
+            bool owner_;
+        };
+
+        class registry {
+        public:
+            /* 故意不析构: 静态容器析构时还会调用on_free */
+            static registry& instance() {
+                static registry *r = new registry;
+                return *r;
+            }
+
+            void on_alloc(const std::type_info &type, const char *func, size_t old_bytes, size_t new_bytes) {
+                if (new_bytes == 0)
+                    return;
+                const std::string site = site_name(func);
+                std::lock_guard<std::mutex> lock(mutex_);
+                type_stats &t = entry(type);
+                add_alloc(t.total, old_bytes, new_bytes);
+                add_alloc(t.sites[site], old_bytes, new_bytes);
+            }
+
+            void on_free(const std::type_info &type, size_t bytes, size_t used_bytes) {
+                if (bytes == 0)
+                    return;
+                std::lock_guard<std::mutex> lock(mutex_);
+                alloc_stats &s = entry(type).total;
+                ++s.frees;
+                s.wasted_bytes += bytes - used_bytes;
+                s.live_bytes = s.live_bytes > bytes ? s.live_bytes - bytes : 0;
+            }
+
+            void report(std::ostream &os) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                os << "[-------------------- my_stl allocation report --------------------]\n";
+                for (auto &kv : types_) {
+                    const type_stats &t = kv.second;
+                    os << t.name << "\n";
+                    print(os, "    total", t.total);
+                    for (auto &site : t.sites)
+                        print(os, ("    " + site.first).c_str(), site.second);
+                }
+            }
+
+            void reset() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                types_.clear();
+            }
+
+            /* 一种容器类型当前的统计(拷贝), 没有记录时为空 */
+            type_stats stats(const std::type_info &type) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = types_.find(std::type_index(type));
+                return it == types_.end() ? type_stats() : it->second;
+            }
+
+        private:
+            registry() = default;
+
+            type_stats& entry(const std::type_info &type) {
+                auto it = types_.find(std::type_index(type));
+                if (it == types_.end()) {
+                    it = types_.emplace(std::type_index(type), type_stats()).first;
+                    it->second.name = demangle(type.name());
+                }
+                return it->second;
+            }
+
+            /* 有记录的调用点时是"文件名:行号 内部函数", 否则只有内部函数名 */
+            static std::string site_name(const char *func) {
+                const call_site *site = site_scope::current();
+                if (site == nullptr)
+                    return func;
+                const char *file = site->file;
+                for (const char *p = file; *p != '\0'; ++p)
+                    if (*p == '/' || *p == '\\')
+                        file = p + 1;
+                return std::string(file) + ":" + std::to_string(site->line) + " " + func;
+            }
+
+            /* 调用点上只统计申请, 存活量和峰值按类型汇总 */
+            static void add_alloc(alloc_stats &s, size_t old_bytes, size_t new_bytes) {
+                ++s.allocs;
+                if (old_bytes != 0)
+                    ++s.reallocs;
+                s.bytes += new_bytes;
+                s.live_bytes += new_bytes;
+                if (s.live_bytes > s.peak_bytes)
+                    s.peak_bytes = s.live_bytes;
+            }
+
+            static void print(std::ostream &os, const char *label, const alloc_stats &s) {
+                os << label << ": allocs " << s.allocs << ", reallocs " << s.reallocs
+                   << ", bytes " << s.bytes;
+                if (s.frees != 0 || s.wasted_bytes != 0)
+                    os << ", frees " << s.frees << ", wasted " << s.wasted_bytes
+                       << ", live " << s.live_bytes << ", peak " << s.peak_bytes;
+                os << "\n";
+            }
+
+            static std::string demangle(const char *name) {
+#if defined(__GNUC__)
+                int status = 0;
+                char *p = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+                if (status == 0 && p != nullptr) {
+                    std::string s(p);
+                    std::free(p);
+                    return s;
+                }
+#endif
+                return name;
+            }
+
+        private:
+            std::mutex mutex_;
+            std::map<std::type_index, type_stats> types_;
+        };
+
+        inline void report(std::ostream &os = std::cerr) {registry::instance().report(os);}
+        inline void reset() {registry::instance().reset();}
+        inline type_stats stats(const std::type_info &type) {return registry::instance().stats(type);}
+    }
+}
+
+#define MYSTL_INSTRUMENT_ALLOC(Container, old_bytes, new_bytes) \
+  my_stl::instrument::registry::instance().on_alloc(typeid(Container), __func__, (old_bytes), (new_bytes))
+
+#define MYSTL_INSTRUMENT_FREE(Container, bytes, used_bytes) \
+  my_stl::instrument::registry::instance().on_free(typeid(Container), (bytes), (used_bytes))
+
+#define MYSTL_INSTRUMENT_SITE_PARAM , my_stl::instrument::call_site mystl_site = my_stl::instrument::call_site::current()
+#define MYSTL_INSTRUMENT_SITE_ARG , my_stl::instrument::call_site mystl_site
+#define MYSTL_INSTRUMENT_ENTER() my_stl::instrument::site_scope mystl_site_scope(mystl_site)
+#define MYSTL_INSTRUMENT_SCOPE() \
+  my_stl::instrument::site_scope mystl_user_site_scope(my_stl::instrument::call_site::current())
+
+#else
+
+namespace my_stl {
+    namespace instrument {
+        inline void report(std::ostream &os = std::cerr) {
+            os << "my_stl instrumentation is disabled, compile with -DMYSTL_INSTRUMENT\n";
+        }
+        inline void reset() {}
+    }
+}
+
+#define MYSTL_INSTRUMENT_ALLOC(Container, old_bytes, new_bytes) ((void)0)
+#define MYSTL_INSTRUMENT_FREE(Container, bytes, used_bytes) ((void)0)
+#define MYSTL_INSTRUMENT_SITE_PARAM
+#define MYSTL_INSTRUMENT_SITE_ARG
+#define MYSTL_INSTRUMENT_ENTER() ((void)0)
+#define MYSTL_INSTRUMENT_SCOPE() ((void)0)
+
+#endif // MYSTL_INSTRUMENT
+
+#endif //MY_STL_INSTRUMENT_H
@@ -0,0 +1,675 @@
+//
+// Created by 陈燊 on 2021/12/25.
+//
+
+#ifndef MY_STL_INTRUSIVE_LIST_H
+#define MY_STL_INTRUSIVE_LIST_H
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include "iterator.h"
+#include "functional.h"
+#include "util.h"
+#include "exceptdef.h"
+#include <iostream>
+
+/*
+ * intrusive_list<T, &T::hook>
+ * 侵入式双向链表: 前驱后继指针(intrusive_list_hook)就是对象自己的成员, 链表只把对象串起来.
+ * 与list一样是带内嵌哨兵的环形双链, 但没有list_node, 因此
+ *   push/insert/erase/splice/sort都不分配内存, 也不拷贝或移动对象;
+ *   遍历只访问对象本身, 对象放在哪里(数组, 内存池, 栈)由使用者决定;
+ *   容器不拥有对象: erase/clear/析构只是把对象摘下来, 不析构对象.
+ *
+ * 使用方式:
+ *   struct task { int id; my_stl::intrusive_list_hook hook; };
+ *   my_stl::intrusive_list<task, &task::hook> ready;
+ *   ready.push_back(t);  ...  ready.erase(ready.iterator_to(t));
+ *
+ * 一个对象的一个hook同时只能在一个链表里, 要同时挂进多个链表就放多个hook.
+ * 对象在链表中时不能析构或移动(定义MYSTL_DEBUG时hook析构会检查).
+ * hook拷贝时不拷贝链接, 含hook的对象可以正常拷贝, 副本不在任何链表里.
+ */
+
+namespace my_stl {
+    /* 嵌入到对象中的链接, 不在链表中时prev和next都是nullptr */
+    struct intrusive_list_hook {
+        intrusive_list_hook *prev;
+        intrusive_list_hook *next;
+
+        intrusive_list_hook() noexcept : prev(nullptr), next(nullptr) {}
+        intrusive_list_hook(const intrusive_list_hook&) noexcept : prev(nullptr), next(nullptr) {}
+        intrusive_list_hook& operator=(const intrusive_list_hook&) noexcept {return *this;}
+        ~intrusive_list_hook() {MYSTL_DEBUG(!is_linked());}
+
+        bool is_linked() const noexcept {return next != nullptr;}
+    };
+
+    /* hook和对象之间的换算 */
+    template <class T, intrusive_list_hook T::*Hook>
+    struct intrusive_list_traits {
+        /* 以T为成员的union: 按T对齐, 大小不小于T, 不调用T的构造和析构 */
+        union storage {
+            constexpr storage() noexcept : unused() {}
+            ~storage() {}
+
+            char unused;
+            T    value;
+        };
+
+        /* hook在T中的偏移. 成员指针不能指向虚基类的成员, 所以偏移对T的每个对象都相同,
+         * 在局部的storage上取一次两个地址相减即可; 两个地址都属于同一个局部对象,
+         * 优化后整个函数折叠成一个常量, 不占存储, 也没有静态变量的初始化检查.
+         * 取地址用std::addressof, 不受T重载的operator&影响 */
+        static size_t offset() noexcept {return offset(m_bool_constant<std::is_abstract<T>::value>());}
+
+        static size_t offset(m_false_type) noexcept {
+            storage s;
+            return member_offset(s.value);
+        }
+
+        /* 抽象类不能做union的成员, 退回按T对齐的原始内存 */
+        static size_t offset(m_true_type) noexcept {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type buf;
+            return member_offset(*reinterpret_cast<T*>(&buf));
+        }
+
+        static size_t member_offset(T &value) noexcept {
+            return static_cast<size_t>(reinterpret_cast<const char*>(std::addressof(value.*Hook))
+                                       - reinterpret_cast<const char*>(std::addressof(value)));
+        }
+        static T* to_value(intrusive_list_hook *h) noexcept {
+            return reinterpret_cast<T*>(reinterpret_cast<char*>(h) - offset());
+        }
+        static intrusive_list_hook* to_hook(T &value) noexcept {return &(value.*Hook);}
+    };
+
+    /*
+     * intrusive_list的迭代器, 双向迭代器
+     * Ref/Ptr区分iterator和const_iterator
+     */
+    template <class T, intrusive_list_hook T::*Hook, class Ref, class Ptr>
+    struct intrusive_list_iterator : public my_stl::iterator<my_stl::bidirectional_iterator_tag, T> {
+        typedef T                                                   value_type;
+        typedef Ptr                                                 pointer;
+        typedef Ref                                                 reference;
+        typedef intrusive_list_traits<T, Hook>                      traits;
+        typedef intrusive_list_iterator<T, Hook, T&, T*>            iterator;
+        typedef intrusive_list_iterator                             self;
+
+        intrusive_list_hook *node_;
+
+        intrusive_list_iterator() = default;
+        explicit intrusive_list_iterator(intrusive_list_hook *p) : node_(p) {}
+        /* iterator到const_iterator的转换, 写成模板不会成为iterator自身的拷贝构造函数 */
+        template <class Iter, typename std::enable_if<
+                std::is_same<Iter, iterator>::value && !std::is_same<Iter, self>::value, int>::type = 0>
+        intrusive_list_iterator(const Iter &rhs) : node_(rhs.node_) {}
+
+        reference operator*() const {return *traits::to_value(node_);}
+        pointer   operator->() const {return &(operator*());}
+
+        self& operator++() {
+            MYSTL_DEBUG(node_ != nullptr);
+            node_ = node_->next;
+            return *this;
+        }
+
+        self operator++(int) {
+            self temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        self& operator--() {
+            MYSTL_DEBUG(node_ != nullptr);
+            node_ = node_->prev;
+            return *this;
+        }
+
+        self operator--(int) {
+            self temp = *this;
+            --*this;
+            return temp;
+        }
+
+        bool operator==(const self &rhs) const {return node_ == rhs.node_;}
+        bool operator!=(const self &rhs) const {return node_ != rhs.node_;}
+    };
+
+    template <class T, intrusive_list_hook T::*Hook>
+    class intrusive_list {
+    public:
+        typedef T                                   value_type;
+        typedef T*                                  pointer;
+        typedef const T*                            const_pointer;
+        typedef T&                                  reference;
+        typedef const T&                            const_reference;
+        typedef size_t                              size_type;
+        typedef ptrdiff_t                           difference_type;
+
+        typedef intrusive_list_iterator<T, Hook, T&, T*>                iterator;
+        typedef intrusive_list_iterator<T, Hook, const T&, const T*>    const_iterator;
+        typedef my_stl::reverse_iterator<iterator>                      reverse_iterator;
+        typedef my_stl::reverse_iterator<const_iterator>                const_reverse_iterator;
+
+    private:
+        typedef intrusive_list_hook*                hook_ptr;
+        typedef intrusive_list_traits<T, Hook>      traits;
+
+        intrusive_list_hook sentinel_;              /* 内嵌的哨兵, end()就是它 */
+        size_type size_;
+
+        hook_ptr sentinel() const noexcept {return const_cast<hook_ptr>(&sentinel_);}
+        static hook_ptr hook_of(const_iterator it) noexcept {return it.node_;}
+
+    public:
+        intrusive_list() noexcept : size_(0) {init_sentinel();}
+
+        /* 把[first, last)里的对象依次挂到尾部 */
+        template <class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        intrusive_list(Iter first, Iter last) : size_(0) {
+            init_sentinel();
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+
+        /* 对象只能在一个链表里, 不能拷贝 */
+        intrusive_list(const intrusive_list&) = delete;
+        intrusive_list& operator=(const intrusive_list&) = delete;
+
+        intrusive_list(intrusive_list &&rhs) noexcept : size_(rhs.size_) {
+            take_nodes(sentinel_, rhs.sentinel_);
+            rhs.size_ = 0;
+        }
+
+        intrusive_list& operator=(intrusive_list &&rhs) noexcept {
+            if (this != &rhs) {
+                clear();
+                take_nodes(sentinel_, rhs.sentinel_);
+                size_ = rhs.size_;
+                rhs.size_ = 0;
+            }
+            return *this;
+        }
+
+        /* 摘下所有对象, 对象本身不析构 */
+        ~intrusive_list() {
+            clear();
+            sentinel_.prev = sentinel_.next = nullptr;
+        }
+
+    public:
+        /* 迭代器相关接口 */
+        iterator begin() noexcept {return iterator(sentinel_.next);}
+        const_iterator begin() const noexcept {return const_iterator(sentinel_.next);}
+        iterator end() noexcept {return iterator(sentinel());}
+        const_iterator end() const noexcept {return const_iterator(sentinel());}
+
+        reverse_iterator rbegin() noexcept {return reverse_iterator(end());}
+        const_reverse_iterator rbegin() const noexcept {return const_reverse_iterator(end());}
+        reverse_iterator rend() noexcept {return reverse_iterator(begin());}
+        const_reverse_iterator rend() const noexcept {return const_reverse_iterator(begin());}
+
+        const_iterator cbegin() const noexcept {return begin();}
+        const_iterator cend() const noexcept {return end();}
+        const_reverse_iterator crbegin() const noexcept {return rbegin();}
+        const_reverse_iterator crend() const noexcept {return rend();}
+
+        /* 由对象得到指向它的迭代器, O(1), 对象必须在这个链表里 */
+        iterator iterator_to(reference value) noexcept {
+            MYSTL_DEBUG(traits::to_hook(value)->is_linked());
+            return iterator(traits::to_hook(value));
+        }
+        const_iterator iterator_to(const_reference value) const noexcept {
+            return const_iterator(traits::to_hook(const_cast<reference>(value)));
+        }
+
+        /* 容器相关操作 */
+        bool empty() const noexcept {return size_ == 0;}
+        size_type size() const noexcept {return size_;}
+        size_type max_size() const noexcept {return static_cast<size_type>(-1);}
+
+        /* 访问元素相关操作 */
+        reference front() {
+            MYSTL_DEBUG(!empty());
+            return *begin();
+        }
+
+        const_reference front() const {
+            MYSTL_DEBUG(!empty());
+            return *begin();
+        }
+
+        reference back() {
+            MYSTL_DEBUG(!empty());
+            return *iterator(sentinel_.prev);
+        }
+
+        const_reference back() const {
+            MYSTL_DEBUG(!empty());
+            return *const_iterator(sentinel_.prev);
+        }
+
+        /* 挂入和摘下, 都是O(1)且不分配 */
+        void push_front(reference value) noexcept {insert(cbegin(), value);}
+        void push_back(reference value) noexcept {insert(cend(), value);}
+
+        void pop_front() noexcept {
+            MYSTL_DEBUG(!empty());
+            erase(cbegin());
+        }
+
+        void pop_back() noexcept {
+            MYSTL_DEBUG(!empty());
+            erase(const_iterator(sentinel_.prev));
+        }
+
+        /* 把value挂到pos之前, value不能已经在某个链表里 */
+        iterator insert(const_iterator pos, reference value) noexcept {
+            auto h = traits::to_hook(value);
+            MYSTL_DEBUG(!h->is_linked());
+            link_nodes(hook_of(pos), h, h);
+            ++size_;
+            return iterator(h);
+        }
+
+        template <class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        iterator insert(const_iterator pos, Iter first, Iter last) {
+            iterator result(hook_of(pos));
+            if (first == last)
+                return result;
+            result = insert(pos, *first);
+            for (++first; first != last; ++first)
+                insert(pos, *first);
+            return result;
+        }
+
+        /* 摘下pos处的对象, 返回下一个位置 */
+        iterator erase(const_iterator pos) noexcept {
+            MYSTL_DEBUG(pos != cend());
+            auto h = hook_of(pos);
+            auto next = h->next;
+            unlink_nodes(h, h);
+            h->prev = h->next = nullptr;
+            --size_;
+            return iterator(next);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) noexcept {
+            while (first != last)
+                first = erase(first);
+            return iterator(hook_of(last));
+        }
+
+        /* 摘下对象并交给disposer(例如归还内存池) */
+        template <class Disposer>
+        iterator erase_and_dispose(const_iterator pos, Disposer disposer) {
+            auto &value = const_cast<reference>(*pos);
+            auto next = erase(pos);
+            disposer(&value);
+            return next;
+        }
+
+        void clear() noexcept {
+            auto p = sentinel_.next;
+            while (p != sentinel()) {
+                auto next = p->next;
+                p->prev = p->next = nullptr;
+                p = next;
+            }
+            init_sentinel();
+            size_ = 0;
+        }
+
+        template <class Disposer>
+        void clear_and_dispose(Disposer disposer) {
+            while (!empty()) {
+                auto &value = front();
+                pop_front();
+                disposer(&value);
+            }
+        }
+
+        void swap(intrusive_list &rhs) noexcept {
+            intrusive_list_hook temp;
+            take_nodes(temp, sentinel_);
+            take_nodes(sentinel_, rhs.sentinel_);
+            take_nodes(rhs.sentinel_, temp);
+            temp.prev = temp.next = nullptr;
+            my_stl::swap(size_, rhs.size_);
+        }
+
+        /* splice: 只改指针, 不分配 */
+        void splice(const_iterator pos, intrusive_list &other) noexcept;
+        void splice(const_iterator pos, intrusive_list &other, const_iterator it) noexcept;
+        void splice(const_iterator pos, intrusive_list &other, const_iterator first, const_iterator last) noexcept;
+
+        /* 相关操作, 被删除的对象只是摘下来 */
+        template <class Unary>
+        void remove_if(Unary pred);
+        void remove(const value_type &value) {remove_if([&](const value_type &v) {return v == value;});}
+
+        template <class Binary>
+        void unique(Binary pred);
+        void unique() {unique(my_stl::equal_to<T>());}
+
+        template <class Compare>
+        void merge(intrusive_list &x, Compare comp);
+        void merge(intrusive_list &x) {merge(x, my_stl::less<T>());}
+
+        /* 与list::sort一样是自底向上的归并排序, 只重新链接hook, 稳定 */
+        template <class Compare>
+        void sort(Compare comp);
+        void sort() {sort(my_stl::less<T>());}
+
+        void reverse() noexcept;
+
+    private:
+        /* ************************************辅助函数***********************************************/
+        void init_sentinel() noexcept {sentinel_.prev = sentinel_.next = sentinel();}
+
+        static void take_nodes(intrusive_list_hook &to, intrusive_list_hook &from) noexcept;
+        static void link_nodes(hook_ptr pos, hook_ptr first, hook_ptr last) noexcept;
+        static void unlink_nodes(hook_ptr first, hook_ptr last) noexcept;
+
+        struct hook_chain {             /* 排序时的一段结点, 以nullptr结尾 */
+            hook_ptr first;
+            hook_ptr last;
+        };
+        template <class Compare>
+        static void merge_chains(hook_chain &into, hook_chain &from, Compare &comp);
+        void relink_chain(hook_ptr first) noexcept;
+    };
+
+    /* *************************************实现**************************************** */
+
+    template <class T, intrusive_list_hook T::*Hook>
+    void intrusive_list<T, Hook>::splice(const_iterator pos, intrusive_list &other) noexcept {
+        MYSTL_DEBUG(this != &other);
+        if (other.empty())
+            return;
+        auto first = other.sentinel_.next;
+        auto last = other.sentinel_.prev;
+        other.init_sentinel();
+        link_nodes(hook_of(pos), first, last);
+        size_ += other.size_;
+        other.size_ = 0;
+    }
+
+    template <class T, intrusive_list_hook T::*Hook>
+    void intrusive_list<T, Hook>::splice(const_iterator pos, intrusive_list &other, const_iterator it) noexcept {
+        auto p = hook_of(pos);
+        auto h = hook_of(it);
+        if (p == h || p == h->next)
+            return;
+        unlink_nodes(h, h);
+        link_nodes(p, h, h);
+        ++size_;
+        --other.size_;
+    }
+
+    // [first, last)接到pos之前, 同一个链表时pos不能落在[first, last)中
+    template <class T, intrusive_list_hook T::*Hook>
+    void intrusive_list<T, Hook>::splice(const_iterator pos, intrusive_list &other,
+                                         const_iterator first, const_iterator last) noexcept {
+        if (first == last || pos == last)
+            return;
+        if (this != &other) {
+            const size_type n = static_cast<size_type>(my_stl::distance(first, last));
+            size_ += n;
+            other.size_ -= n;
+        }
+        auto f = hook_of(first);
+        auto l = hook_of(last)->prev;
+        unlink_nodes(f, l);
+        link_nodes(hook_of(pos), f, l);
+    }
+
+    template <class T, intrusive_list_hook T::*Hook>
+    template <class Unary>
+    void intrusive_list<T, Hook>::remove_if(Unary pred) {
+        for (auto it = cbegin(); it != cend(); ) {
+            if (pred(*it))
+                it = erase(it);
+            else
+                ++it;
+        }
+    }
+
+    template <class T, intrusive_list_hook T::*Hook>
+    template <class Binary>
+    void intrusive_list<T, Hook>::unique(Binary pred) {
+        if (size_ < 2)
+            return;
+        auto prev = cbegin();
+        auto it = prev;
+        for (++it; it != cend(); ) {
+            if (pred(*prev, *it)) {
+                it = erase(it);
+            }
+            else {
+                prev = it;
+                ++it;
+            }
+        }
+    }
+
+    // 两个有序链表合并, x中的对象整体移入, 稳定
+    template <class T, intrusive_list_hook T::*Hook>
+    template <class Compare>
+    void intrusive_list<T, Hook>::merge(intrusive_list &x, Compare comp) {
+        if (this == &x)
+            return;
+        auto f1 = cbegin();
+        auto l1 = cend();
+        auto f2 = x.cbegin();
+        auto l2 = x.cend();
+        while (f1 != l1 && f2 != l2) {
+            if (comp(*f2, *f1)) {
+                /* 把x中一段比*f1小的对象一起搬过来 */
+                auto next = f2;
+                ++next;
+                for (; next != l2 && comp(*next, *f1); ++next)
+                    ;
+                splice(f1, x, f2, next);
+                f2 = next;
+            }
+            else {
+                ++f1;
+            }
+        }
+        if (f2 != l2)
+            splice(l1, x, f2, l2);
+    }
+
+    // 和list::merge_chains相同: 合并两条以nullptr结尾的有序链, 同时维护prev
+    template <class T, intrusive_list_hook T::*Hook>
+    template <class Compare>
+    void intrusive_list<T, Hook>::merge_chains(hook_chain &into, hook_chain &from, Compare &comp) {
+        intrusive_list_hook head;
+        hook_ptr tail = &head;
+        hook_ptr a = into.first;
+        hook_ptr b = from.first;
+        try {
+            while (a != nullptr && b != nullptr) {
+                if (comp(*traits::to_value(b), *traits::to_value(a))) {
+                    tail->next = b;
+                    b->prev = tail;
+                    b = b->next;
+                }
+                else {
+                    tail->next = a;
+                    a->prev = tail;
+                    a = a->next;
+                }
+                tail = tail->next;
+            }
+        } catch (...) {
+            tail->next = a;
+            while (tail->next != nullptr)
+                tail = tail->next;
+            tail->next = b;
+            into.first = head.next;
+            from.first = from.last = nullptr;
+            head.next = nullptr;
+            throw;
+        }
+        if (a != nullptr) {
+            tail->next = a;
+            a->prev = tail;
+        }
+        else {
+            tail->next = b;
+            b->prev = tail;
+            into.last = from.last;
+        }
+        into.first = head.next;
+        from.first = from.last = nullptr;
+        head.next = nullptr;
+    }
+
+    // 以next为准重新设置prev, 把单链first挂回哨兵, 只在排序出错时使用
+    template <class T, intrusive_list_hook T::*Hook>
+    void intrusive_list<T, Hook>::relink_chain(hook_ptr first) noexcept {
+        sentinel_.next = first;
+        hook_ptr prev = sentinel();
+        for (auto p = first; p != nullptr; p = p->next) {
+            p->prev = prev;
+            prev = p;
+        }
+        prev->next = sentinel();
+        sentinel_.prev = prev;
+    }
+
+    // 自底向上的归并排序, 过程见list::list_sort
+    template <class T, intrusive_list_hook T::*Hook>
+    template <class Compare>
+    void intrusive_list<T, Hook>::sort(Compare comp) {
+        if (size_ < 2)
+            return;
+        hook_chain bins[64] = {};
+        size_t fill = 0;                /* 用到的bins个数 */
+        hook_chain carry = {};
+        hook_chain result = {};
+        sentinel_.prev->next = nullptr;
+        hook_ptr rest = sentinel_.next;
+        try {
+            while (rest != nullptr) {
+                carry.first = carry.last = rest;
+                rest = rest->next;
+                carry.last->next = nullptr;
+                size_t i = 0;
+                for (; i < fill && bins[i].first != nullptr; ++i) {
+                    merge_chains(bins[i], carry, comp);     /* bins[i]里的元素在前 */
+                    carry = bins[i];
+                    bins[i].first = bins[i].last = nullptr;
+                }
+                bins[i] = carry;
+                carry.first = carry.last = nullptr;
+                if (i == fill)
+                    ++fill;
+            }
+            for (size_t i = 0; i < fill; ++i) {
+                if (bins[i].first != nullptr) {
+                    merge_chains(bins[i], result, comp);
+                    result = bins[i];
+                    bins[i].first = bins[i].last = nullptr;
+                }
+            }
+        } catch (...) {
+            /* 所有链首尾相接挂回去, 对象一个不少, 顺序未定 */
+            auto append = [&](hook_ptr chain) {
+                if (chain == nullptr)
+                    return;
+                auto tail = chain;
+                while (tail->next != nullptr)
+                    tail = tail->next;
+                tail->next = rest;
+                rest = chain;
+            };
+            append(carry.first);
+            append(result.first);
+            for (size_t i = 0; i < fill; ++i)
+                append(bins[i].first);
+            relink_chain(rest);
+            throw;
+        }
+        sentinel_.next = result.first;
+        result.first->prev = sentinel();
+        result.last->next = sentinel();
+        sentinel_.prev = result.last;
+    }
+
+    template <class T, intrusive_list_hook T::*Hook>
+    void intrusive_list<T, Hook>::reverse() noexcept {
+        auto p = sentinel();
+        do {
+            my_stl::swap(p->prev, p->next);
+            p = p->prev;                /* 交换后prev是原来的next */
+        } while (p != sentinel());
+    }
+
+    template <class T, intrusive_list_hook T::*Hook>
+    void intrusive_list<T, Hook>::take_nodes(intrusive_list_hook &to, intrusive_list_hook &from) noexcept {
+        if (from.next == &from) {
+            to.prev = to.next = &to;
+            return;
+        }
+        to.next = from.next;
+        to.prev = from.prev;
+        to.next->prev = &to;
+        to.prev->next = &to;
+        from.prev = from.next = &from;
+    }
+
+    // pos之前连接[first, last]
+    template <class T, intrusive_list_hook T::*Hook>
+    void intrusive_list<T, Hook>::link_nodes(hook_ptr pos, hook_ptr first, hook_ptr last) noexcept {
+        pos->prev->next = first;
+        first->prev = pos->prev;
+        pos->prev = last;
+        last->next = pos;
+    }
+
+    template <class T, intrusive_list_hook T::*Hook>
+    void intrusive_list<T, Hook>::unlink_nodes(hook_ptr first, hook_ptr last) noexcept {
+        first->prev->next = last->next;
+        last->next->prev = first->prev;
+    }
+
+    // 重载比较操作符
+    template <class T, intrusive_list_hook T::*Hook>
+    bool operator==(const intrusive_list<T, Hook> &lhs, const intrusive_list<T, Hook> &rhs) {
+        if (lhs.size() != rhs.size())
+            return false;
+        auto f1 = lhs.cbegin();
+        auto f2 = rhs.cbegin();
+        auto l1 = lhs.cend();
+        for (; f1 != l1 && *f1 == *f2; ++f1, ++f2)
+            ;
+        return f1 == l1;
+    }
+
+    template <class T, intrusive_list_hook T::*Hook>
+    bool operator!=(const intrusive_list<T, Hook> &lhs, const intrusive_list<T, Hook> &rhs) {
+        return !(lhs == rhs);
+    }
+
+    template <class T, intrusive_list_hook T::*Hook>
+    void swap(intrusive_list<T, Hook> &lhs, intrusive_list<T, Hook> &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    template <class T, intrusive_list_hook T::*Hook>
+    std::ostream& operator<<(std::ostream &os, const intrusive_list<T, Hook> &l) {
+        for (auto it = l.begin(); it != l.end(); ++it)
+            os << *it << " ";
+        os << std::endl;
+        return os;
+    }
+}
+
+#endif //MY_STL_INTRUSIVE_LIST_H
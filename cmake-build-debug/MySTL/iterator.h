@@ -6,6 +6,7 @@
 #ifndef MY_STL_ITERATOR_H
 #define MY_STL_ITERATOR_H
 #include "type_traits.h"
+#include "util.h"
 
 namespace my_stl{
     /* 五种迭代器 */
@@ -321,6 +322,49 @@ namespace my_stl{
     bool operator<=(const reverse_iterator<Iterator> &lhs, const reverse_iterator<Iterator> &rhs) {
         return !(lhs.base() > rhs.base());
     }
+
+    /************************************尾部插入迭代器********************************************/
+    /* 对它赋值等于调用容器的push_back. 容器可以为copy提供重载, 先整体预留空间再批量写入(见vector.h) */
+    template <class Container>
+    class back_insert_iterator {
+    private:
+        Container *container_;
+
+    public:
+        typedef output_iterator_tag                 iterator_category;
+        typedef void                                value_type;
+        typedef void                                difference_type;
+        typedef void                                pointer;
+        typedef void                                reference;
+
+        typedef Container                           container_type;
+        typedef back_insert_iterator<Container>     self;
+
+    public:
+        explicit back_insert_iterator(Container &c) : container_(&c) {}
+
+        self& operator=(const typename Container::value_type &value) {
+            container_->push_back(value);
+            return *this;
+        }
+
+        self& operator=(typename Container::value_type &&value) {
+            container_->push_back(my_stl::move(value));
+            return *this;
+        }
+
+        /* 以下都是空操作 */
+        self& operator*() {return *this;}
+        self& operator++() {return *this;}
+        self& operator++(int) {return *this;}
+
+        container_type* container() const {return container_;}
+    };
+
+    template <class Container>
+    back_insert_iterator<Container> back_inserter(Container &c) {
+        return back_insert_iterator<Container>(c);
+    }
 }
 
 
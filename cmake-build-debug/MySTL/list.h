@@ -6,10 +6,16 @@
 #define MY_STL_LIST_H
 #include <initializer_list>
 #include "iterator.h"
-#include "memory.h"
+#include "mymemory.h"
+#include "alloc.h"
 #include "functional.h"
 #include "util.h"
 #include "exceptdef.h"
+#include "instrument.h"
+#include "algo.h"
+#include "type_traits.h"
+#include <cstdlib>
+#include <type_traits>
 #include <iostream>
 
 /*
@@ -25,6 +31,22 @@
  *   push_front
  *   push_back
  *   insert
+ *
+ * 结点的内存来自pool_allocator(见alloc.h), destroy_node释放的结点会挂回自由链表,
+ * 之后的create_node直接复用, 不必每个结点都调用一次::operator new.
+ * 定义MYSTL_INSTRUMENT时create_node/destroy_node会记入instrument.h的分配统计.
+ *
+ * 结点缓存(可选, 默认关闭): set_node_cache(limit)之后, destroy_node释放的结点先留在本list的
+ * 单链缓存里(最多limit个), create_node优先从缓存取, 不再经过配置器.
+ * 适合反复pop_front / push_back的队列式负载. 移动构造接管缓存的结点, swap时缓存的结点跟着配置器交换,
+ * 上限不变; 拷贝不继承缓存设置. 析构或调小limit时多余的结点还给配置器.
+ *
+ * sort是自底向上的归并排序(见list_sort), 不递归, 不找中点, 稳定.
+ * 元素是不超过list_gather_sort_max_value字节的可平凡复制类型, 并且不少于list_gather_sort_threshold个时,
+ * 改为把值抄进连续数组排序后再重新链接结点(见gather_sort), 结点在内存中越分散越划算.
+ *
+ * 哨兵结点内嵌在list对象中, 默认构造和移动构造都不分配内存;
+ * 因此结点链换主人(移动, swap)时要修正首尾结点指向哨兵的指针, list也不能按字节搬运.
  */
 
 /*
@@ -32,6 +54,9 @@
  */
 
 namespace my_stl {
+    constexpr size_t list_gather_sort_threshold = 1024;         /* 不少于此长度时sort用gather_sort */
+    constexpr size_t list_gather_sort_max_value = 16;           /* gather_sort只用于不超过此大小的元素 */
+
     template <class T> struct list_node_base;
     template <class T> struct list_node;
 
@@ -188,21 +213,22 @@ namespace my_stl {
     };
 
     /* List */
-    template <class T>
-    class list {
+    template <class T, class Alloc = my_stl::pool_allocator<T>>
+    class list : private my_stl::alloc_holder<
+            typename my_stl::allocator_traits<Alloc>::template rebind_alloc<list_node<T>>> {
     public:
-        typedef my_stl::allocator<T>                    allocate_type;
-        typedef my_stl::allocator<T>                    data_allocator;
-        typedef my_stl::allocator<list_node_base<T>>    base_allocator;
-        typedef my_stl::allocator<list_node<T>>         node_allocator;
-
-        typedef typename allocate_type::value_type      value_type;
-        typedef typename allocate_type::pointer         pointer;
-        typedef typename allocate_type::const_pointer   const_pointer;
-        typedef typename allocate_type::reference       reference;
-        typedef typename allocate_type::const_reference const_reference;
-        typedef typename allocate_type::size_type       size_type;
-        typedef typename allocate_type::difference_type difference_type;
+        typedef Alloc                                   allocator_type;
+        /* 容器只保存结点配置器, 元素的配置器需要时从它rebind出来 */
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<list_node<T>>      node_allocator;
+        typedef my_stl::allocator_traits<node_allocator> node_alloc_traits;
+
+        typedef T                                       value_type;
+        typedef T*                                      pointer;
+        typedef const T*                                const_pointer;
+        typedef T&                                      reference;
+        typedef const T&                                const_reference;
+        typedef size_t                                  size_type;
+        typedef ptrdiff_t                               difference_type;
 
         typedef list_iterator<T>                         iterator;
         typedef list_const_iterator<T>                   const_iterator;
@@ -212,66 +238,108 @@ namespace my_stl {
         typedef typename node_traits<T>::base_ptr       base_ptr;
         typedef typename node_traits<T>::node_ptr       node_ptr;
 
-        allocate_type get_allocator() {return node_allocator();}
+        allocator_type get_allocator() const {return allocator_type(alloc_ref());}
 
     private:
-        base_ptr node_;                                 /* 该指针指向末尾结点 */
+        typedef my_stl::alloc_holder<node_allocator>    holder;
+        using holder::alloc_ref;
+
+        list_node_base<T> sentinel_;                    /* 内嵌的哨兵结点, end()就是它 */
         size_type size_;                                /* 链表大小 */
+        base_ptr  cache_ = nullptr;                     /* 缓存的空结点, 用next串成单链 */
+        size_type cache_size_ = 0;                      /* 缓存的结点数 */
+        size_type cache_limit_ = 0;                     /* 最多缓存的结点数, 0表示不缓存 */
+
+        base_ptr sentinel() const noexcept {return const_cast<base_ptr>(&sentinel_);}
 
     public:
-        list() {fill_init(0, value_type());}
+        /* 空list不分配任何空间, 也不构造value_type */
+        list() noexcept : size_(0) {sentinel_.unlink();}
+        explicit list(const allocator_type &a) noexcept : holder(node_allocator(a)), size_(0) {sentinel_.unlink();}
 
-        explicit list(size_type n) {fill_init(n, value_type());}
+        explicit list(size_type n, const allocator_type &a = allocator_type())
+                : holder(node_allocator(a)) {fill_init(n, value_type());}
 
-        list(size_type n, const T &value) {fill_init(n, value);}
+        list(size_type n, const T &value, const allocator_type &a = allocator_type())
+                : holder(node_allocator(a)) {fill_init(n, value);}
 
         template <class Iter, typename std::enable_if<
                 my_stl::is_input_iterator<Iter>::value, int>::type = 0>
-        list(Iter first, Iter last)
+        list(Iter first, Iter last, const allocator_type &a = allocator_type())
+                : holder(node_allocator(a))
         { copy_init(first, last); }
 
-        list(std::initializer_list<T> i_list) {copy_init(i_list.begin(), i_list.end());}
+        list(std::initializer_list<T> i_list, const allocator_type &a = allocator_type())
+                : holder(node_allocator(a)) {copy_init(i_list.begin(), i_list.end());}
 
-        list(const list &rhs) {copy_init(rhs.begin(), rhs.end());}
+        list(const list &rhs)
+                : holder(node_alloc_traits::select_on_container_copy_construction(rhs.alloc_ref()))
+        {copy_init(rhs.begin(), rhs.end());}
 
-        list(list &&rhs) noexcept : node_(rhs.node_), size_(rhs.size_) {
-            rhs.node_ = nullptr;
+        list(const list &rhs, const allocator_type &a) : holder(node_allocator(a)) {copy_init(rhs.begin(), rhs.end());}
+
+        /* 接管rhs的结点链, 只需修正首尾结点指向哨兵的指针, rhs变回空list;
+         * 缓存的结点也一起接管, rhs保留自己的缓存上限 */
+        list(list &&rhs) noexcept
+                : holder(my_stl::move(rhs.alloc_ref())), size_(rhs.size_),
+                  cache_(rhs.cache_), cache_size_(rhs.cache_size_), cache_limit_(rhs.cache_limit_) {
+            take_nodes(sentinel_, rhs.sentinel_);
             rhs.size_ = 0;
+            rhs.cache_ = nullptr;
+            rhs.cache_size_ = 0;
+        }
+
+        /* 指定配置器的移动构造, 配置器不相等时只能逐个移动元素 */
+        list(list &&rhs, const allocator_type &a) : holder(node_allocator(a)), size_(0) {
+            sentinel_.unlink();
+            if (my_stl::alloc_equal(alloc_ref(), rhs.alloc_ref()))
+                splice(end(), rhs);
+            else
+                move_elements_from(rhs);
         }
 
         list& operator=(const list &rhs) {
-            if (this != &rhs)
+            if (this != &rhs) {
+                /* 要传播的配置器和当前的不相等, 旧结点只能由旧配置器释放 */
+                if (node_alloc_traits::propagate_on_container_copy_assignment::value &&
+                    !my_stl::alloc_equal(alloc_ref(), rhs.alloc_ref())) {
+                    list temp(my_stl::move(*this));
+                    my_stl::alloc_on_copy(alloc_ref(), rhs.alloc_ref());
+                }
+                else {
+                    my_stl::alloc_on_copy(alloc_ref(), rhs.alloc_ref());
+                }
                 assign(rhs.begin(), rhs.end());
+            }
             return *this;
         }
 
-        list& operator=(list &&rhs) {
-            clear();
-            splice(end(), rhs);
+        list& operator=(list &&rhs)
+        noexcept(node_alloc_traits::propagate_on_container_move_assignment::value ||
+                 node_alloc_traits::is_always_equal::value) {
+            if (this != &rhs)
+                move_assign(rhs, m_bool_constant<node_alloc_traits::propagate_on_container_move_assignment::value ||
+                                                 node_alloc_traits::is_always_equal::value>());
             return *this;
         }
 
         list& operator=(std::initializer_list<T> i_list) {
-            list temp(i_list.begin(), i_list.end());
+            list temp(i_list.begin(), i_list.end(), get_allocator());
             swap(temp);
             return *this;
         }
 
         ~list() {
-            if (node_) {
-                clear();
-                base_allocator::deallocate(node_);
-                node_ = nullptr;
-                size_ = 0;
-            }
+            clear();
+            trim_node_cache(0);
         }
 
     public:
         /* 迭代器相关接口 */
-        iterator begin() noexcept {return node_->next;}
-        const_iterator begin() const noexcept {return node_->next;}
-        iterator end() noexcept {return node_;}
-        const_iterator end() const noexcept {return node_;}
+        iterator begin() noexcept {return sentinel()->next;}
+        const_iterator begin() const noexcept {return sentinel()->next;}
+        iterator end() noexcept {return sentinel();}
+        const_iterator end() const noexcept {return sentinel();}
         
         reverse_iterator rbegin() noexcept {return reverse_iterator(end());}
         const_reverse_iterator rbegin() const noexcept {return const_reverse_iterator(end());}
@@ -284,9 +352,17 @@ namespace my_stl {
         const_reverse_iterator crend() const noexcept {return rend();}
         
         /* 容器相关操作 */
-        bool empty() {return node_->next == node_;}
-        size_type size() {return size_;}
-        size_type max_size() {return static_cast<size_type>(-1);}
+        bool empty() const noexcept {return sentinel_.next == &sentinel_;}
+        size_type size() const noexcept {return size_;}
+        size_type max_size() const noexcept {return static_cast<size_type>(-1);}
+
+        /* 结点缓存: 最多保留limit个释放掉的结点供之后插入复用, 0关闭缓存并归还已缓存的结点 */
+        void set_node_cache(size_type limit) noexcept {
+            cache_limit_ = limit;
+            trim_node_cache(limit);
+        }
+        size_type node_cache_limit() const noexcept {return cache_limit_;}
+        size_type node_cache_size() const noexcept {return cache_size_;}
 
         /* 访问元素相关操作 */
         reference front() {
@@ -400,7 +476,7 @@ namespace my_stl {
         /* pop_back / pop_front */
         void pop_front() {
             MYSTL_DEBUG(!empty());
-            auto node = node_->next;        /* 第一个结点就是node_的下一个 */
+            auto node = sentinel()->next;        /* 第一个结点就是哨兵的下一个 */
             unlink_nodes(node, node);
             destroy_node(node->as_node());
             --size_;
@@ -408,7 +484,7 @@ namespace my_stl {
 
         void pop_back() {
             MYSTL_DEBUG(!empty());
-            auto node = node_->prev;       /* 最后一个结点就是node_的前一个 */
+            auto node = sentinel()->prev;       /* 最后一个结点就是哨兵的前一个 */
             unlink_nodes(node, node);
             destroy_node(node->as_node());
             --size_;
@@ -423,8 +499,21 @@ namespace my_stl {
         void resize(size_type new_size) {resize(new_size, value_type());}
         void resize(size_type new_size, const value_type &value);
         void swap(list &rhs) noexcept {
-            my_stl::swap(node_, rhs.node_);
+            /* 配置器不传播时两者必须相等, 否则行为未定义 */
+            MYSTL_DEBUG(node_alloc_traits::propagate_on_container_swap::value ||
+                        my_stl::alloc_equal(alloc_ref(), rhs.alloc_ref()));
+            my_stl::alloc_on_swap(alloc_ref(), rhs.alloc_ref());
+            /* 哨兵在对象内部, 交换的是两条结点链 */
+            list_node_base<T> temp;
+            take_nodes(temp, sentinel_);
+            take_nodes(sentinel_, rhs.sentinel_);
+            take_nodes(rhs.sentinel_, temp);
             my_stl::swap(size_, rhs.size_);
+            /* 缓存的结点跟着配置器走, 缓存上限仍属于各自的list */
+            my_stl::swap(cache_, rhs.cache_);
+            my_stl::swap(cache_size_, rhs.cache_size_);
+            trim_node_cache(cache_limit_);
+            rhs.trim_node_cache(rhs.cache_limit_);
         }
 
         /* list 核心操作 */
@@ -446,8 +535,8 @@ namespace my_stl {
         void merge(list &x) {merge(x, my_stl::less<T>());}
 
         template<class Compare>
-        void sort(Compare comp) {list_sort(begin(), end(), size(), comp);}
-        void sort() {list_sort(begin(), end(), size(), my_stl::less<T>());}
+        void sort(Compare comp) {sort_aux(comp, m_bool_constant<gather_sortable>());}
+        void sort() {sort(my_stl::less<T>());}
 
         void reverse();
 
@@ -458,6 +547,19 @@ namespace my_stl {
         node_ptr create_node(Args &&...args);
         void destroy_node(node_ptr p);
 
+        /* 取得和归还结点的内存: 先用结点缓存, 缓存空了或满了才经过配置器 */
+        node_ptr get_node();
+        void put_node(node_ptr p) noexcept;
+        void trim_node_cache(size_type keep) noexcept;
+
+        /* 把from的结点链挂到哨兵to上(to原有的链被覆盖), from变为空链 */
+        static void take_nodes(list_node_base<T> &to, list_node_base<T> &from) noexcept;
+
+        /* 移动赋值 */
+        void move_assign(list &rhs, m_true_type) noexcept;
+        void move_assign(list &rhs, m_false_type);
+        void move_elements_from(list &rhs);
+
         /* 初始化 */
         template<class Iter>
         void copy_init(Iter first, Iter last);
@@ -481,16 +583,31 @@ namespace my_stl {
         iterator fill_insert(const_iterator pos, size_type n, const value_type &value);
 
         /* 排序 */
+        static constexpr bool gather_sortable =
+                std::is_trivially_copyable<T>::value && sizeof(T) <= list_gather_sort_max_value;
+        template<class Compared>
+        void sort_aux(Compared comp, m_true_type);
+        template<class Compared>
+        void sort_aux(Compared comp, m_false_type) {list_sort(comp);}
+        template<class Compared>
+        bool gather_sort(Compared comp);
+        struct node_chain {             /* 排序时的一段结点, 以nullptr结尾 */
+            base_ptr first;
+            base_ptr last;
+        };
+        template<class Compared>
+        void list_sort(Compared comp);
         template<class Compared>
-        iterator list_sort(iterator first, iterator last, size_type n, Compared comp);
+        static void merge_chains(node_chain &into, node_chain &from, Compared &comp);
+        void relink_chain(base_ptr first) noexcept;
     };
 
     /* *************************************实现**************************************** */
 
     // 删除pos处元素
-    template <class T>
-    typename list<T>::iterator
-    list<T>::erase(const_iterator pos) {
+    template <class T, class Alloc>
+    typename list<T, Alloc>::iterator
+    list<T, Alloc>::erase(const_iterator pos) {
         MYSTL_DEBUG(pos != cend());
         auto n = pos.node_;
         auto next = n->next;        //用于之后构造一个迭代器使用
@@ -501,9 +618,9 @@ namespace my_stl {
     }
 
     // 删除[first, last)
-    template <class T>
-    typename list<T>::iterator
-    list<T>::erase(const_iterator first, const_iterator last) {
+    template <class T, class Alloc>
+    typename list<T, Alloc>::iterator
+    list<T, Alloc>::erase(const_iterator first, const_iterator last) {
         if (first != last) {
             unlink_nodes(first.node_, last.node_->prev);
             while (first != last) {
@@ -517,21 +634,21 @@ namespace my_stl {
     }
 
     // 清空list
-    template <class T>
-    void list<T>::clear() {
+    template <class T, class Alloc>
+    void list<T, Alloc>::clear() {
         if (size_ != 0) {
-            auto cur = node_->next;
-            for (base_ptr next = cur->next; cur != node_; cur = next, next = cur->next) {
+            auto cur = sentinel()->next;
+            for (base_ptr next = cur->next; cur != sentinel(); cur = next, next = cur->next) {
                 destroy_node(cur->as_node());
             }
-            node_->unlink();
+            sentinel()->unlink();
             size_ = 0;
         }
     }
 
     //重置链表大小
-    template<class T>
-    void list<T>::resize(size_type new_size, const value_type &value) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::resize(size_type new_size, const value_type &value) {
         auto i = begin();
         size_type len = 0;
         while (i != end() && len < new_size) {
@@ -540,20 +657,20 @@ namespace my_stl {
         }
         /* 截去多余的 */
         if (len == new_size)
-            erase(i, node_);
+            erase(i, sentinel());
         else {
-            insert(node_, new_size - len, value);
+            insert(sentinel(), new_size - len, value);
         }
     }
 
     //将list other 接到pos之前
-    template<class T>
-    void list<T>::splice(const_iterator pos, list<T> &other) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::splice(const_iterator pos, list<T, Alloc> &other) {
         MYSTL_DEBUG(this != &other);
         if (!other.empty()) {
             THROW_LENGTH_ERROR_IF(size_ > max_size() - other.size(), "list<T>'s size too big");
-            auto first = node_->next;
-            auto last = node_->prev;
+            auto first = other.sentinel_.next;
+            auto last = other.sentinel_.prev;
 
             other.unlink_nodes(first, last);
             link_nodes(pos.node_, first, last);
@@ -564,8 +681,8 @@ namespace my_stl {
     }
 
     // 将it所指的结点结合到pos之前
-    template<class T>
-    void list<T>::splice(const_iterator pos, list<T> &other, const_iterator it) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::splice(const_iterator pos, list<T, Alloc> &other, const_iterator it) {
         if (pos.node_ != it.node_ && pos.node_ != it.node_->next) {
             THROW_LENGTH_ERROR_IF(size_ > max_size() - 1, "list<T>'s size too big");
             auto first = it.node_;
@@ -576,14 +693,15 @@ namespace my_stl {
         }
     }
 
-    // 将list other的[first, last)元素接到pos之前
-    template <class T>
-    void list<T>::splice(const_iterator pos, list<T> &other, const_iterator first, const_iterator last) {
-        if (first != last && this != &other) {
-            size_type n = my_stl::distance(first, last);
+    // 将list other的[first, last)元素接到pos之前, other可以就是自己(pos不能落在[first, last)中)
+    template <class T, class Alloc>
+    void list<T, Alloc>::splice(const_iterator pos, list<T, Alloc> &other, const_iterator first, const_iterator last) {
+        if (first != last && pos != last) {
+            /* 同一个list内部移动时大小不变, 不必数个数 */
+            size_type n = this == &other ? 0 : my_stl::distance(first, last);
             THROW_LENGTH_ERROR_IF(size_ > max_size() - n, "list<T>'s size too big");
             auto f = first.node_;
-            auto l = last.node_;
+            auto l = last.node_->prev;
             other.unlink_nodes(f, l);
             link_nodes(pos.node_, f, l);
             size_ += n;
@@ -592,9 +710,9 @@ namespace my_stl {
     }
 
     // 移除符合预期的元素
-    template <class T>
+    template <class T, class Alloc>
     template <class Unary>
-    void list<T>::remove_if(Unary pred) {
+    void list<T, Alloc>::remove_if(Unary pred) {
         auto first = begin();
         auto last = end();
         for (auto next = first; first != last; first = next) {
@@ -605,9 +723,9 @@ namespace my_stl {
     }
 
     //移除list中满足pred为true的元素
-    template <class T>
+    template <class T, class Alloc>
     template <class Binary>
-    void list<T>::unique(Binary pred) {
+    void list<T, Alloc>::unique(Binary pred) {
         auto i = begin();
         auto e = end();
         auto j = i;
@@ -623,9 +741,9 @@ namespace my_stl {
     }
 
     //与另一个list合并，按照comp排序
-    template <class T>
+    template <class T, class Alloc>
     template <class Compare>
-    void list<T>::merge(list<T> &x, Compare comp) {
+    void list<T, Alloc>::merge(list<T, Alloc> &x, Compare comp) {
         if (this != &x) {
             THROW_LENGTH_ERROR_IF(size_ > max_size() - x.size_, "list<T>'s size too big");
             auto first1 = begin();
@@ -635,17 +753,18 @@ namespace my_stl {
 
             while (first1 != last1 && first2 != last2) {
                 if (comp(*first2, *first1)) {
+                    /* x中连续一段都小于*first1, 整段接到first1之前 */
                     auto next = first2;
                     ++next;
-                    for (; next != last2 && comp(*next, *first1); ++next) {
-                        auto f = first2.node_;
-                        auto l = next.node_->prev;
-                        first2 = next;
-
-                        x.unlink_nodes(f, l);
-                        link_nodes(first1.node_, f, l);
-                        ++first1;
-                    }
+                    for (; next != last2 && comp(*next, *first1); ++next)
+                        ;
+                    auto f = first2.node_;
+                    auto l = next.node_->prev;
+                    first2 = next;
+
+                    x.unlink_nodes(f, l);
+                    link_nodes(first1.node_, f, l);
+                    ++first1;
                 }
                 else {
                     ++first1;
@@ -653,7 +772,7 @@ namespace my_stl {
             }
             if (first2 != last2) {
                 auto f = first2.node_;
-                auto l = last2.node_;
+                auto l = last2.node_->prev;
                 x.unlink_nodes(f, l);
                 link_nodes(last1.node_, f, l);
             }
@@ -664,8 +783,8 @@ namespace my_stl {
     }
 
     // 反转
-    template <class T>
-    void list<T>::reverse() {
+    template <class T, class Alloc>
+    void list<T, Alloc>::reverse() {
         if (size_ <= 1)
             return;
         auto i = begin();
@@ -679,34 +798,112 @@ namespace my_stl {
 
     /* 辅助函数实现 */
     // 创建结点
-    template <class T>
+    template <class T, class Alloc>
     template <class ...Args>
-    typename list<T>::node_ptr
-    list<T>::create_node(Args &&...args) {
-        node_ptr p = node_allocator::allocate(1);
+    typename list<T, Alloc>::node_ptr
+    list<T, Alloc>::create_node(Args &&...args) {
+        node_ptr p = get_node();
         try {
-            data_allocator::construct(my_stl::address_of(p->value), my_stl::forward<Args>(args)...);
+            node_alloc_traits::construct(alloc_ref(), my_stl::address_of(p->value), my_stl::forward<Args>(args)...);
             p->next = nullptr;
             p->prev = nullptr;
         } catch (...) {
-            node_allocator::deallocate(p);
+            put_node(p);
             throw;
         }
         return p;
     }
 
     // 龙卷风摧毁结点
-    template <class T>
-    void list<T>::destroy_node(node_ptr p) {
-        data_allocator::destroy(my_stl::address_of(p->value));
-        node_allocator::deallocate(p);
+    template <class T, class Alloc>
+    void list<T, Alloc>::destroy_node(node_ptr p) {
+        node_alloc_traits::destroy(alloc_ref(), my_stl::address_of(p->value));
+        put_node(p);
+    }
+
+    template <class T, class Alloc>
+    typename list<T, Alloc>::node_ptr list<T, Alloc>::get_node() {
+        if (cache_ != nullptr) {
+            node_ptr p = cache_->as_node();
+            cache_ = cache_->next;
+            --cache_size_;
+            return p;
+        }
+        node_ptr p = node_alloc_traits::allocate(alloc_ref(), 1);
+        MYSTL_INSTRUMENT_ALLOC(list, 0, sizeof(*p));
+        return p;
+    }
+
+    template <class T, class Alloc>
+    void list<T, Alloc>::put_node(node_ptr p) noexcept {
+        if (cache_size_ < cache_limit_) {
+            p->next = cache_;
+            cache_ = p->as_base();
+            ++cache_size_;
+            return;
+        }
+        MYSTL_INSTRUMENT_FREE(list, sizeof(*p), sizeof(*p));
+        node_alloc_traits::deallocate(alloc_ref(), p, 1);
+    }
+
+    // 缓存里只留keep个结点, 其余还给配置器
+    template <class T, class Alloc>
+    void list<T, Alloc>::trim_node_cache(size_type keep) noexcept {
+        while (cache_size_ > keep) {
+            node_ptr p = cache_->as_node();
+            cache_ = cache_->next;
+            --cache_size_;
+            MYSTL_INSTRUMENT_FREE(list, sizeof(*p), sizeof(*p));
+            node_alloc_traits::deallocate(alloc_ref(), p, 1);
+        }
+    }
+
+    // 哨兵是对象的一部分, 结点链换主人时首尾结点的指针要改指新的哨兵
+    template <class T, class Alloc>
+    void list<T, Alloc>::take_nodes(list_node_base<T> &to, list_node_base<T> &from) noexcept {
+        if (from.next == &from) {
+            to.unlink();
+            return;
+        }
+        to.next = from.next;
+        to.prev = from.prev;
+        to.next->prev = &to;
+        to.prev->next = &to;
+        from.unlink();
+    }
+
+    // 接管rhs的结点, 需要的话连配置器一起移动过来
+    template <class T, class Alloc>
+    void list<T, Alloc>::move_assign(list &rhs, m_true_type) noexcept {
+        list temp(my_stl::move(*this));             /* 旧结点交给temp用旧配置器释放 */
+        my_stl::alloc_on_move(alloc_ref(), rhs.alloc_ref());
+        take_nodes(sentinel_, rhs.sentinel_);
+        size_ = rhs.size_;
+        rhs.size_ = 0;
+    }
+
+    // 配置器不传播, 不相等时rhs的结点不能由本配置器释放, 只能逐个移动元素
+    template <class T, class Alloc>
+    void list<T, Alloc>::move_assign(list &rhs, m_false_type) {
+        if (alloc_ref() == rhs.alloc_ref()) {
+            move_assign(rhs, m_true_type());
+            return;
+        }
+        clear();
+        move_elements_from(rhs);
+    }
+
+    template <class T, class Alloc>
+    void list<T, Alloc>::move_elements_from(list &rhs) {
+        for (auto it = rhs.begin(); it != rhs.end(); ++it)
+            emplace_back(my_stl::move(*it));
+        rhs.clear();
     }
 
     // 用n个元素初始化容器
-    template <class T>
-    void list<T>::fill_init(size_type n, const value_type &value) {
-        node_ = base_allocator::allocate(1);
-        node_->unlink();
+    template <class T, class Alloc>
+    void list<T, Alloc>::fill_init(size_type n, const value_type &value) {
+        sentinel_.unlink();
         size_ = n;
         try {
             for (; n > 0; --n) {
@@ -715,18 +912,15 @@ namespace my_stl {
             }
         } catch (...) {
             clear();
-            base_allocator::deallocate(node_);
-            node_ = nullptr;
             throw ;
         }
     }
 
     // [first, last)初始化
-    template <class T>
+    template <class T, class Alloc>
     template <class Iter>
-    void list<T>::copy_init(Iter first, Iter last) {
-        node_ = base_allocator::allocate(1);
-        node_->unlink();
+    void list<T, Alloc>::copy_init(Iter first, Iter last) {
+        sentinel_.unlink();
         size_type n = my_stl::distance(first, last);
         size_ = n;
         try {
@@ -736,20 +930,18 @@ namespace my_stl {
             }
         } catch (...) {
             clear();
-            base_allocator::deallocate(node_);
-            node_ = nullptr;
             throw;
         }
     }
 
     //在pos处连接一个结点
-    template <class T>
-    typename list<T>::iterator
-    list<T>::link_iter_node(const_iterator pos, base_ptr node) {
-        if (pos == node_->next) {
+    template <class T, class Alloc>
+    typename list<T, Alloc>::iterator
+    list<T, Alloc>::link_iter_node(const_iterator pos, base_ptr node) {
+        if (pos == sentinel()->next) {
             link_nodes_at_front(node, node);
         }
-        else if (pos == node_) {
+        else if (pos == sentinel()) {
             link_nodes_at_back(node, node);
         }
         else {
@@ -759,8 +951,8 @@ namespace my_stl {
     }
 
     //pos处连接[first, last]
-    template <class T>
-    void list<T>::link_nodes(base_ptr pos, base_ptr first, base_ptr last) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::link_nodes(base_ptr pos, base_ptr first, base_ptr last) {
         pos->prev->next = first;
         first->prev = pos->prev;
         pos->prev = last;
@@ -768,33 +960,33 @@ namespace my_stl {
     }
 
     //头插,可能存在bug,测试通过, 无bug
-    template <class T>
-    void list<T>::link_nodes_at_front(base_ptr first, base_ptr last) {
-        node_->next->prev = last;
-        last->next = node_->next;
-        node_->next = first;
-        first->prev = node_;
+    template <class T, class Alloc>
+    void list<T, Alloc>::link_nodes_at_front(base_ptr first, base_ptr last) {
+        sentinel()->next->prev = last;
+        last->next = sentinel()->next;
+        sentinel()->next = first;
+        first->prev = sentinel();
     }
 
     //尾插 可能存在bug
-    template <class T>
-    void list<T>::link_nodes_at_back(base_ptr first, base_ptr last) {
-        node_->prev->next = first;
-        first->prev = node_->prev;
-        last->next = node_;
-        node_->prev = last;
+    template <class T, class Alloc>
+    void list<T, Alloc>::link_nodes_at_back(base_ptr first, base_ptr last) {
+        sentinel()->prev->next = first;
+        first->prev = sentinel()->prev;
+        last->next = sentinel();
+        sentinel()->prev = last;
     }
 
     // 容器与[first, last]结点断开连接
-    template <class T>
-    void list<T>::unlink_nodes(base_ptr first, base_ptr last) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::unlink_nodes(base_ptr first, base_ptr last) {
         first->prev->next = last->next;
         last->next->prev = first->prev;
     }
 
     // 用n个元素为容器赋值
-    template <class T>
-    void list<T>::fill_assign(size_type n, const value_type &value) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::fill_assign(size_type n, const value_type &value) {
         auto i = begin();
         auto e = end();
         for (; n > 0 && i != e; --n, ++i)
@@ -806,13 +998,13 @@ namespace my_stl {
     }
 
     // [first, last)赋值
-    template <class T>
+    template <class T, class Alloc>
     template <class Iter>
-    void list<T>::copy_assign(Iter first, Iter last) {
+    void list<T, Alloc>::copy_assign(Iter first, Iter last) {
         auto f1 = begin();
         auto l1 = end();
         for (; f1 != l1 && first != last; ++f1, ++first)
-            *f1 = first;
+            *f1 = *first;
         if (last == first)
             erase(f1, l1);
         else
@@ -820,9 +1012,9 @@ namespace my_stl {
     }
 
     // pos处插入n个元素
-    template <class T>
-    typename list<T>::iterator
-    list<T>::fill_insert(const_iterator pos, size_type n, const value_type &value) {
+    template <class T, class Alloc>
+    typename list<T, Alloc>::iterator
+    list<T, Alloc>::fill_insert(const_iterator pos, size_type n, const value_type &value) {
         iterator r(pos.node_);
         if (n != 0) {
             const auto add_size = n;
@@ -853,10 +1045,10 @@ namespace my_stl {
     }
 
     //pos处插入[first, last)
-    template <class T>
+    template <class T, class Alloc>
     template <class Iter>
-    typename list<T>::iterator
-    list<T>::copy_insert(const_iterator pos, size_type n, Iter first) {
+    typename list<T, Alloc>::iterator
+    list<T, Alloc>::copy_insert(const_iterator pos, size_type n, Iter first) {
         iterator r(pos.node_);
         if (n != 0) {
             const auto add_size = n;
@@ -887,79 +1079,174 @@ namespace my_stl {
         return r;
     }
 
-    //对list进行归并排序, 参考《MyTinySTL》
-    template <class T>
+    // 先把(值, 结点)按链表顺序抄进连续的数组, 对数组stable_sort, 再按数组顺序一遍重新链接结点.
+    // 排序时不再沿next追指针, 只在抄出和重新链接时各访问每个结点一次.
+    // 排序的过程中链表本身不动, 比较抛出异常时链表保持原样. 拿不到数组的空间时返回false
+    template <class T, class Alloc>
+    template <class Compared>
+    bool list<T, Alloc>::gather_sort(Compared comp) {
+        struct entry {
+            T        value;
+            base_ptr node;
+        };
+        auto buf = static_cast<entry*>(std::malloc(size_ * sizeof(entry)));
+        if (buf == nullptr)
+            return false;
+        auto p = buf;
+        for (auto node = sentinel()->next; node != sentinel(); node = node->next, ++p)
+            my_stl::construct(p, entry{node->as_node()->value, node});
+        try {
+            my_stl::stable_sort(buf, buf + size_, [&](const entry &lhs, const entry &rhs) {
+                return comp(lhs.value, rhs.value);
+            });
+        } catch (...) {
+            std::free(buf);
+            throw;
+        }
+        base_ptr prev = sentinel();
+        for (p = buf; p != buf + size_; ++p) {
+            prev->next = p->node;
+            p->node->prev = prev;
+            prev = p->node;
+        }
+        prev->next = sentinel();
+        sentinel()->prev = prev;
+        std::free(buf);
+        return true;
+    }
+
+    template <class T, class Alloc>
+    template <class Compared>
+    void list<T, Alloc>::sort_aux(Compared comp, m_true_type) {
+        if (size_ >= list_gather_sort_threshold && gather_sort(comp))
+            return;
+        list_sort(comp);
+    }
+
+    // 把有序链from合并进into, 相等时into的结点在前, 结束后from为空.
+    // 合并时顺带维护prev(结点正在缓存里), 链内除首结点外prev都有效, 不必事后再走一遍.
+    // 比较抛出异常时剩下的结点都接到into上(顺序未定, 只保证next), 不丢结点
+    template <class T, class Alloc>
     template <class Compared>
-    typename list<T>::iterator
-    list<T>::list_sort(iterator f1, iterator l2, size_type n, Compared comp) {
-        if (n < 2)
-            return f1;
-        if (n == 2) {
-            if (comp(*--l2, *f1)) {
-                auto ln = l2.node_;
-                unlink_nodes(ln, ln);
-                link_nodes(f1.node_, ln, ln);
-                return l2;
+    void list<T, Alloc>::merge_chains(node_chain &into, node_chain &from, Compared &comp) {
+        list_node_base<T> head;
+        base_ptr tail = &head;
+        base_ptr a = into.first;
+        base_ptr b = from.first;
+        try {
+            while (a != nullptr && b != nullptr) {
+                if (comp(b->as_node()->value, a->as_node()->value)) {
+                    tail->next = b;
+                    b->prev = tail;
+                    b = b->next;
+                }
+                else {
+                    tail->next = a;
+                    a->prev = tail;
+                    a = a->next;
+                }
+                tail = tail->next;
             }
-            return f1;
-        }
-
-        auto n2 = n / 2;
-        auto l1 = f1;
-        my_stl::advance(l1, n2);
-        auto result = f1 = list_sort(f1, l1, n2, comp);
-        auto f2 = l1 = list_sort(l1, l2, n - n2, comp);
-
-        if (comp(*f2, *f1)) {
-            auto m = f2;
-            ++m;
-            for (; m != l2 && comp(*m, *f1); ++m)
-                ;
-            auto f = f2.node_;
-            auto l = m.node_->prev;
-            result = f2;
-            l1 = f2 = m;
-            unlink_nodes(f, l);
-            m = f1;
-            ++m;
-            link_nodes(f1.node_, f, l);
-            f1 = m;
+        } catch (...) {
+            tail->next = a;
+            while (tail->next != nullptr)
+                tail = tail->next;
+            tail->next = b;
+            into.first = head.next;
+            from.first = from.last = nullptr;
+            throw;
+        }
+        /* 剩下的一段内部的prev本来就是对的 */
+        if (a != nullptr) {
+            tail->next = a;
+            a->prev = tail;
         }
         else {
-            ++f1;
+            tail->next = b;
+            b->prev = tail;
+            into.last = from.last;
         }
+        into.first = head.next;
+        from.first = from.last = nullptr;
+    }
 
-        // 合并两段有序区间
-        while (f1 != l1 && f2 != l2)
-        {
-            if (comp(*f2, *f1))
-            {
-                auto m = f2;
-                ++m;
-                for (; m != l2 && comp(*m, *f1); ++m)
-                    ;
-                auto f = f2.node_;
-                auto l = m.node_->prev;
-                if (l1 == f2)
-                    l1 = m;
-                f2 = m;
-                unlink_nodes(f, l);
-                m = f1;
-                ++m;
-                link_nodes(f1.node_, f, l);
-                f1 = m;
+    // 以next为准重新设置prev, 把单链first挂回哨兵, 只在排序出错时使用
+    template <class T, class Alloc>
+    void list<T, Alloc>::relink_chain(base_ptr first) noexcept {
+        sentinel()->next = first;
+        base_ptr prev = sentinel();
+        for (auto p = first; p != nullptr; p = p->next) {
+            p->prev = prev;
+            prev = p;
+        }
+        prev->next = sentinel();
+        sentinel()->prev = prev;
+    }
+
+    // 自底向上的归并排序: 结点逐个取下放入bins, bins[i]为空或是长为2^i的有序链,
+    // 像二进制加法一样进位合并; 最后把所有bins合并起来挂回哨兵.
+    // 不找中点, 不递归, 只需要64条链的首尾指针. 稳定
+    template <class T, class Alloc>
+    template <class Compared>
+    void list<T, Alloc>::list_sort(Compared comp) {
+        if (size_ < 2)
+            return;
+        node_chain bins[64] = {};
+        size_t fill = 0;                /* 用到的bins个数 */
+        node_chain carry = {};
+        node_chain result = {};
+        sentinel()->prev->next = nullptr;
+        base_ptr rest = sentinel()->next;
+        try {
+            while (rest != nullptr) {
+                carry.first = carry.last = rest;
+                rest = rest->next;
+                carry.last->next = nullptr;
+                size_t i = 0;
+                for (; i < fill && bins[i].first != nullptr; ++i) {
+                    merge_chains(bins[i], carry, comp);     /* bins[i]里的元素在前 */
+                    carry = bins[i];
+                    bins[i].first = bins[i].last = nullptr;
+                }
+                bins[i] = carry;
+                carry.first = carry.last = nullptr;
+                if (i == fill)
+                    ++fill;
             }
-            else
-            {
-                ++f1;
+            for (size_t i = 0; i < fill; ++i) {
+                if (bins[i].first != nullptr) {
+                    merge_chains(bins[i], result, comp);
+                    result = bins[i];
+                    bins[i].first = bins[i].last = nullptr;
+                }
             }
+        } catch (...) {
+            /* 所有链首尾相接挂回去, 元素一个不少, 顺序未定 */
+            auto append = [&](base_ptr chain) {
+                if (chain == nullptr)
+                    return;
+                auto tail = chain;
+                while (tail->next != nullptr)
+                    tail = tail->next;
+                tail->next = rest;
+                rest = chain;
+            };
+            append(carry.first);
+            append(result.first);
+            for (size_t i = 0; i < fill; ++i)
+                append(bins[i].first);
+            relink_chain(rest);
+            throw;
         }
-        return result;
+        sentinel()->next = result.first;
+        result.first->prev = sentinel();
+        result.last->next = sentinel();
+        sentinel()->prev = result.last;
     }
 
     // 重载比较操作符
-    template <class T>
-    bool operator==(const list<T>& lhs, const list<T>& rhs)
+    template <class T, class Alloc>
+    bool operator==(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
     {
         auto f1 = lhs.cbegin();
         auto f2 = rhs.cbegin();
@@ -970,46 +1257,46 @@ namespace my_stl {
         return f1 == l1 && f2 == l2;
     }
 
-    template <class T>
-    bool operator<(const list<T>& lhs, const list<T>& rhs)
+    template <class T, class Alloc>
+    bool operator<(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
     {
         return my_stl::s_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
     }
 
-    template <class T>
-    bool operator!=(const list<T>& lhs, const list<T>& rhs)
+    template <class T, class Alloc>
+    bool operator!=(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
     {
         return !(lhs == rhs);
     }
 
-    template <class T>
-    bool operator>(const list<T>& lhs, const list<T>& rhs)
+    template <class T, class Alloc>
+    bool operator>(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
     {
         return rhs < lhs;
     }
 
-    template <class T>
-    bool operator<=(const list<T>& lhs, const list<T>& rhs)
+    template <class T, class Alloc>
+    bool operator<=(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
     {
         return !(rhs < lhs);
     }
 
-    template <class T>
-    bool operator>=(const list<T>& lhs, const list<T>& rhs)
+    template <class T, class Alloc>
+    bool operator>=(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs)
     {
         return !(lhs < rhs);
     }
 
 // 重载 my_stl 的 swap
-    template <class T>
-    void swap(list<T>& lhs, list<T>& rhs) noexcept
+    template <class T, class Alloc>
+    void swap(list<T, Alloc>& lhs, list<T, Alloc>& rhs) noexcept
     {
         lhs.swap(rhs);
     }
 
     //增加输出重载
-    template <class T>
-    std::ostream& operator<<(std::ostream &os, const list<T> &l) {
+    template <class T, class Alloc>
+    std::ostream& operator<<(std::ostream &os, const list<T, Alloc> &l) {
         for (auto it = l.begin(); it != l.end(); ++it) {
             os << *it << " ";
         }
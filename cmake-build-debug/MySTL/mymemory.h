@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <cstdio>
+#include <cstdlib>
 #include <climits>
 #include "algobase.h"
 #include "allocator.h"
@@ -57,6 +58,8 @@ namespace my_stl {
      class temporary_buffer {
      public:
          temporary_buffer(ForwardIter first, ForwardIter last);
+         temporary_buffer(const temporary_buffer&) = delete;
+         temporary_buffer& operator=(const temporary_buffer&) = delete;
          ~temporary_buffer() {my_stl::destroy(buffer, buffer + len); free(buffer);}
 
      public:
@@ -77,7 +80,8 @@ namespace my_stl {
      };
 
      template <class ForwardIter, class T>
-     temporary_buffer<ForwardIter, T>::temporary_buffer(ForwardIter first, ForwardIter last) {
+     temporary_buffer<ForwardIter, T>::temporary_buffer(ForwardIter first, ForwardIter last)
+             : original_len(0), len(0), buffer(nullptr) {
          try {
              len = my_stl::distance(first, last);   /* 计算地址长度 */
              allocate_buffer();
@@ -0,0 +1,207 @@
+//
+// Created by 陈燊 on 2021/12/22.
+//
+
+#ifndef MY_STL_PARALLEL_ALGO_H
+#define MY_STL_PARALLEL_ALGO_H
+
+#include <cstddef>
+#include <cstdint>
+#include "algo.h"
+#include "allocator.h"
+#include "construct.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+/*
+ * 多线程算法, 任务交给thread_pool(默认是thread_pool::default_pool(), 线程数等于硬件线程数)
+ *   parallel_sort   样本排序(sample sort), 不稳定
+ *
+ * parallel_sort的过程:
+ *   1. 均匀抽样并排序, 选出桶的分界点(splitter); 重复的分界点合并, 每个分界点再单独占一个"相等桶",
+ *      大量重复元素时相等桶不必排序, 其余桶也不会因此变得过大
+ *   2. 区间切成若干块, 并行统计每块落到每个桶的元素数, 由此算出每块每桶在缓冲区中的写入位置
+ *   3. 并行地把每块的元素移动到缓冲区中各自的桶里
+ *   4. 并行地用sort排序每个桶, 然后移回原区间
+ * 每个桶至少有grain个元素; 元素少于2 * grain或者只有一个执行者时直接调用串行的sort.
+ * 需要一块和区间一样大的缓冲区. 比较或移动抛出异常时, 缓冲区里的元素先移回原区间被移走的位置再析构,
+ * 原区间仍是原来那些元素, 顺序未定. 和sort一样只提供基本保证: 比较抛出异常时插入排序正在挪动的那个元素,
+ * 以及移动构造/移动赋值抛出异常时正在移动的元素, 会停留在被移动后的状态.
+ */
+
+namespace my_stl {
+    constexpr size_t parallel_sort_grain = size_t(1) << 16;  /* 默认每个桶至少的元素数 */
+    constexpr size_t parallel_sort_oversample = 32;          /* 每个分界点对应的样本数 */
+    constexpr size_t parallel_sort_buckets_per_thread = 4;   /* 桶多于线程数, 桶大小不均时也能分摊 */
+
+    /* 分界点和元素所属桶的计算 */
+    template <class T, class Compare>
+    class sample_sort_classifier {
+    public:
+        sample_sort_classifier(my_stl::vector<T> &&splitters, Compare comp)
+                : splitters_(my_stl::move(splitters)), comp_(comp) {}
+
+        /* 分界点s[0] < s[1] < ... < s[k - 1]对应2k + 1个桶: 2i号桶是(s[i - 1], s[i]), 2i + 1号桶等于s[i] */
+        size_t buckets() const noexcept {return 2 * splitters_.size() + 1;}
+
+        size_t operator()(const T &x) const {
+            const size_t i = static_cast<size_t>(
+                    my_stl::upper_bound(splitters_.begin(), splitters_.end(), x, comp_) - splitters_.begin());
+            if (i > 0 && !comp_(splitters_[i - 1], x))
+                return 2 * i - 1;
+            return 2 * i;
+        }
+
+    private:
+        my_stl::vector<T> splitters_;
+        Compare           comp_;
+    };
+
+    /* 从[first, first + n)中抽样, 排序后等间隔地取出分界点, 去掉重复的 */
+    template <class RandomIter, class Compare>
+    my_stl::vector<typename iterator_traits<RandomIter>::value_type>
+    choose_splitters(RandomIter first, size_t n, size_t buckets, Compare comp) {
+        typedef typename iterator_traits<RandomIter>::value_type value_type;
+        const size_t sample_size = buckets * parallel_sort_oversample;
+        my_stl::vector<value_type> sample;
+        sample.reverse(sample_size);
+        /* xorshift随机取样, 避免等距取样碰上输入里的周期 */
+        uint64_t state = 0x9e3779b97f4a7c15ull ^ n;
+        for (size_t i = 0; i < sample_size; ++i) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            sample.push_back(first[static_cast<ptrdiff_t>(state % n)]);
+        }
+        my_stl::sort(sample.begin(), sample.end(), comp);
+
+        my_stl::vector<value_type> splitters;
+        splitters.reverse(buckets - 1);
+        for (size_t b = 1; b < buckets; ++b) {
+            const auto &s = sample[b * parallel_sort_oversample];
+            if (splitters.empty() || comp(splitters.back(), s))
+                splitters.push_back(s);
+        }
+        return splitters;
+    }
+
+    template <class RandomIter, class Compare>
+    void parallel_sort(RandomIter first, RandomIter last, Compare comp, size_t grain, thread_pool &pool) {
+        typedef typename iterator_traits<RandomIter>::value_type value_type;
+        typedef my_stl::allocator<value_type>                    allocator_type;
+
+        const size_t n = static_cast<size_t>(last - first);
+        if (grain == 0)
+            grain = 1;
+        if (pool.size() < 2 || n < 2 * grain) {
+            my_stl::sort(first, last, comp);
+            return;
+        }
+
+        /* 块数与期望的桶数相同 */
+        size_t chunks = pool.size() * parallel_sort_buckets_per_thread;
+        if (chunks > n / grain)
+            chunks = n / grain;
+        const sample_sort_classifier<value_type, Compare> classify(
+                my_stl::choose_splitters(first, n, chunks, comp), comp);
+        const size_t buckets = classify.buckets();
+        if (buckets == 1) {
+            my_stl::sort(first, last, comp);
+            return;
+        }
+        auto chunk_begin = [&](size_t c) {return n / chunks * c + (c < n % chunks ? c : n % chunks);};
+
+        /* 每块每桶的元素数, 按块优先存放 */
+        my_stl::vector<size_t> count(chunks * buckets, 0);
+        pool.parallel_for(chunks, [&](size_t c) {
+            size_t *cnt = count.data() + c * buckets;
+            for (size_t i = chunk_begin(c), e = chunk_begin(c + 1); i != e; ++i)
+                ++cnt[classify(first[static_cast<ptrdiff_t>(i)])];
+        });
+
+        /* 缓冲区中按桶排列, 同一个桶里按块排列 */
+        my_stl::vector<size_t> offset(chunks * buckets, 0);
+        my_stl::vector<size_t> bucket_begin(buckets + 1, 0);
+        size_t running = 0;
+        for (size_t b = 0; b < buckets; ++b) {
+            bucket_begin[b] = running;
+            for (size_t c = 0; c < chunks; ++c) {
+                offset[c * buckets + b] = running;
+                running += count[c * buckets + b];
+            }
+        }
+        bucket_begin[buckets] = running;
+        const my_stl::vector<size_t> start(offset);
+
+        value_type *buf = allocator_type::allocate(n);
+        my_stl::vector<char> released(buckets, 0);
+        bool scattered = false;
+        try {
+            pool.parallel_for(chunks, [&](size_t c) {
+                size_t *pos = offset.data() + c * buckets;
+                for (size_t i = chunk_begin(c), e = chunk_begin(c + 1); i != e; ++i) {
+                    auto &x = first[static_cast<ptrdiff_t>(i)];
+                    const size_t b = classify(x);
+                    my_stl::construct(buf + pos[b], my_stl::move(x));
+                    ++pos[b];
+                }
+            });
+            scattered = true;
+
+            pool.parallel_for(buckets, [&](size_t b) {
+                value_type *bfirst = buf + bucket_begin[b];
+                value_type *blast = buf + bucket_begin[b + 1];
+                /* 奇数号桶里的元素都相等 */
+                if (b % 2 == 0)
+                    my_stl::sort(bfirst, blast, comp);
+                my_stl::move(bfirst, blast, first + static_cast<ptrdiff_t>(bucket_begin[b]));
+                my_stl::destroy(bfirst, blast);
+                released[b] = 1;
+            });
+        } catch (...) {
+            /* parallel_for返回前所有下标都已执行完, offset和released不会再变.
+             * 分配阶段每块移走的是块开头的一段, 把它在各个桶里的部分依次移回这一段;
+             * 之后还没有移回的桶原样移回它在原区间对应的位置. 移回时再抛出异常就不再移动, 只做清理 */
+            try {
+                if (!scattered) {
+                    for (size_t c = 0; c < chunks; ++c) {
+                        auto out = first + static_cast<ptrdiff_t>(chunk_begin(c));
+                        for (size_t b = 0; b < buckets; ++b)
+                            out = my_stl::move(buf + start[c * buckets + b], buf + offset[c * buckets + b], out);
+                    }
+                }
+                else {
+                    for (size_t b = 0; b < buckets; ++b)
+                        if (!released[b])
+                            my_stl::move(buf + bucket_begin[b], buf + bucket_begin[b + 1],
+                                         first + static_cast<ptrdiff_t>(bucket_begin[b]));
+                }
+            } catch (...) {
+            }
+            if (!scattered) {
+                for (size_t k = 0; k < chunks * buckets; ++k)
+                    my_stl::destroy(buf + start[k], buf + offset[k]);
+            }
+            else {
+                for (size_t b = 0; b < buckets; ++b)
+                    if (!released[b])
+                        my_stl::destroy(buf + bucket_begin[b], buf + bucket_begin[b + 1]);
+            }
+            allocator_type::deallocate(buf, n);
+            throw;
+        }
+        allocator_type::deallocate(buf, n);
+    }
+
+    template <class RandomIter, class Compare>
+    void parallel_sort(RandomIter first, RandomIter last, Compare comp, size_t grain = parallel_sort_grain) {
+        my_stl::parallel_sort(first, last, comp, grain, thread_pool::default_pool());
+    }
+
+    template <class RandomIter>
+    void parallel_sort(RandomIter first, RandomIter last) {
+        my_stl::parallel_sort(first, last, my_stl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+}
+
+#endif //MY_STL_PARALLEL_ALGO_H
@@ -0,0 +1,720 @@
+//
+// Created by 陈燊 on 2021/12/13.
+//
+
+#ifndef MY_STL_SMALL_VECTOR_H
+#define MY_STL_SMALL_VECTOR_H
+#include <initializer_list>
+#include <cstring>
+#include <type_traits>
+#include "iterator.h"
+#include "mymemory.h"
+#include "util.h"
+#include "exceptdef.h"
+#include <iostream>
+
+/*
+ * small_vector<T, N>
+ * 带小缓冲区优化的vector: 对象内部预留N个元素的空间, 元素不超过N个时不向配置器申请内存,
+ * 超过之后透明地搬到堆上, 之后的行为与vector一致(按2倍扩容).
+ * 接口与my_stl::vector相同(包括reverse(n)预留空间, print, operator<<), 另外提供is_inline()查询元素是否在内部缓冲区.
+ *
+ * 与vector的不同:
+ *   元素在内部缓冲区时, 移动构造/移动赋值/swap需要逐个移动元素, 迭代器会失效;
+ *   对象本身包含指向内部缓冲区的指针, 不能按字节搬运(不是is_trivially_relocatable).
+ * 元素可平凡重定位时, 扩容, 插入, 删除同样用memcpy/memmove整段搬运.
+ */
+
+namespace my_stl {
+    template <class T, size_t N, class Alloc = my_stl::allocator<T>>
+    class small_vector : private my_stl::alloc_holder<Alloc> {
+        static_assert(N > 0, "small_vector needs at least one inline element\n");
+        static_assert(!std::is_same<bool, T>::value, "small_vector<bool> not in my_stl\n");
+
+    public:
+        typedef Alloc                                       allocator_type;
+        typedef my_stl::allocator_traits<Alloc>             alloc_traits;
+
+        typedef T                                           value_type;
+        typedef typename alloc_traits::pointer              pointer;
+        typedef typename alloc_traits::const_pointer        const_pointer;
+        typedef value_type&                                 reference;
+        typedef const value_type&                           const_reference;
+        typedef typename alloc_traits::size_type            size_type;
+        typedef typename alloc_traits::difference_type      difference_type;
+
+        typedef value_type*                                 iterator;
+        typedef const value_type*                           const_iterator;
+        typedef my_stl::reverse_iterator<iterator>          reverse_iterator;
+        typedef my_stl::reverse_iterator<const_iterator>    const_reverse_iterator;
+
+        allocator_type get_allocator() const {return this->alloc_ref();}
+
+    private:
+        typedef my_stl::alloc_holder<Alloc>                 holder;
+        using holder::alloc_ref;
+
+        /* 使用空间头部, 使用空间尾部, 存储空间尾部, 元素在内部时指向buf_ */
+        iterator begin_;
+        iterator end_;
+        iterator cap_;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type buf_[N];
+
+    public:
+        /* 构造，复制，移动，析构 */
+        small_vector() noexcept {reset_inline();}
+        explicit small_vector(const allocator_type &a) noexcept : holder(a) {reset_inline();}
+
+        explicit small_vector(size_type n, const allocator_type &a = allocator_type()) : holder(a) {
+            reset_inline();
+            fill_init(n, value_type());
+        }
+
+        small_vector(size_type n, const value_type &value, const allocator_type &a = allocator_type())
+                : holder(a) {
+            reset_inline();
+            fill_init(n, value);
+        }
+
+        template<class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        small_vector(Iter first, Iter last, const allocator_type &a = allocator_type()) : holder(a) {
+            reset_inline();
+            range_init(first, last);
+        }
+
+        small_vector(std::initializer_list<value_type> list, const allocator_type &a = allocator_type())
+                : holder(a) {
+            reset_inline();
+            range_init(list.begin(), list.end());
+        }
+
+        small_vector(const small_vector &rhs)
+                : holder(alloc_traits::select_on_container_copy_construction(rhs.alloc_ref())) {
+            reset_inline();
+            range_init(rhs.begin_, rhs.end_);
+        }
+
+        /* rhs在堆上时直接接管空间, 在内部缓冲区时只能逐个移动元素 */
+        small_vector(small_vector &&rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+                : holder(my_stl::move(rhs.alloc_ref())) {
+            reset_inline();
+            take_from(rhs);
+        }
+
+        small_vector& operator=(const small_vector &rhs);
+        small_vector& operator=(small_vector &&rhs);
+        small_vector& operator=(std::initializer_list<value_type> list) {
+            copy_assign(list.begin(), list.end(), my_stl::forward_iterator_tag{});
+            return *this;
+        }
+
+        ~small_vector() {
+            alloc_traits::destroy(alloc_ref(), begin_, end_);
+            release_heap();
+        }
+
+    public:
+        /* 迭代器操作 */
+        iterator begin()        noexcept {return begin_;}
+        const_iterator begin()  const noexcept {return begin_;}
+        iterator end()          noexcept {return end_;}
+        const_iterator end()    const noexcept {return end_;}
+
+        reverse_iterator rbegin()           noexcept {return reverse_iterator(end_);}
+        const_reverse_iterator  rbegin()    const noexcept {return const_reverse_iterator(end_);}
+        reverse_iterator rend()             noexcept {return reverse_iterator(begin_);}
+        const_reverse_iterator rend()       const noexcept {return const_reverse_iterator(begin_);}
+
+        const_iterator cbegin()             const noexcept {return begin_;}
+        const_iterator cend()               const noexcept {return end_;}
+        const_reverse_iterator crbegin()    const noexcept {return rbegin();}
+        const_reverse_iterator crend()      const noexcept {return rend();}
+
+        /* 容量操作 */
+        bool empty() const noexcept {return begin_ == end_;}
+        size_type size() const noexcept {return static_cast<size_type>(end_ - begin_);}
+        size_type max_size() const noexcept {return alloc_traits::max_size(alloc_ref());}
+        size_type capacity() const noexcept {return static_cast<size_type>(cap_ - begin_);}
+        bool is_inline() const noexcept {return begin_ == inline_begin();}
+
+        /* 与vector一致, reverse(n)预留至少n个元素的空间 */
+        void reverse(size_type n) {
+            if (capacity() < n) {
+                THROW_LENGTH_ERROR_IF(n > max_size(),
+                                      "can not larger than max_size() in small_vector<T>::reverse(n)");
+                grow(n);
+            }
+        }
+        void shrink_to_fit();
+
+        /* 元素访问操作 */
+        reference operator[](size_type n) {
+            MYSTL_DEBUG(n < size());
+            return *(begin_ + n);
+        }
+
+        const_reference operator[](size_type n) const {
+            MYSTL_DEBUG(n < size());
+            return *(begin_ + n);
+        }
+
+        reference at(size_type n) {
+            THROW_OUT_OF_RANGE_IF(!(n < size()), "small_vector<T>::at() subscript out of range.\n");
+            return (*this)[n];
+        }
+
+        const_reference at(size_type n) const {
+            THROW_OUT_OF_RANGE_IF(!(n < size()), "small_vector<T>::at() subscript out of range.\n");
+            return (*this)[n];
+        }
+
+        reference front() {
+            MYSTL_DEBUG(!empty());
+            return *begin_;
+        }
+
+        const_reference front() const {
+            MYSTL_DEBUG(!empty());
+            return *begin_;
+        }
+
+        reference back() {
+            MYSTL_DEBUG(!empty());
+            return *(end_ - 1);
+        }
+
+        const_reference back() const {
+            MYSTL_DEBUG(!empty());
+            return *(end_ - 1);
+        }
+
+        pointer data() noexcept {return begin_;}
+        const_pointer data() const noexcept {return begin_;}
+
+        /* assign */
+        template<class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        void assign(Iter first, Iter last) {copy_assign(first, last, iterator_category(first));}
+        void assign(size_type n, const value_type &value) {
+            clear();
+            fill_insert(end_, n, value);
+        }
+        void assign(std::initializer_list<value_type> list) {
+            copy_assign(list.begin(), list.end(), my_stl::forward_iterator_tag{});
+        }
+
+        /* emplace / emplace_back / push_back / pop_back */
+        template<class ...Args>
+        iterator emplace(const_iterator pos, Args &&...args);
+
+        template<class ...Args>
+        void emplace_back(Args &&...args) {
+            if (end_ != cap_) {
+                alloc_traits::construct(alloc_ref(), end_, my_stl::forward<Args>(args)...);
+                ++end_;
+            }
+            else {
+                reallocate_emplace_back(my_stl::forward<Args>(args)...);
+            }
+        }
+
+        void push_back(const value_type &value) {emplace_back(value);}
+        void push_back(value_type &&value) {emplace_back(my_stl::move(value));}
+
+        void pop_back() {
+            MYSTL_DEBUG(!empty());
+            alloc_traits::destroy(alloc_ref(), end_ - 1);
+            --end_;
+        }
+
+        void print(const char *ends = " ");
+
+        /* insert */
+        template <class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        void insert(const_iterator pos, Iter first, Iter last) {
+            MYSTL_DEBUG(pos >= begin() && pos <= end());
+            copy_insert(const_cast<iterator>(pos), first, last);
+        }
+
+        iterator insert(const_iterator pos, const value_type &value) {return emplace(pos, value);}
+        iterator insert(const_iterator pos, value_type &&value) {return emplace(pos, my_stl::move(value));}
+        iterator insert(const_iterator pos, size_type n, const value_type &value) {
+            MYSTL_DEBUG(pos >= begin() && pos <= end());
+            return fill_insert(const_cast<iterator>(pos), n, value);
+        }
+
+        /* erase / clear */
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+        void clear() noexcept {
+            alloc_traits::destroy(alloc_ref(), begin_, end_);
+            end_ = begin_;
+        }
+
+        /* resize / reverse */
+        void resize(size_type new_size) {resize(new_size, value_type());}
+        void resize(size_type new_size, const value_type &value) {
+            if (new_size < size())
+                erase(begin_ + new_size, end_);
+            else
+                fill_insert(end_, new_size - size(), value);
+        }
+        void reverse() {
+            if (size() > 1) {
+                for (auto l = begin_, r = end_ - 1; l < r; ++l, --r)
+                    my_stl::swap(*l, *r);
+            }
+        }
+
+        /* 两边都在堆上时只交换指针, 否则逐个移动元素 */
+        void swap(small_vector &rhs);
+
+    private:
+        /* 内部缓冲区 */
+        iterator inline_begin() const noexcept {
+            return reinterpret_cast<iterator>(const_cast<small_vector*>(this)->buf_);
+        }
+        void reset_inline() noexcept {
+            begin_ = end_ = inline_begin();
+            cap_ = begin_ + N;
+        }
+        /* 在堆上时把空间还给配置器, 不析构元素 */
+        void release_heap() noexcept {
+            if (!is_inline())
+                alloc_traits::deallocate(alloc_ref(), begin_, capacity());
+        }
+
+        /* 初始化 */
+        void fill_init(size_type n, const value_type &value);
+        template <class Iter> void range_init(Iter first, Iter last);
+
+        /* 接管rhs的元素, 调用前*this必须为空且在内部缓冲区 */
+        void take_from(small_vector &rhs);
+
+        /* 赋值 */
+        template <class Iter> void copy_assign(Iter first, Iter last, my_stl::input_iterator_tag);
+        template <class Iter> void copy_assign(Iter first, Iter last, my_stl::forward_iterator_tag);
+
+        /* 扩容: 新容量至少能再放下add_size个元素, 按2倍增长 */
+        size_type get_new_cap(size_type add_size);
+        /* 把所有元素搬到容量为new_cap的堆空间, new_cap不小于size() */
+        void grow(size_type new_cap);
+        template <class ...Args>
+        void reallocate_emplace_back(Args &&...args);
+
+        /* 元素是否可以按字节搬运 */
+        static constexpr bool relocatable() {return is_trivially_relocatable<T>::value;}
+
+        /* 把[pos, end)整体后移n个位置/前移回来, 只用于可平凡重定位的元素 */
+        void shift_right(iterator pos, size_type n) {
+            std::memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos),
+                         static_cast<size_t>(end_ - pos) * sizeof(T));
+        }
+        void shift_left(iterator pos, size_type n) {
+            std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + n),
+                         static_cast<size_t>(end_ - pos) * sizeof(T));
+        }
+
+        /* 插入 */
+        template <class Iter>
+        void copy_insert(iterator pos, Iter first, Iter last);
+        iterator fill_insert(iterator pos, size_type n, const value_type &value);
+    };
+
+    /**************************************************************************************
+     * 实现
+     **************************************************************************************/
+    template <class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>& small_vector<T, N, Alloc>::operator=(const small_vector &rhs) {
+        if (this == &rhs)
+            return *this;
+        /* 要传播的配置器和当前的不相等, 旧空间只能由旧配置器释放 */
+        if (alloc_traits::propagate_on_container_copy_assignment::value &&
+            !my_stl::alloc_equal(alloc_ref(), rhs.alloc_ref())) {
+            clear();
+            release_heap();
+            reset_inline();
+        }
+        my_stl::alloc_on_copy(alloc_ref(), rhs.alloc_ref());
+        copy_assign(rhs.begin_, rhs.end_, my_stl::forward_iterator_tag{});
+        return *this;
+    }
+
+    /* rhs在堆上且配置器可以接管时直接换指针, 否则逐个移动元素 */
+    template <class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>& small_vector<T, N, Alloc>::operator=(small_vector &&rhs) {
+        if (this == &rhs)
+            return *this;
+        clear();
+        if (!rhs.is_inline() &&
+            (alloc_traits::propagate_on_container_move_assignment::value ||
+             my_stl::alloc_equal(alloc_ref(), rhs.alloc_ref()))) {
+            release_heap();
+            reset_inline();
+            my_stl::alloc_on_move(alloc_ref(), rhs.alloc_ref());
+            take_from(rhs);
+            return *this;
+        }
+        if (rhs.size() > capacity())
+            grow(rhs.size());
+        end_ = my_stl::uninitialized_move(rhs.begin_, rhs.end_, begin_);
+        rhs.clear();
+        return *this;
+    }
+
+    template <class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::take_from(small_vector &rhs) {
+        if (!rhs.is_inline()) {
+            begin_ = rhs.begin_;
+            end_ = rhs.end_;
+            cap_ = rhs.cap_;
+            rhs.reset_inline();
+            return;
+        }
+        end_ = my_stl::uninitialized_relocate(rhs.begin_, rhs.end_, begin_);
+        rhs.end_ = rhs.begin_;
+    }
+
+    template <class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::swap(small_vector &rhs) {
+        if (this == &rhs)
+            return;
+        /* 配置器不传播时两者必须相等, 否则行为未定义 */
+        MYSTL_DEBUG(alloc_traits::propagate_on_container_swap::value ||
+                    my_stl::alloc_equal(alloc_ref(), rhs.alloc_ref()));
+        if (!is_inline() && !rhs.is_inline()) {
+            my_stl::alloc_on_swap(alloc_ref(), rhs.alloc_ref());
+            my_stl::swap(begin_, rhs.begin_);
+            my_stl::swap(end_, rhs.end_);
+            my_stl::swap(cap_, rhs.cap_);
+            return;
+        }
+        small_vector temp(my_stl::move(rhs));
+        rhs = my_stl::move(*this);
+        *this = my_stl::move(temp);
+    }
+
+    /* 放弃多余的容量, 放得下时搬回内部缓冲区 */
+    template <class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::shrink_to_fit() {
+        if (is_inline() || end_ == cap_)
+            return;
+        iterator old_begin = begin_;
+        const size_type old_cap = capacity();
+        const size_type n = size();
+        if (n <= N) {
+            my_stl::uninitialized_relocate(begin_, end_, inline_begin());
+            reset_inline();
+            end_ = begin_ + n;
+            alloc_traits::deallocate(alloc_ref(), old_begin, old_cap);
+        }
+        else {
+            iterator new_begin = alloc_traits::allocate(alloc_ref(), n);
+            try {
+                my_stl::uninitialized_relocate(begin_, end_, new_begin);
+            } catch (...) {
+                alloc_traits::deallocate(alloc_ref(), new_begin, n);
+                throw;
+            }
+            alloc_traits::deallocate(alloc_ref(), old_begin, old_cap);
+            begin_ = new_begin;
+            end_ = cap_ = new_begin + n;
+        }
+    }
+
+    template <class T, size_t N, class Alloc>
+    template <class ...Args>
+    typename small_vector<T, N, Alloc>::iterator
+    small_vector<T, N, Alloc>::emplace(const_iterator pos, Args &&...args) {
+        MYSTL_DEBUG(pos >= begin() && pos <= end());
+        const size_type n = pos - begin_;
+        if (pos == end_) {
+            emplace_back(my_stl::forward<Args>(args)...);
+            return begin_ + n;
+        }
+        /* 先构造出新元素, 防止args引用的正是要后移的元素 */
+        value_type value(my_stl::forward<Args>(args)...);
+        if (end_ == cap_)
+            grow(get_new_cap(1));
+        iterator x_pos = begin_ + n;
+        if (relocatable()) {
+            shift_right(x_pos, 1);
+            try {
+                alloc_traits::construct(alloc_ref(), x_pos, my_stl::move(value));
+            } catch (...) {
+                shift_left(x_pos, 1);
+                throw;
+            }
+        }
+        else {
+            alloc_traits::construct(alloc_ref(), end_, my_stl::move(*(end_ - 1)));
+            my_stl::move_backward(x_pos, end_ - 1, end_);
+            *x_pos = my_stl::move(value);
+        }
+        ++end_;
+        return x_pos;
+    }
+
+    template <class T, size_t N, class Alloc>
+    typename small_vector<T, N, Alloc>::iterator
+    small_vector<T, N, Alloc>::erase(const_iterator pos) {
+        MYSTL_DEBUG(pos >= begin() && pos < end());
+        iterator x_pos = begin_ + (pos - begin());
+        if (relocatable()) {
+            alloc_traits::destroy(alloc_ref(), x_pos);
+            --end_;
+            shift_left(x_pos, 1);
+        }
+        else {
+            my_stl::move(x_pos + 1, end_, x_pos);
+            alloc_traits::destroy(alloc_ref(), end_ - 1);
+            --end_;
+        }
+        return x_pos;
+    }
+
+    template <class T, size_t N, class Alloc>
+    typename small_vector<T, N, Alloc>::iterator
+    small_vector<T, N, Alloc>::erase(const_iterator first, const_iterator last) {
+        MYSTL_DEBUG(first >= begin() && last <= end() && !(last < first));
+        iterator r = begin_ + (first - begin());
+        const size_type len = last - first;
+        if (len == 0)
+            return r;
+        if (relocatable()) {
+            alloc_traits::destroy(alloc_ref(), r, r + len);
+            end_ -= len;
+            shift_left(r, len);
+        }
+        else {
+            alloc_traits::destroy(alloc_ref(), my_stl::move(r + len, end_, r), end_);
+            end_ -= len;
+        }
+        return r;
+    }
+
+    template <class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::fill_init(size_type n, const value_type &value) {
+        if (n > N)
+            grow(n);
+        end_ = my_stl::uninitialized_fill_n(begin_, n, value);
+    }
+
+    template <class T, size_t N, class Alloc>
+    template <class Iter>
+    void small_vector<T, N, Alloc>::range_init(Iter first, Iter last) {
+        copy_assign(first, last, iterator_category(first));
+    }
+
+    template <class T, size_t N, class Alloc>
+    template <class Iter>
+    void small_vector<T, N, Alloc>::copy_assign(Iter first, Iter last, my_stl::input_iterator_tag) {
+        clear();
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    /* 能复用的元素直接赋值, 多出来的构造或析构 */
+    template <class T, size_t N, class Alloc>
+    template <class Iter>
+    void small_vector<T, N, Alloc>::copy_assign(Iter first, Iter last, my_stl::forward_iterator_tag) {
+        const size_type len = my_stl::distance(first, last);
+        if (len > capacity()) {
+            clear();
+            grow(len);
+            end_ = my_stl::uninitialized_copy(first, last, begin_);
+        }
+        else if (size() >= len) {
+            auto new_end = my_stl::copy(first, last, begin_);
+            alloc_traits::destroy(alloc_ref(), new_end, end_);
+            end_ = new_end;
+        }
+        else {
+            auto mid = first;
+            my_stl::advance(mid, size());
+            my_stl::copy(first, mid, begin_);
+            end_ = my_stl::uninitialized_copy(mid, last, end_);
+        }
+    }
+
+    template <class T, size_t N, class Alloc>
+    typename small_vector<T, N, Alloc>::size_type
+    small_vector<T, N, Alloc>::get_new_cap(size_type add_size) {
+        const size_type old_size = size();
+        THROW_LENGTH_ERROR_IF(old_size > max_size() - add_size, "small_vector<T>'s size too big..\n");
+        const size_type cap = capacity();
+        const size_type grown = cap > max_size() / 2 ? max_size() : cap * 2;
+        return my_stl::max(grown, old_size + add_size);
+    }
+
+    template <class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::grow(size_type new_cap) {
+        const size_type n = size();
+        iterator new_begin = alloc_traits::allocate(alloc_ref(), new_cap);
+        try {
+            my_stl::uninitialized_relocate(begin_, end_, new_begin);
+        } catch (...) {
+            alloc_traits::deallocate(alloc_ref(), new_begin, new_cap);
+            throw;
+        }
+        release_heap();
+        begin_ = new_begin;
+        end_ = new_begin + n;
+        cap_ = new_begin + new_cap;
+    }
+
+    /* 先在新空间构造新元素(args可能引用旧元素), 再把旧元素搬过去 */
+    template <class T, size_t N, class Alloc>
+    template <class ...Args>
+    void small_vector<T, N, Alloc>::reallocate_emplace_back(Args &&...args) {
+        const size_type n = size();
+        const size_type new_cap = get_new_cap(1);
+        iterator new_begin = alloc_traits::allocate(alloc_ref(), new_cap);
+        try {
+            alloc_traits::construct(alloc_ref(), new_begin + n, my_stl::forward<Args>(args)...);
+        } catch (...) {
+            alloc_traits::deallocate(alloc_ref(), new_begin, new_cap);
+            throw;
+        }
+        try {
+            my_stl::uninitialized_relocate(begin_, end_, new_begin);
+        } catch (...) {
+            alloc_traits::destroy(alloc_ref(), new_begin + n);
+            alloc_traits::deallocate(alloc_ref(), new_begin, new_cap);
+            throw;
+        }
+        release_heap();
+        begin_ = new_begin;
+        end_ = new_begin + n + 1;
+        cap_ = new_begin + new_cap;
+    }
+
+    template <class T, size_t N, class Alloc>
+    typename small_vector<T, N, Alloc>::iterator
+    small_vector<T, N, Alloc>::fill_insert(iterator pos, size_type n, const value_type &value) {
+        const size_type x_pos = pos - begin_;
+        if (n == 0)
+            return pos;
+        const value_type value_copy = value;                /* 避免原值被覆盖 */
+        if (static_cast<size_type>(cap_ - end_) < n)
+            grow(get_new_cap(n));
+        pos = begin_ + x_pos;
+        const size_type after_elements = end_ - pos;
+        auto old_end = end_;
+        if (relocatable()) {
+            shift_right(pos, n);
+            try {
+                my_stl::uninitialized_fill_n(pos, n, value_copy);
+            } catch (...) {
+                shift_left(pos, n);
+                throw;
+            }
+            end_ += n;
+        }
+        else if (after_elements > n) {
+            end_ = my_stl::uninitialized_move(end_ - n, end_, end_);
+            my_stl::move_backward(pos, old_end - n, old_end);
+            my_stl::fill_n(pos, n, value_copy);
+        }
+        else {
+            end_ = my_stl::uninitialized_fill_n(end_, n - after_elements, value_copy);
+            end_ = my_stl::uninitialized_move(pos, old_end, end_);
+            my_stl::fill_n(pos, after_elements, value_copy);
+        }
+        return begin_ + x_pos;
+    }
+
+    template <class T, size_t N, class Alloc>
+    template <class Iter>
+    void small_vector<T, N, Alloc>::copy_insert(iterator pos, Iter first, Iter last) {
+        if (first == last)
+            return;
+        const size_type x_pos = pos - begin_;
+        const size_type n = my_stl::distance(first, last);
+        if (static_cast<size_type>(cap_ - end_) < n)
+            grow(get_new_cap(n));
+        pos = begin_ + x_pos;
+        const size_type after_elements = end_ - pos;
+        auto old_end = end_;
+        if (relocatable()) {
+            shift_right(pos, n);
+            try {
+                my_stl::uninitialized_copy(first, last, pos);
+            } catch (...) {
+                shift_left(pos, n);
+                throw;
+            }
+            end_ += n;
+        }
+        else if (after_elements > n) {
+            end_ = my_stl::uninitialized_move(end_ - n, end_, end_);
+            my_stl::move_backward(pos, old_end - n, old_end);
+            my_stl::copy(first, last, pos);
+        }
+        else {
+            auto mid = first;
+            my_stl::advance(mid, after_elements);
+            end_ = my_stl::uninitialized_copy(mid, last, end_);
+            end_ = my_stl::uninitialized_move(pos, old_end, end_);
+            my_stl::copy(first, mid, pos);
+        }
+    }
+
+    template <class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::print(const char *ends) {
+        for (auto first = begin(); first != end(); ++first)
+            std::cout << *first << ends;
+        std::cout << std::endl;
+    }
+
+    /**************************************************************************************
+    * 重载比较运算符
+    **************************************************************************************/
+    template <class T, size_t N, class Alloc>
+    std::ostream& operator<<(std::ostream &os, const small_vector<T, N, Alloc> &vec) {
+        for (auto it = vec.begin(); it != vec.end(); ++it) {
+            os << *it << " ";
+        }
+        os << std::endl;
+        return os;
+    }
+
+    template <class T, size_t N, class Alloc>
+    bool operator==(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs) {
+        return lhs.size() == rhs.size() && my_stl::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <class T, size_t N, class Alloc>
+    bool operator<(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs) {
+        return my_stl::s_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    template <class T, size_t N, class Alloc>
+    bool operator!=(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs) {
+        return !(lhs == rhs);
+    }
+
+    template <class T, size_t N, class Alloc>
+    bool operator>(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs) {
+        return rhs < lhs;
+    }
+
+    template <class T, size_t N, class Alloc>
+    bool operator<=(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs) {
+        return !(rhs < lhs);
+    }
+
+    template <class T, size_t N, class Alloc>
+    bool operator>=(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs) {
+        return !(lhs < rhs);
+    }
+
+    template <class T, size_t N, class Alloc>
+    void swap(small_vector<T, N, Alloc> &lhs, small_vector<T, N, Alloc> &rhs) {
+        lhs.swap(rhs);
+    }
+}
+
+#endif //MY_STL_SMALL_VECTOR_H
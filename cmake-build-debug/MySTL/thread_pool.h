@@ -0,0 +1,147 @@
+//
+// Created by 陈燊 on 2021/12/22.
+//
+
+#ifndef MY_STL_THREAD_POOL_H
+#define MY_STL_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "vector.h"
+
+/*
+ * 一个很小的线程池, 给并行算法(parallel_algo.h)使用
+ *   thread_pool pool(n);          n个执行者: 调用线程自己加上n - 1个工作线程
+ *   pool.parallel_for(count, f);  f(0), f(1), ..., f(count - 1)分给所有执行者, 全部完成后返回
+ * parallel_for是fork-join的: 调用线程也参与执行, 任务按下标原子地领取, 先做完的线程继续领下一个.
+ * 任务抛出的第一个异常会在parallel_for返回前重新抛给调用者, 其余任务照常执行完.
+ * 同一时刻只应有一个线程在某个pool上调用parallel_for, 任务里不要再嵌套调用同一个pool.
+ */
+
+namespace my_stl {
+    class thread_pool {
+    public:
+        /* 默认执行者个数等于硬件线程数 */
+        explicit thread_pool(size_t threads = std::thread::hardware_concurrency())
+                : stop_(false), generation_(0), job_(nullptr), active_(0) {
+            if (threads == 0)
+                threads = 1;
+            workers_.reverse(threads - 1);
+            for (size_t i = 1; i < threads; ++i)
+                workers_.emplace_back([this] {worker_loop();});
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto &t : workers_)
+                t.join();
+        }
+
+        /* 执行者个数(包括调用线程) */
+        size_t size() const noexcept {return workers_.size() + 1;}
+
+        template <class Fn>
+        void parallel_for(size_t count, Fn fn);
+
+        /* 进程内共享的线程池 */
+        static thread_pool& default_pool() {
+            static thread_pool pool;
+            return pool;
+        }
+
+    private:
+        /* 一次parallel_for的状态, 放在调用者的栈上 */
+        struct job {
+            std::function<void(size_t)> fn;
+            size_t                      count;
+            std::atomic<size_t>         next;
+            std::exception_ptr          error;
+            std::mutex                  error_mutex;
+
+            /* 不断领取下标执行, 没有剩余时返回 */
+            void run() {
+                size_t i;
+                while ((i = next.fetch_add(1)) < count) {
+                    try {
+                        fn(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (!error)
+                            error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        void worker_loop();
+
+    private:
+        my_stl::vector<std::thread> workers_;
+        std::mutex                  mutex_;
+        std::condition_variable     wake_;      /* 有新任务或要退出 */
+        std::condition_variable     finished_;  /* 有工作线程离开了当前任务 */
+        bool                        stop_;
+        size_t                      generation_;
+        job                        *job_;
+        size_t                      active_;    /* 正在执行job_的工作线程数 */
+    };
+
+    template <class Fn>
+    void thread_pool::parallel_for(size_t count, Fn fn) {
+        if (count == 0)
+            return;
+        job j;
+        j.fn = fn;
+        j.count = count;
+        j.next = 0;
+        if (!workers_.empty() && count > 1) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                job_ = &j;
+                ++generation_;
+            }
+            wake_.notify_all();
+        }
+        j.run();
+        /* 等所有下标执行完, 并且没有工作线程还在引用j */
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            job_ = nullptr;
+            finished_.wait(lock, [&] {return active_ == 0;});
+        }
+        if (j.error)
+            std::rethrow_exception(j.error);
+    }
+
+    inline void thread_pool::worker_loop() {
+        size_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [&] {return stop_ || (job_ != nullptr && generation_ != seen);});
+            if (stop_)
+                return;
+            seen = generation_;
+            job *j = job_;
+            ++active_;
+            lock.unlock();
+            j->run();
+            lock.lock();
+            if (--active_ == 0)
+                finished_.notify_all();
+        }
+    }
+}
+
+#endif //MY_STL_THREAD_POOL_H
@@ -25,6 +25,23 @@ namespace my_stl {
 
     template <class T1, class T2>
     struct is_pair<my_stl::pair<T1, T2>> : my_stl::m_true_type {};
+
+    /*
+     * is_trivially_relocatable
+     * 可平凡重定位: 把对象按字节搬到新地址并且不再析构旧对象, 效果等同于移动构造新对象再析构旧对象.
+     * 平凡可复制的型别天然满足; 只持有指向堆内存的指针而不指向自身的型别(如vector)也满足.
+     * 自定义型别可以特化此模板(或使用MYSTL_TRIVIALLY_RELOCATABLE宏)声明自己可重定位,
+     * 容器扩容, 插入, 删除时就会用memcpy/memmove代替逐个移动和析构.
+     */
+    template <class T>
+    struct is_trivially_relocatable : m_bool_constant<std::is_trivially_copyable<T>::value> {};
+
+    template <class T1, class T2>
+    struct is_trivially_relocatable<my_stl::pair<T1, T2>>
+            : m_bool_constant<is_trivially_relocatable<T1>::value && is_trivially_relocatable<T2>::value> {};
+
+    #define MYSTL_TRIVIALLY_RELOCATABLE(Type) \
+    namespace my_stl { template <> struct is_trivially_relocatable<Type> : m_true_type {}; }
 }
 
 
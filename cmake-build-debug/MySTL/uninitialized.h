@@ -41,10 +41,9 @@ namespace my_stl {
                  cur++;
              }
          } catch (...) {
-             while (cur != result) {
-                 my_stl::destroy(&*cur);
-                 cur--;
-             }
+             /* 回滚已经构造好的元素 */
+             my_stl::destroy(result, cur);
+             throw;
          }
          return cur;
      }
@@ -81,10 +80,8 @@ namespace my_stl {
                   ++first;
               }
           } catch (...) {
-              while (result != cur) {
-                  my_stl::destroy(&*cur);
-                  --cur;
-              }
+              my_stl::destroy(result, cur);
+              throw;
           }
           return cur;
       }
@@ -118,12 +115,9 @@ namespace my_stl {
                    cur++;
                }
            } catch (...) {
-               while (cur != first) {
-                   my_stl::destroy(&*first);
-                   ++first;
-               }
+               my_stl::destroy(first, cur);
+               throw;
            }
-           return cur;
        }
 
        template <class ForwardIter, class T>
@@ -151,13 +145,12 @@ namespace my_stl {
             try {
                 while (n > 0) {
                     my_stl::construct(&*cur, value);
-                    cur++;
+                    --n;
+                    ++cur;
                 }
             } catch (...) {
-                while (first != cur) {
-                    my_stl::destroy(&*first);
-                    first++;
-                }
+                my_stl::destroy(first, cur);
+                throw;
             }
             return cur;
         }
@@ -186,13 +179,14 @@ namespace my_stl {
         unchecked_uninitialized_move(InputIter first, InputIter last, ForwardIter result, std::false_type) {
             auto cur = result;
             try {
-                while (cur != last) {
+                while (first != last) {
                     my_stl::construct(&*cur, my_stl::move(*first));
                     ++first;
                     ++cur;
                 }
             } catch (...) {
                 my_stl::destroy(result, cur);
+                throw;
             }
             return cur;
         }
@@ -223,13 +217,13 @@ namespace my_stl {
              try {
                  while (n > 0) {
                      my_stl::construct(&*cur, my_stl::move(*first));
-                     n--;
+                     --n;
+                     ++first;
+                     ++cur;
                  }
              } catch (...) {
-                 while (result != cur) {
-                     my_stl::destroy(&*result);
-                     result++;
-                 }
+                 my_stl::destroy(result, cur);
+                 throw;
              }
              return cur;
          }
@@ -242,6 +236,33 @@ namespace my_stl {
                                                            typename iterator_traits<InputIter>::
                                                            value_type>{});
          }
+
+        /******************************************************************************************
+         * uninitialized_relocate
+         * 把[first, last)上的对象搬到result为起始的未初始化空间, 返回搬运结束的位置.
+         * 搬完之后[first, last)视为未初始化, 不需要再析构.
+         * 可平凡重定位的型别直接memcpy, 否则逐个移动构造再析构原对象. 两段空间不能重叠.
+         ******************************************************************************************/
+         template <class T>
+         T* unchecked_uninitialized_relocate(T *first, T *last, T *result, m_true_type) {
+             const size_t n = static_cast<size_t>(last - first);
+             if (n != 0)
+                 std::memcpy(static_cast<void*>(result), static_cast<const void*>(first), n * sizeof(T));
+             return result + n;
+         }
+
+         template <class T>
+         T* unchecked_uninitialized_relocate(T *first, T *last, T *result, m_false_type) {
+             T *cur = my_stl::uninitialized_move(first, last, result);
+             my_stl::destroy(first, last);
+             return cur;
+         }
+
+         template <class T>
+         T* uninitialized_relocate(T *first, T *last, T *result) {
+             return my_stl::unchecked_uninitialized_relocate(first, last, result,
+                                                             m_bool_constant<is_trivially_relocatable<T>::value>());
+         }
 }
 
 #endif //MY_STL_UNINITIALIZED_H
@@ -0,0 +1,1001 @@
+//
+// Created by 陈燊 on 2021/12/24.
+//
+
+#ifndef MY_STL_UNROLLED_LIST_H
+#define MY_STL_UNROLLED_LIST_H
+#include <initializer_list>
+#include <cstdint>
+#include <type_traits>
+#include "iterator.h"
+#include "mymemory.h"
+#include "algo.h"
+#include "functional.h"
+#include "util.h"
+#include "vector.h"
+#include "exceptdef.h"
+#include "instrument.h"
+#include <iostream>
+
+/*
+ * unrolled_list<T, K>
+ * 展开链表: 每个结点存放最多K个元素, 结点内的元素连续存放在槽位[first, last)中.
+ * 一个结点只分配一次, 遍历时K个元素共享一次缓存缺失; K默认让结点的数据区约256字节.
+ * 接口与list相同: push/pop两端, insert, erase, splice, remove_if, unique, merge, sort, reverse.
+ * 另外提供for_each_segment(fn), 按结点把连续的元素段[first, last)交给fn, 便于编译器向量化.
+ *
+ * 与list的不同:
+ *   push_back往尾结点的后部放, push_front往头结点的前部放, 队列式的使用不搬动元素;
+ *   在结点中间insert/erase会移动该结点内较短的一侧, 结点满时对半分裂;
+ *   insert/erase只使该结点内的迭代器失效, 其他结点的迭代器不受影响;
+ *   splice先在边界处分裂结点, 再整体搬运中间的结点, 因此可能分配内存(list的splice不分配);
+ *   merge和sort移动元素而不是重新链接结点, 所有迭代器失效;
+ *   erase不合并半空的结点, 需要时调用shrink_to_fit()重新装满.
+ */
+
+namespace my_stl {
+    /* 默认每个结点的元素个数, 数据区约256字节, 至少2个 */
+    constexpr size_t unrolled_list_default_count(size_t size) noexcept {
+        return size >= 128 ? 2 : 256 / size;
+    }
+
+    /* 结点头, 哨兵就是一个没有元素的结点头 */
+    template <class T>
+    struct unrolled_node_base {
+        typedef unrolled_node_base<T>* base_ptr;
+
+        base_ptr prev;
+        base_ptr next;
+        uint32_t first;         /* 元素占用槽位[first, last) */
+        uint32_t last;
+
+        void unlink() noexcept {
+            prev = next = this;
+            first = last = 0;
+        }
+        size_t count() const noexcept {return last - first;}
+    };
+
+    template <class T, size_t K>
+    struct unrolled_node : public unrolled_node_base<T> {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type slots[K];
+
+        T* data() noexcept {return reinterpret_cast<T*>(slots);}
+    };
+
+    /*
+     * unrolled_list的迭代器: 结点加槽位, 双向迭代器
+     * end()是(哨兵, 0)
+     */
+    template <class T, size_t K, class Ref, class Ptr>
+    struct unrolled_list_iterator : public my_stl::iterator<my_stl::bidirectional_iterator_tag, T> {
+        typedef T                                               value_type;
+        typedef Ptr                                             pointer;
+        typedef Ref                                             reference;
+        typedef unrolled_node_base<T>*                          base_ptr;
+        typedef unrolled_node<T, K>*                            node_ptr;
+        typedef unrolled_list_iterator<T, K, T&, T*>            iterator;
+        typedef unrolled_list_iterator<T, K, const T&, const T*> const_iterator;
+        typedef unrolled_list_iterator                          self;
+
+        base_ptr node_;     /* 所在结点 */
+        size_t   slot_;     /* 结点中的槽位 */
+
+        unrolled_list_iterator() = default;
+        unrolled_list_iterator(base_ptr node, size_t slot) : node_(node), slot_(slot) {}
+        /* iterator到const_iterator的转换. 写成模板并且对iterator自身不启用,
+         * 这样它不是拷贝构造函数, 拷贝构造和拷贝赋值仍由编译器隐式生成 */
+        template <class Iter, typename std::enable_if<
+                std::is_same<Iter, iterator>::value && !std::is_same<Iter, self>::value, int>::type = 0>
+        unrolled_list_iterator(const Iter &rhs) : node_(rhs.node_), slot_(rhs.slot_) {}
+
+        reference operator*() const {return static_cast<node_ptr>(node_)->data()[slot_];}
+        pointer   operator->() const {return &(operator*());}
+
+        self& operator++() {
+            MYSTL_DEBUG(node_ != nullptr);
+            if (++slot_ == node_->last) {
+                node_ = node_->next;
+                slot_ = node_->first;
+            }
+            return *this;
+        }
+
+        self operator++(int) {
+            self temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        self& operator--() {
+            MYSTL_DEBUG(node_ != nullptr);
+            if (slot_ == node_->first) {
+                node_ = node_->prev;
+                slot_ = node_->last;
+            }
+            --slot_;
+            return *this;
+        }
+
+        self operator--(int) {
+            self temp = *this;
+            --*this;
+            return temp;
+        }
+
+        bool operator==(const self &rhs) const {return node_ == rhs.node_ && slot_ == rhs.slot_;}
+        bool operator!=(const self &rhs) const {return !(*this == rhs);}
+    };
+
+    template <class T, size_t K = unrolled_list_default_count(sizeof(T)), class Alloc = my_stl::allocator<T>>
+    class unrolled_list : private my_stl::alloc_holder<
+            typename my_stl::allocator_traits<Alloc>::template rebind_alloc<unrolled_node<T, K>>> {
+        static_assert(K >= 2, "unrolled_list needs at least two elements per node\n");
+        static_assert(K <= UINT32_MAX, "unrolled_list node too large\n");
+
+    public:
+        typedef Alloc                                   allocator_type;
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<unrolled_node<T, K>> node_allocator;
+        typedef my_stl::allocator_traits<node_allocator> node_alloc_traits;
+
+        typedef T                                       value_type;
+        typedef T*                                      pointer;
+        typedef const T*                                const_pointer;
+        typedef T&                                      reference;
+        typedef const T&                                const_reference;
+        typedef size_t                                  size_type;
+        typedef ptrdiff_t                               difference_type;
+
+        typedef unrolled_list_iterator<T, K, T&, T*>             iterator;
+        typedef unrolled_list_iterator<T, K, const T&, const T*> const_iterator;
+        typedef my_stl::reverse_iterator<iterator>               reverse_iterator;
+        typedef my_stl::reverse_iterator<const_iterator>         const_reverse_iterator;
+
+        static constexpr size_type node_capacity = K;   /* 每个结点的元素个数 */
+
+        allocator_type get_allocator() const {return allocator_type(alloc_ref());}
+
+    private:
+        typedef my_stl::alloc_holder<node_allocator>    holder;
+        typedef unrolled_node_base<T>*                  base_ptr;
+        typedef unrolled_node<T, K>*                    node_ptr;
+        using holder::alloc_ref;
+
+        unrolled_node_base<T> sentinel_;                /* 内嵌的哨兵, end()就是它 */
+        size_type size_;
+
+        base_ptr sentinel() const noexcept {return const_cast<base_ptr>(&sentinel_);}
+        static T* data(base_ptr node) noexcept {return static_cast<node_ptr>(node)->data();}
+        static iterator make_iter(const_iterator it) noexcept {return iterator(it.node_, it.slot_);}
+
+    public:
+        /* 空容器不分配任何空间 */
+        unrolled_list() noexcept : size_(0) {sentinel_.unlink();}
+        explicit unrolled_list(const allocator_type &a) noexcept : holder(node_allocator(a)), size_(0) {
+            sentinel_.unlink();
+        }
+
+        explicit unrolled_list(size_type n, const allocator_type &a = allocator_type())
+                : holder(node_allocator(a)) {fill_init(n, value_type());}
+
+        unrolled_list(size_type n, const T &value, const allocator_type &a = allocator_type())
+                : holder(node_allocator(a)) {fill_init(n, value);}
+
+        template <class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        unrolled_list(Iter first, Iter last, const allocator_type &a = allocator_type())
+                : holder(node_allocator(a)) {copy_init(first, last);}
+
+        unrolled_list(std::initializer_list<T> i_list, const allocator_type &a = allocator_type())
+                : holder(node_allocator(a)) {copy_init(i_list.begin(), i_list.end());}
+
+        unrolled_list(const unrolled_list &rhs)
+                : holder(node_alloc_traits::select_on_container_copy_construction(rhs.alloc_ref())) {
+            copy_init(rhs.begin(), rhs.end());
+        }
+
+        /* 接管rhs的结点链 */
+        unrolled_list(unrolled_list &&rhs) noexcept : holder(my_stl::move(rhs.alloc_ref())), size_(rhs.size_) {
+            take_nodes(sentinel_, rhs.sentinel_);
+            rhs.size_ = 0;
+        }
+
+        unrolled_list& operator=(const unrolled_list &rhs) {
+            if (this != &rhs) {
+                clear();
+                my_stl::alloc_on_copy(alloc_ref(), rhs.alloc_ref());
+                insert(end(), rhs.begin(), rhs.end());
+            }
+            return *this;
+        }
+
+        unrolled_list& operator=(unrolled_list &&rhs);
+
+        unrolled_list& operator=(std::initializer_list<T> i_list) {
+            assign(i_list.begin(), i_list.end());
+            return *this;
+        }
+
+        ~unrolled_list() {clear();}
+
+    public:
+        /* 迭代器相关接口 */
+        iterator begin() noexcept {return iterator(sentinel_.next, sentinel_.next->first);}
+        const_iterator begin() const noexcept {return const_iterator(sentinel_.next, sentinel_.next->first);}
+        iterator end() noexcept {return iterator(sentinel(), 0);}
+        const_iterator end() const noexcept {return const_iterator(sentinel(), 0);}
+
+        reverse_iterator rbegin() noexcept {return reverse_iterator(end());}
+        const_reverse_iterator rbegin() const noexcept {return const_reverse_iterator(end());}
+        reverse_iterator rend() noexcept {return reverse_iterator(begin());}
+        const_reverse_iterator rend() const noexcept {return const_reverse_iterator(begin());}
+
+        const_iterator cbegin() const noexcept {return begin();}
+        const_iterator cend() const noexcept {return end();}
+        const_reverse_iterator crbegin() const noexcept {return rbegin();}
+        const_reverse_iterator crend() const noexcept {return rend();}
+
+        /* 容器相关操作 */
+        bool empty() const noexcept {return size_ == 0;}
+        size_type size() const noexcept {return size_;}
+        size_type max_size() const noexcept {return static_cast<size_type>(-1);}
+        size_type node_count() const noexcept;
+
+        /* 访问元素相关操作 */
+        reference front() {
+            MYSTL_DEBUG(!empty());
+            return data(sentinel_.next)[sentinel_.next->first];
+        }
+
+        const_reference front() const {
+            MYSTL_DEBUG(!empty());
+            return data(sentinel_.next)[sentinel_.next->first];
+        }
+
+        reference back() {
+            MYSTL_DEBUG(!empty());
+            return data(sentinel_.prev)[sentinel_.prev->last - 1];
+        }
+
+        const_reference back() const {
+            MYSTL_DEBUG(!empty());
+            return data(sentinel_.prev)[sentinel_.prev->last - 1];
+        }
+
+        /* 按结点遍历: fn(first, last)依次收到每个结点里连续的元素段 */
+        template <class Fn>
+        void for_each_segment(Fn fn) {
+            for (auto p = sentinel_.next; p != sentinel(); p = p->next)
+                fn(data(p) + p->first, data(p) + p->last);
+        }
+
+        template <class Fn>
+        void for_each_segment(Fn fn) const {
+            for (auto p = sentinel_.next; p != sentinel(); p = p->next)
+                fn(const_cast<const T*>(data(p) + p->first), const_cast<const T*>(data(p) + p->last));
+        }
+
+        /* 调整容器操作 */
+        void assign(size_type n, const value_type &value) {
+            clear();
+            insert(end(), n, value);
+        }
+
+        template <class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        void assign(Iter first, Iter last) {
+            clear();
+            insert(end(), first, last);
+        }
+
+        void assign(std::initializer_list<T> i_list) {assign(i_list.begin(), i_list.end());}
+
+        /* emplace_front / emplace_back / emplace */
+        template <class ...Args>
+        void emplace_front(Args &&...args);
+
+        template <class ...Args>
+        void emplace_back(Args &&...args);
+
+        template <class ...Args>
+        iterator emplace(const_iterator pos, Args &&...args);
+
+        /* insert */
+        iterator insert(const_iterator pos, const value_type &value) {return emplace(pos, value);}
+        iterator insert(const_iterator pos, value_type &&value) {return emplace(pos, my_stl::move(value));}
+
+        iterator insert(const_iterator pos, size_type n, const value_type &value) {
+            unrolled_list temp(n, value, get_allocator());
+            return splice_in(pos, temp);
+        }
+
+        template <class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        iterator insert(const_iterator pos, Iter first, Iter last) {
+            unrolled_list temp(first, last, get_allocator());
+            return splice_in(pos, temp);
+        }
+
+        iterator insert(const_iterator pos, std::initializer_list<T> i_list) {
+            return insert(pos, i_list.begin(), i_list.end());
+        }
+
+        /* push_back / push_front */
+        void push_front(const value_type &value) {emplace_front(value);}
+        void push_front(value_type &&value) {emplace_front(my_stl::move(value));}
+        void push_back(const value_type &value) {emplace_back(value);}
+        void push_back(value_type &&value) {emplace_back(my_stl::move(value));}
+
+        /* pop_back / pop_front, 结点空了就释放 */
+        void pop_front() {
+            MYSTL_DEBUG(!empty());
+            auto node = sentinel_.next;
+            node_alloc_traits::destroy(alloc_ref(), data(node) + node->first);
+            ++node->first;
+            --size_;
+            if (node->first == node->last)
+                free_node(node);
+        }
+
+        void pop_back() {
+            MYSTL_DEBUG(!empty());
+            auto node = sentinel_.prev;
+            --node->last;
+            node_alloc_traits::destroy(alloc_ref(), data(node) + node->last);
+            --size_;
+            if (node->first == node->last)
+                free_node(node);
+        }
+
+        /* erase / clear */
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+        void clear() noexcept;
+
+        /* resize */
+        void resize(size_type new_size) {resize(new_size, value_type());}
+        void resize(size_type new_size, const value_type &value);
+
+        /* 把元素重新装进尽量少的结点, 所有迭代器失效 */
+        void shrink_to_fit();
+
+        void swap(unrolled_list &rhs) noexcept {
+            MYSTL_DEBUG(node_alloc_traits::propagate_on_container_swap::value ||
+                        my_stl::alloc_equal(alloc_ref(), rhs.alloc_ref()));
+            my_stl::alloc_on_swap(alloc_ref(), rhs.alloc_ref());
+            unrolled_node_base<T> temp;
+            take_nodes(temp, sentinel_);
+            take_nodes(sentinel_, rhs.sentinel_);
+            take_nodes(rhs.sentinel_, temp);
+            my_stl::swap(size_, rhs.size_);
+        }
+
+        /* splice: 在pos和区间的边界处分裂结点, 再整体搬运结点 */
+        void splice(const_iterator pos, unrolled_list &other);
+        void splice(const_iterator pos, unrolled_list &other, const_iterator it);
+        void splice(const_iterator pos, unrolled_list &other, const_iterator first, const_iterator last);
+
+        /* 相关操作 */
+        template <class Unary>
+        void remove_if(Unary pred);
+        void remove(const value_type &value) {remove_if([&](const value_type &v) {return v == value;});}
+
+        template <class Binary>
+        void unique(Binary pred);
+        void unique() {unique(my_stl::equal_to<T>());}
+
+        template <class Compare>
+        void merge(unrolled_list &x, Compare comp);
+        void merge(unrolled_list &x) {merge(x, my_stl::less<T>());}
+
+        template <class Compare>
+        void sort(Compare comp);
+        void sort() {sort(my_stl::less<T>());}
+
+        void reverse() noexcept;
+
+    private:
+        /* ************************************辅助函数***********************************************/
+        /* 分配和释放结点, 结点里的元素由调用者构造和析构 */
+        node_ptr create_node();
+        void destroy_node(base_ptr p) noexcept;
+        void free_node(base_ptr p) noexcept;
+
+        static void take_nodes(unrolled_node_base<T> &to, unrolled_node_base<T> &from) noexcept;
+        static void link_nodes(base_ptr pos, base_ptr first, base_ptr last) noexcept;
+        static void unlink_nodes(base_ptr first, base_ptr last) noexcept;
+
+        /* 初始化 */
+        template <class Iter>
+        void copy_init(Iter first, Iter last);
+        void fill_init(size_type n, const value_type &value);
+
+        /* 槽位slot是node的末尾时换成下一个结点的开头 */
+        static iterator normalize(base_ptr node, size_t slot) noexcept {
+            return slot == node->last ? iterator(node->next, node->next->first) : iterator(node, slot);
+        }
+
+        /* 让*it成为结点的第一个元素, 返回这个结点; it在结点开头(或是end())时什么都不做 */
+        base_ptr split_at(const_iterator it);
+
+        /* 把temp整体接到pos之前, 返回第一个接入的元素 */
+        iterator splice_in(const_iterator pos, unrolled_list &temp);
+    };
+
+    /* *************************************实现**************************************** */
+
+    template <class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc>& unrolled_list<T, K, Alloc>::operator=(unrolled_list &&rhs) {
+        if (this != &rhs) {
+            clear();
+            if (node_alloc_traits::propagate_on_container_move_assignment::value ||
+                my_stl::alloc_equal(alloc_ref(), rhs.alloc_ref())) {
+                my_stl::alloc_on_move(alloc_ref(), rhs.alloc_ref());
+                take_nodes(sentinel_, rhs.sentinel_);
+                size_ = rhs.size_;
+                rhs.size_ = 0;
+            }
+            else {
+                /* 配置器不相等, 只能逐个移动元素 */
+                for (auto &x : rhs)
+                    emplace_back(my_stl::move(x));
+                rhs.clear();
+            }
+        }
+        return *this;
+    }
+
+    template <class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::size_type unrolled_list<T, K, Alloc>::node_count() const noexcept {
+        size_type n = 0;
+        for (auto p = sentinel_.next; p != sentinel(); p = p->next)
+            ++n;
+        return n;
+    }
+
+    // 头结点前部还有空槽位就放进去, 否则在前面新建一个结点, 元素放在最后一个槽位
+    template <class T, size_t K, class Alloc>
+    template <class ...Args>
+    void unrolled_list<T, K, Alloc>::emplace_front(Args &&...args) {
+        THROW_LENGTH_ERROR_IF(size_ > max_size() - 1, "unrolled_list<T>'s size too big");
+        auto node = sentinel_.next;
+        if (node != sentinel() && node->first != 0) {
+            node_alloc_traits::construct(alloc_ref(), data(node) + node->first - 1, my_stl::forward<Args>(args)...);
+            --node->first;
+        }
+        else {
+            node = create_node();
+            try {
+                node_alloc_traits::construct(alloc_ref(), data(node) + (K - 1), my_stl::forward<Args>(args)...);
+            } catch (...) {
+                destroy_node(node);
+                throw;
+            }
+            node->first = K - 1;
+            node->last = K;
+            link_nodes(sentinel_.next, node, node);
+        }
+        ++size_;
+    }
+
+    // 尾结点后部还有空槽位就放进去, 否则在后面新建一个结点
+    template <class T, size_t K, class Alloc>
+    template <class ...Args>
+    void unrolled_list<T, K, Alloc>::emplace_back(Args &&...args) {
+        THROW_LENGTH_ERROR_IF(size_ > max_size() - 1, "unrolled_list<T>'s size too big");
+        auto node = sentinel_.prev;
+        if (node != sentinel() && node->last != K) {
+            node_alloc_traits::construct(alloc_ref(), data(node) + node->last, my_stl::forward<Args>(args)...);
+            ++node->last;
+        }
+        else {
+            node = create_node();
+            try {
+                node_alloc_traits::construct(alloc_ref(), data(node), my_stl::forward<Args>(args)...);
+            } catch (...) {
+                destroy_node(node);
+                throw;
+            }
+            node->first = 0;
+            node->last = 1;
+            link_nodes(sentinel(), node, node);
+        }
+        ++size_;
+    }
+
+    // 在pos之前构造元素. 结点满了先对半分裂, 然后移动pos两侧较短的一段腾出槽位
+    template <class T, size_t K, class Alloc>
+    template <class ...Args>
+    typename unrolled_list<T, K, Alloc>::iterator
+    unrolled_list<T, K, Alloc>::emplace(const_iterator pos, Args &&...args) {
+        if (pos.node_ == sentinel()) {
+            emplace_back(my_stl::forward<Args>(args)...);
+            return iterator(sentinel_.prev, sentinel_.prev->last - 1);
+        }
+        if (pos.node_ == sentinel_.next && pos.slot_ == pos.node_->first) {
+            emplace_front(my_stl::forward<Args>(args)...);
+            return begin();
+        }
+        THROW_LENGTH_ERROR_IF(size_ > max_size() - 1, "unrolled_list<T>'s size too big");
+        /* 参数可能引用容器里的元素, 先构造好再搬动 */
+        value_type value(my_stl::forward<Args>(args)...);
+        auto node = pos.node_;
+        size_t s = pos.slot_;
+        if (node->count() == K) {
+            const size_t mid = node->first + K / 2;
+            auto right = split_at(const_iterator(node, mid));
+            if (s >= mid) {
+                node = right;
+                s -= mid;
+            }
+        }
+        T *d = data(node);
+        const bool shift_right = node->last != K && (node->first == 0 || node->last - s <= s - node->first);
+        if (shift_right) {
+            if (s == node->last) {
+                node_alloc_traits::construct(alloc_ref(), d + s, my_stl::move(value));
+            }
+            else {
+                node_alloc_traits::construct(alloc_ref(), d + node->last, my_stl::move(d[node->last - 1]));
+                my_stl::move_backward(d + s, d + node->last - 1, d + node->last);
+                d[s] = my_stl::move(value);
+            }
+            ++node->last;
+        }
+        else {
+            if (s == node->first) {
+                node_alloc_traits::construct(alloc_ref(), d + s - 1, my_stl::move(value));
+            }
+            else {
+                node_alloc_traits::construct(alloc_ref(), d + node->first - 1, my_stl::move(d[node->first]));
+                my_stl::move(d + node->first + 1, d + s, d + node->first);
+                d[s - 1] = my_stl::move(value);
+            }
+            --node->first;
+            --s;
+        }
+        ++size_;
+        return iterator(node, s);
+    }
+
+    // 删除pos处元素, 移动结点内较短的一侧补上空位
+    template <class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::iterator
+    unrolled_list<T, K, Alloc>::erase(const_iterator pos) {
+        MYSTL_DEBUG(pos != cend());
+        auto node = pos.node_;
+        const size_t s = pos.slot_;
+        --size_;
+        if (node->count() == 1) {
+            auto next = node->next;
+            node_alloc_traits::destroy(alloc_ref(), data(node) + s);
+            free_node(node);
+            return iterator(next, next->first);
+        }
+        T *d = data(node);
+        if (s - node->first < node->last - 1 - s) {
+            my_stl::move_backward(d + node->first, d + s, d + s + 1);
+            node_alloc_traits::destroy(alloc_ref(), d + node->first);
+            ++node->first;
+            return normalize(node, s + 1);
+        }
+        my_stl::move(d + s + 1, d + node->last, d + s);
+        --node->last;
+        node_alloc_traits::destroy(alloc_ref(), d + node->last);
+        return normalize(node, s);
+    }
+
+    // 删除[first, last): 中间的整结点直接释放, 两端的结点只析构相应的一段, 不分配内存
+    template <class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::iterator
+    unrolled_list<T, K, Alloc>::erase(const_iterator first, const_iterator last) {
+        if (first == last)
+            return make_iter(last);
+        auto fn = first.node_;
+        auto ln = last.node_;
+        const size_t a = first.slot_;
+        const size_t b = last.slot_;
+        if (fn == ln) {
+            T *d = data(fn);
+            const size_t n = b - a;
+            my_stl::move(d + b, d + fn->last, d + a);
+            node_alloc_traits::destroy(alloc_ref(), d + fn->last - n, d + fn->last);
+            fn->last -= static_cast<uint32_t>(n);
+            size_ -= n;
+            return normalize(fn, a);
+        }
+        node_alloc_traits::destroy(alloc_ref(), data(fn) + a, data(fn) + fn->last);
+        size_ -= fn->last - a;
+        fn->last = static_cast<uint32_t>(a);
+        auto p = fn->next;
+        if (fn->first == fn->last)
+            free_node(fn);
+        while (p != ln) {
+            auto next = p->next;
+            node_alloc_traits::destroy(alloc_ref(), data(p) + p->first, data(p) + p->last);
+            size_ -= p->count();
+            free_node(p);
+            p = next;
+        }
+        if (ln != sentinel()) {
+            node_alloc_traits::destroy(alloc_ref(), data(ln) + ln->first, data(ln) + b);
+            size_ -= b - ln->first;
+            ln->first = static_cast<uint32_t>(b);
+        }
+        return iterator(ln, ln->first);
+    }
+
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::clear() noexcept {
+        auto p = sentinel_.next;
+        while (p != sentinel()) {
+            auto next = p->next;
+            node_alloc_traits::destroy(alloc_ref(), data(p) + p->first, data(p) + p->last);
+            destroy_node(p);
+            p = next;
+        }
+        sentinel_.unlink();
+        size_ = 0;
+    }
+
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::resize(size_type new_size, const value_type &value) {
+        if (new_size >= size_) {
+            insert(end(), new_size - size_, value);
+            return;
+        }
+        /* 找到第new_size个元素所在的结点 */
+        auto p = sentinel_.next;
+        size_type before = 0;
+        while (before + p->count() <= new_size) {
+            before += p->count();
+            p = p->next;
+        }
+        erase(const_iterator(p, p->first + (new_size - before)), cend());
+    }
+
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::shrink_to_fit() {
+        if (node_count() <= (size_ + K - 1) / K)
+            return;
+        unrolled_list temp(get_allocator());
+        for (auto &x : *this)
+            temp.emplace_back(my_stl::move(x));
+        swap(temp);
+    }
+
+    // 把other整个接到pos之前
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::splice(const_iterator pos, unrolled_list &other) {
+        MYSTL_DEBUG(this != &other);
+        if (other.empty())
+            return;
+        THROW_LENGTH_ERROR_IF(size_ > max_size() - other.size_, "unrolled_list<T>'s size too big");
+        auto p = split_at(pos);
+        auto first = other.sentinel_.next;
+        auto last = other.sentinel_.prev;
+        other.sentinel_.unlink();
+        link_nodes(p, first, last);
+        size_ += other.size_;
+        other.size_ = 0;
+    }
+
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::splice(const_iterator pos, unrolled_list &other, const_iterator it) {
+        auto next = it;
+        ++next;
+        splice(pos, other, it, next);
+    }
+
+    // 把other的[first, last)接到pos之前, other可以就是自己(pos不能落在[first, last)中)
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::splice(const_iterator pos, unrolled_list &other,
+                                            const_iterator first, const_iterator last) {
+        if (first == last || pos == last)
+            return;
+        /* 先在pos处分裂; 同一个容器时first/last若在被分出去的后半段, 要跟着换到新结点 */
+        auto p = split_at(pos);
+        if (p != pos.node_) {
+            if (first.node_ == pos.node_ && first.slot_ >= pos.slot_)
+                first = const_iterator(p, first.slot_ - pos.slot_);
+            if (last.node_ == pos.node_ && last.slot_ >= pos.slot_)
+                last = const_iterator(p, last.slot_ - pos.slot_);
+        }
+        /* 先分last再分first, first所在的前半段结点不受影响 */
+        auto l = other.split_at(last);
+        auto f = other.split_at(first);
+        if (p == f || p == l)
+            return;
+        size_type n = 0;
+        if (this != &other) {
+            for (auto q = f; q != l; q = q->next)
+                n += q->count();
+            THROW_LENGTH_ERROR_IF(size_ > max_size() - n, "unrolled_list<T>'s size too big");
+        }
+        auto tail = l->prev;
+        unlink_nodes(f, tail);
+        link_nodes(p, f, tail);
+        size_ += n;
+        other.size_ -= n;
+    }
+
+    // 每个结点内部原地压紧, 空结点释放
+    template <class T, size_t K, class Alloc>
+    template <class Unary>
+    void unrolled_list<T, K, Alloc>::remove_if(Unary pred) {
+        for (auto p = sentinel_.next; p != sentinel(); ) {
+            auto next = p->next;
+            T *d = data(p);
+            size_t w = p->first;
+            for (size_t r = p->first; r != p->last; ++r) {
+                if (!pred(d[r])) {
+                    if (w != r)
+                        d[w] = my_stl::move(d[r]);
+                    ++w;
+                }
+            }
+            node_alloc_traits::destroy(alloc_ref(), d + w, d + p->last);
+            size_ -= p->last - w;
+            p->last = static_cast<uint32_t>(w);
+            if (p->first == p->last)
+                free_node(p);
+            p = next;
+        }
+    }
+
+    // 和上一个保留下来的元素比较, 保留的元素可能在前面的结点里
+    template <class T, size_t K, class Alloc>
+    template <class Binary>
+    void unrolled_list<T, K, Alloc>::unique(Binary pred) {
+        T *kept = nullptr;
+        for (auto p = sentinel_.next; p != sentinel(); ) {
+            auto next = p->next;
+            T *d = data(p);
+            size_t w = p->first;
+            for (size_t r = p->first; r != p->last; ++r) {
+                if (kept != nullptr && pred(*kept, d[r]))
+                    continue;
+                if (w != r)
+                    d[w] = my_stl::move(d[r]);
+                kept = d + w;
+                ++w;
+            }
+            node_alloc_traits::destroy(alloc_ref(), d + w, d + p->last);
+            size_ -= p->last - w;
+            p->last = static_cast<uint32_t>(w);
+            if (p->first == p->last)
+                free_node(p);
+            p = next;
+        }
+    }
+
+    // 按顺序把两边的元素移动到新的容器里, 结点都是满的
+    template <class T, size_t K, class Alloc>
+    template <class Compare>
+    void unrolled_list<T, K, Alloc>::merge(unrolled_list &x, Compare comp) {
+        if (this == &x || x.empty())
+            return;
+        THROW_LENGTH_ERROR_IF(size_ > max_size() - x.size_, "unrolled_list<T>'s size too big");
+        unrolled_list result(get_allocator());
+        auto f1 = begin();
+        auto l1 = end();
+        auto f2 = x.begin();
+        auto l2 = x.end();
+        while (f1 != l1 && f2 != l2) {
+            if (comp(*f2, *f1)) {
+                result.emplace_back(my_stl::move(*f2));
+                ++f2;
+            }
+            else {
+                result.emplace_back(my_stl::move(*f1));
+                ++f1;
+            }
+        }
+        for (; f1 != l1; ++f1)
+            result.emplace_back(my_stl::move(*f1));
+        for (; f2 != l2; ++f2)
+            result.emplace_back(my_stl::move(*f2));
+        x.clear();
+        swap(result);
+    }
+
+    // 元素移到连续的数组里stable_sort, 再按顺序移回原来的槽位, 结点结构不变
+    template <class T, size_t K, class Alloc>
+    template <class Compare>
+    void unrolled_list<T, K, Alloc>::sort(Compare comp) {
+        if (size_ < 2)
+            return;
+        my_stl::vector<T> buf;
+        buf.reverse(size_);
+        for (auto &x : *this)
+            buf.emplace_back(my_stl::move(x));
+        try {
+            my_stl::stable_sort(buf.begin(), buf.end(), comp);
+        } catch (...) {
+            my_stl::move(buf.begin(), buf.end(), begin());
+            throw;
+        }
+        my_stl::move(buf.begin(), buf.end(), begin());
+    }
+
+    // 结点的次序和每个结点内的元素都反过来
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::reverse() noexcept {
+        auto p = sentinel();
+        do {
+            if (p != sentinel()) {
+                T *d = data(p);
+                for (size_t i = p->first, j = p->last; i + 1 < j; ++i, --j)
+                    my_stl::swap(d[i], d[j - 1]);
+            }
+            my_stl::swap(p->prev, p->next);
+            p = p->prev;                /* 交换后prev是原来的next */
+        } while (p != sentinel());
+    }
+
+    template <class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::node_ptr unrolled_list<T, K, Alloc>::create_node() {
+        node_ptr p = node_alloc_traits::allocate(alloc_ref(), 1);
+        MYSTL_INSTRUMENT_ALLOC(unrolled_list, 0, sizeof(*p));
+        /* 结点头和槽位都是平凡类型, 不构造, 槽位里的元素由调用者构造 */
+        p->prev = p->next = nullptr;
+        p->first = p->last = 0;
+        return p;
+    }
+
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::destroy_node(base_ptr p) noexcept {
+        auto node = static_cast<node_ptr>(p);
+        MYSTL_INSTRUMENT_FREE(unrolled_list, sizeof(*node), sizeof(T) * p->count());
+        node_alloc_traits::deallocate(alloc_ref(), node, 1);
+    }
+
+    // 从链上摘下并释放一个已经没有元素的结点
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::free_node(base_ptr p) noexcept {
+        unlink_nodes(p, p);
+        destroy_node(p);
+    }
+
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::take_nodes(unrolled_node_base<T> &to, unrolled_node_base<T> &from) noexcept {
+        if (from.next == &from) {
+            to.unlink();
+            return;
+        }
+        to.next = from.next;
+        to.prev = from.prev;
+        to.first = to.last = 0;
+        to.next->prev = &to;
+        to.prev->next = &to;
+        from.unlink();
+    }
+
+    // pos之前连接[first, last]
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::link_nodes(base_ptr pos, base_ptr first, base_ptr last) noexcept {
+        pos->prev->next = first;
+        first->prev = pos->prev;
+        pos->prev = last;
+        last->next = pos;
+    }
+
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::unlink_nodes(base_ptr first, base_ptr last) noexcept {
+        first->prev->next = last->next;
+        last->next->prev = first->prev;
+    }
+
+    template <class T, size_t K, class Alloc>
+    template <class Iter>
+    void unrolled_list<T, K, Alloc>::copy_init(Iter first, Iter last) {
+        sentinel_.unlink();
+        size_ = 0;
+        try {
+            for (; first != last; ++first)
+                emplace_back(*first);
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::fill_init(size_type n, const value_type &value) {
+        sentinel_.unlink();
+        size_ = 0;
+        try {
+            for (; n > 0; --n)
+                emplace_back(value);
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    // [it, 结点末尾)移到新结点的开头, 新结点接在后面
+    template <class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::base_ptr unrolled_list<T, K, Alloc>::split_at(const_iterator it) {
+        auto node = it.node_;
+        const size_t s = it.slot_;
+        if (node == sentinel() || s == node->first)
+            return node;
+        auto right = create_node();
+        T *d = data(node);
+        try {
+            my_stl::uninitialized_move(d + s, d + node->last, right->data());
+        } catch (...) {
+            destroy_node(right);
+            throw;
+        }
+        node_alloc_traits::destroy(alloc_ref(), d + s, d + node->last);
+        right->first = 0;
+        right->last = static_cast<uint32_t>(node->last - s);
+        node->last = static_cast<uint32_t>(s);
+        link_nodes(node->next, right, right);
+        return right;
+    }
+
+    template <class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::iterator
+    unrolled_list<T, K, Alloc>::splice_in(const_iterator pos, unrolled_list &temp) {
+        if (temp.empty())
+            return make_iter(pos);
+        auto first = temp.sentinel_.next;
+        splice(pos, temp);
+        return iterator(first, first->first);
+    }
+
+    // 重载比较操作符
+    template <class T, size_t K, class Alloc>
+    bool operator==(const unrolled_list<T, K, Alloc> &lhs, const unrolled_list<T, K, Alloc> &rhs) {
+        if (lhs.size() != rhs.size())
+            return false;
+        auto f1 = lhs.cbegin();
+        auto f2 = rhs.cbegin();
+        auto l1 = lhs.cend();
+        for (; f1 != l1 && *f1 == *f2; ++f1, ++f2)
+            ;
+        return f1 == l1;
+    }
+
+    template <class T, size_t K, class Alloc>
+    bool operator<(const unrolled_list<T, K, Alloc> &lhs, const unrolled_list<T, K, Alloc> &rhs) {
+        return my_stl::s_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
+    }
+
+    template <class T, size_t K, class Alloc>
+    bool operator!=(const unrolled_list<T, K, Alloc> &lhs, const unrolled_list<T, K, Alloc> &rhs) {
+        return !(lhs == rhs);
+    }
+
+    template <class T, size_t K, class Alloc>
+    bool operator>(const unrolled_list<T, K, Alloc> &lhs, const unrolled_list<T, K, Alloc> &rhs) {
+        return rhs < lhs;
+    }
+
+    template <class T, size_t K, class Alloc>
+    bool operator<=(const unrolled_list<T, K, Alloc> &lhs, const unrolled_list<T, K, Alloc> &rhs) {
+        return !(rhs < lhs);
+    }
+
+    template <class T, size_t K, class Alloc>
+    bool operator>=(const unrolled_list<T, K, Alloc> &lhs, const unrolled_list<T, K, Alloc> &rhs) {
+        return !(lhs < rhs);
+    }
+
+    template <class T, size_t K, class Alloc>
+    void swap(unrolled_list<T, K, Alloc> &lhs, unrolled_list<T, K, Alloc> &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    template <class T, size_t K, class Alloc>
+    std::ostream& operator<<(std::ostream &os, const unrolled_list<T, K, Alloc> &l) {
+        for (auto it = l.begin(); it != l.end(); ++it)
+            os << *it << " ";
+        os << std::endl;
+        return os;
+    }
+}
+
+#endif //MY_STL_UNROLLED_LIST_H
@@ -216,7 +216,7 @@ namespace my_stl {
         ~pair() = default;
 
         void swap(pair &other) {
-            if (this != other) {
+            if (this != &other) {
                 my_stl::swap(first, other.first);
                 my_stl::swap(second, other.second);
             }
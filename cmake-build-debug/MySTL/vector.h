@@ -5,10 +5,13 @@
 #ifndef MY_STL_MY_VECTOR_H
 #define MY_STL_MY_VECTOR_H
 #include <initializer_list>
+#include <cstring>
 #include "iterator.h"
 #include "mymemory.h"
 #include "util.h"
 #include "exceptdef.h"
+#include "growth.h"
+#include "instrument.h"
 #include <iostream>
 
 
@@ -30,6 +33,26 @@
  *      void print(const char *ends = " ") 默认用空格结尾，可根据用户喜好更改参数
  *  添加了拓展输出运算符:
  *      ostream& <<(ostream &os, const my_stl::vector<T> &vec); 方便输出向量内容
+ *  可平凡重定位(is_trivially_relocatable)的元素:
+ *      扩容, 插入, 删除时直接memcpy/memmove整段内存, 不再逐个移动构造和析构.
+ *  配置器提供reallocate(如malloc_allocator)且元素可平凡重定位时:
+ *      扩容直接realloc/mremap原有空间, 能原地扩展就不搬运.
+ *  append_range / append_n / copy到back_inserter:
+ *      批量追加时先预留空间, 整批只做一次容量检查.
+ *  unchecked_emplace_back / push_back_unchecked / reserve_and_fill:
+ *      预留空间之后的快速路径, 不检查容量, 只在调试版本中断言.
+ *  resize_default_init / resize_uninitialized / append_uninitialized:
+ *      新增元素不做值初始化, I/O缓冲区可以直接让read()写进vector, 省掉一遍清零.
+ *  分配统计:
+ *      定义MYSTL_INSTRUMENT编译时, 每次申请/扩容/释放都记入instrument.h的统计表, 否则没有任何开销.
+ *      push_back/insert/assign/resize/reverse/append_*多一个默认参数记录调用者的文件和行号, 不要显式传入.
+ *  增长策略:
+ *      第三模板参数Growth决定扩容后的容量(见growth.h), 默认1.5倍且至少16个元素;
+ *      空vector不分配空间, 构造和reserve按请求大小精确分配.
+ *  空间配置器:
+ *      第二模板参数Alloc可以是有状态的(arena, 内存池...), vector保存一份配置器对象(空配置器不占空间),
+ *      所有内存的申请和释放都通过allocator_traits作用于该对象,
+ *      拷贝构造, 拷贝/移动赋值, swap时按propagate_on_container_*决定是否传播配置器.
  */
 
 /*
@@ -51,32 +74,35 @@ namespace my_stl {
 #endif // min
 
     /* vector类 */
-    template <class T>
-    class vector {
-        /* 暂时没有编写bool的vector, 因为标准库的vector<bool>做了特别的位优化 */
-        static_assert(!std::is_same<bool, T>::value, "vector<bool> not in my_stl\n");
+    template <class T, class Alloc = my_stl::allocator<T>, class Growth = my_stl::default_growth>
+    class vector : private my_stl::alloc_holder<Alloc> {
+        /* 不提供vector<bool>的位特化, 需要紧凑的标志位请使用bit_vector.h中的my_stl::bit_vector */
+        static_assert(!std::is_same<bool, T>::value, "vector<bool> not in my_stl, use my_stl::bit_vector (bit_vector.h)\n");
 
     public:
         /* 相关型别定义,vector的迭代器类型其实就是原生指针 */
-        typedef my_stl::allocator<T>                        allocator_type;
-        typedef my_stl::allocator<T>                        data_allocator;
+        typedef Alloc                                       allocator_type;
+        typedef my_stl::allocator_traits<Alloc>             alloc_traits;
 
-        typedef typename allocator_type::value_type         value_type;
-        typedef typename allocator_type::pointer            pointer;
-        typedef typename allocator_type::const_pointer      const_pointer;
-        typedef typename allocator_type::reference          reference;
-        typedef typename allocator_type::const_reference    const_reference;
-        typedef typename allocator_type::size_type          size_type;
-        typedef typename allocator_type::difference_type    difference_type;
+        typedef T                                           value_type;
+        typedef typename alloc_traits::pointer              pointer;
+        typedef typename alloc_traits::const_pointer        const_pointer;
+        typedef value_type&                                 reference;
+        typedef const value_type&                           const_reference;
+        typedef typename alloc_traits::size_type            size_type;
+        typedef typename alloc_traits::difference_type      difference_type;
 
         typedef value_type*                                 iterator;
         typedef const value_type*                           const_iterator;
         typedef my_stl::reverse_iterator<iterator>          reverse_iterator;
         typedef my_stl::reverse_iterator<const_iterator>    const_reverse_iterator;
 
-        allocator_type get_allocator() {return data_allocator();}
+        allocator_type get_allocator() const {return this->alloc_ref();}
 
     private:
+        typedef my_stl::alloc_holder<Alloc>                 holder;
+        using holder::alloc_ref;
+
         /* 使用空间头部, 使用空间尾部, 存储空间尾部*/
         iterator begin_;
         iterator end_;
@@ -84,41 +110,59 @@ namespace my_stl {
 
     public:
         /* 构造，复制，移动，析构 */
-        vector() noexcept {try_init();}
+        /* 空vector不分配空间, 第一次插入时才按增长策略分配 */
+        vector() noexcept : begin_(nullptr), end_(nullptr), cap_(nullptr) {}
+        explicit vector(const allocator_type &a) noexcept
+                : holder(a), begin_(nullptr), end_(nullptr), cap_(nullptr) {}
 
         /* 调用该类型的默认构造函数填充 */
-        explicit vector(size_type n) {fill_init(n, value_type());}
+        explicit vector(size_type n, const allocator_type &a = allocator_type())
+                : holder(a) {fill_init(n, value_type());}
 
         /* 指定值传入填充 */
-        vector(size_type n, const value_type &value) {fill_init(n, value);}
+        vector(size_type n, const value_type &value, const allocator_type &a = allocator_type())
+                : holder(a) {fill_init(n, value);}
 
         /* 范围构造 */
         template<class Iter, typename std::enable_if<
                 my_stl::is_input_iterator<Iter>::value, int>::type = 0>
-        vector(Iter first, Iter last) {
+        vector(Iter first, Iter last, const allocator_type &a = allocator_type()) : holder(a) {
             MYSTL_DEBUG(!(last < first));
             range_init(first, last);
         }
 
-        vector(const vector &rhs) {range_init(rhs.begin_, rhs.end_);}
+        /* 拷贝构造时配置器由select_on_container_copy_construction决定 */
+        vector(const vector &rhs)
+                : holder(alloc_traits::select_on_container_copy_construction(rhs.alloc_ref())) {
+            range_init(rhs.begin_, rhs.end_);
+        }
+
+        vector(const vector &rhs, const allocator_type &a) : holder(a) {range_init(rhs.begin_, rhs.end_);}
 
-        /* 移动构造只是指针赋值,然后清除原指针,并不用真正的move */
-        vector(vector &&rhs) noexcept : begin_(rhs.begin_), end_(rhs.end_), cap_(rhs.cap_) {
+        /* 移动构造只是指针赋值,然后清除原指针,并不用真正的move, 配置器跟着移动过来 */
+        vector(vector &&rhs) noexcept
+                : holder(my_stl::move(rhs.alloc_ref())), begin_(rhs.begin_), end_(rhs.end_), cap_(rhs.cap_) {
             rhs.begin_ = nullptr;
             rhs.end_ = nullptr;
             rhs.cap_ = nullptr;
         }
 
+        /* 指定配置器的移动构造, 配置器不相等时只能逐个移动元素 */
+        vector(vector &&rhs, const allocator_type &a);
+
         /* 初始化列表构造 */
-        vector(std::initializer_list<value_type> list) {
+        vector(std::initializer_list<value_type> list, const allocator_type &a = allocator_type())
+                : holder(a) {
             range_init(list.begin(), list.end());
         }
 
         /* 之后实现 */
         vector& operator=(const vector &rhs);
-        vector& operator=(vector &&rhs) noexcept;
+        vector& operator=(vector &&rhs)
+        noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                 alloc_traits::is_always_equal::value);
         vector& operator=(std::initializer_list<value_type> list) {
-            vector temp(list.begin(), list.end());
+            vector temp(list.begin(), list.end(), alloc_ref());
             swap(temp);                                     /* 这个swap是类内的专属函数 */
             return *this;
         }
@@ -151,11 +195,11 @@ namespace my_stl {
         /* 容量操作 */
         bool empty() const noexcept {return begin_ == end_;}
         size_type size() const noexcept {return static_cast<size_type>(end_ - begin_);}
-        size_type max_size() const noexcept {return static_cast<size_type>((-1) / sizeof(T));}
+        size_type max_size() const noexcept {return alloc_traits::max_size(alloc_ref());}
         size_type capacity() const noexcept {return static_cast<size_type>(cap_ - begin_);}
 
         /* 之后实现 */
-        void reverse(size_type n);
+        void reverse(size_type n MYSTL_INSTRUMENT_SITE_PARAM);
         void shrink_to_fit();
 
         /* 元素访问操作 */
@@ -207,12 +251,19 @@ namespace my_stl {
         /* assign */
         template<class Iter, typename std::enable_if<
                 my_stl::is_input_iterator<Iter>::value, int>::type = 0>
-        void assign(Iter first, Iter last) {
+        void assign(Iter first, Iter last MYSTL_INSTRUMENT_SITE_PARAM) {
+            MYSTL_INSTRUMENT_ENTER();
             MYSTL_DEBUG(!(last < first));
             copy_assign(first, last, iterator_category(first));
         }
-        void assign(size_type n, const value_type &value) {fill_assign(n, value);}
-        void assign(std::initializer_list<value_type> list) {copy_assign(list.begin(), list.end(), my_stl::forward_iterator_tag{});}
+        void assign(size_type n, const value_type &value MYSTL_INSTRUMENT_SITE_PARAM) {
+            MYSTL_INSTRUMENT_ENTER();
+            fill_assign(n, value);
+        }
+        void assign(std::initializer_list<value_type> list MYSTL_INSTRUMENT_SITE_PARAM) {
+            MYSTL_INSTRUMENT_ENTER();
+            copy_assign(list.begin(), list.end(), my_stl::forward_iterator_tag{});
+        }
 
         /* emplace 和 emplace_back , 后面实现*/
         template<class ...Args>
@@ -222,24 +273,70 @@ namespace my_stl {
         void emplace_back(Args &&... args);
 
         /* push_back 和 pop_back, 后面实现*/
-        void push_back(const value_type &value);
-        void push_back(value_type &&value) {emplace_back(my_stl::move(value));}
+        void push_back(const value_type &value MYSTL_INSTRUMENT_SITE_PARAM);
+        void push_back(value_type &&value MYSTL_INSTRUMENT_SITE_PARAM) {
+            MYSTL_INSTRUMENT_ENTER();
+            emplace_back(my_stl::move(value));
+        }
         void pop_back();
 
+        /* 不检查容量的尾部插入, 调用者保证已经reverse过足够的空间(调试版本断言)
+         * 没有扩容分支和对reallocate_emplace的调用, 适合预留空间后的紧凑循环 */
+        template<class ...Args>
+        void unchecked_emplace_back(Args &&... args) {
+            MYSTL_DEBUG(end_ < cap_);
+            alloc_traits::construct(alloc_ref(), end_, my_stl::forward<Args>(args)...);
+            ++end_;
+        }
+        void push_back_unchecked(const value_type &value) {unchecked_emplace_back(value);}
+        void push_back_unchecked(value_type &&value) {unchecked_emplace_back(my_stl::move(value));}
+
+        /* 预留至少n个空位, 把尾部的原始指针交给fill, fill写入元素后返回写到的位置(不超过n个),
+         * 返回实际追加的个数. 写入循环里只有裸指针, 编译器可以向量化. 只用于平凡类型 */
+        template <class Fill>
+        size_type reserve_and_fill(size_type n, Fill fill MYSTL_INSTRUMENT_SITE_PARAM) {
+            static_assert(std::is_trivial<T>::value, "reserve_and_fill requires a trivial type\n");
+            MYSTL_INSTRUMENT_ENTER();
+            reserve_for_append(n);
+            pointer last = fill(end_);
+            MYSTL_DEBUG(end_ <= last && last <= end_ + n);
+            const auto added = static_cast<size_type>(last - end_);
+            end_ = last;
+            return added;
+        }
+
+        /* 尾部批量追加, 前向迭代器先算出长度只检查/扩容一次, 再整段拷贝构造(平凡类型memmove)
+         * [first, last)不能指向本vector */
+        template <class Iter, typename std::enable_if<
+                my_stl::is_input_iterator<Iter>::value, int>::type = 0>
+        void append_range(Iter first, Iter last MYSTL_INSTRUMENT_SITE_PARAM) {
+            MYSTL_INSTRUMENT_ENTER();
+            append_range(first, last, iterator_category(first));
+        }
+
+        /* 尾部追加n个由gen()生成的元素, 只扩容一次 */
+        template <class Generator>
+        void append_n(size_type n, Generator gen MYSTL_INSTRUMENT_SITE_PARAM);
+
         /* 打印 */
         void print(const char *ends = " ");
 
         /* insert 后面实现*/
         template <class Iter, typename std::enable_if<
                 my_stl::is_input_iterator<Iter>::value, int>::type = 0>
-        void     insert(const_iterator pos, Iter first, Iter last) {
+        void     insert(const_iterator pos, Iter first, Iter last MYSTL_INSTRUMENT_SITE_PARAM) {
+            MYSTL_INSTRUMENT_ENTER();
             MYSTL_DEBUG(pos >= begin() && pos <= end() && !(last < first));
             copy_insert(const_cast<iterator>(pos), first, last);
         }
 
-        iterator insert(const_iterator pos, const value_type &value);
-        iterator insert(const_iterator pos, value_type &&value) {return emplace(pos, my_stl::move(value));}
-        iterator insert(const_iterator pos, size_type n, const value_type &value) {
+        iterator insert(const_iterator pos, const value_type &value MYSTL_INSTRUMENT_SITE_PARAM);
+        iterator insert(const_iterator pos, value_type &&value MYSTL_INSTRUMENT_SITE_PARAM) {
+            MYSTL_INSTRUMENT_ENTER();
+            return emplace(pos, my_stl::move(value));
+        }
+        iterator insert(const_iterator pos, size_type n, const value_type &value MYSTL_INSTRUMENT_SITE_PARAM) {
+            MYSTL_INSTRUMENT_ENTER();
             MYSTL_DEBUG(pos >= begin() && pos <= end());
             return fill_insert(const_cast<iterator>(pos), n, value);
         }
@@ -250,8 +347,31 @@ namespace my_stl {
         void clear() {erase(begin(), end());}
 
         /* resize 和 reverse*/
-        void resize(size_type new_size) {resize(new_size, size_type());}
-        void resize(size_type new_size, const value_type &value);
+        void resize(size_type new_size MYSTL_INSTRUMENT_SITE_PARAM) {
+            MYSTL_INSTRUMENT_ENTER();
+            resize(new_size, value_type());
+        }
+        void resize(size_type new_size, const value_type &value MYSTL_INSTRUMENT_SITE_PARAM);
+
+        /* 新增的元素只做默认初始化: 平凡类型不清零, 留给read()/memcpy之类直接写入 */
+        void resize_default_init(size_type new_size MYSTL_INSTRUMENT_SITE_PARAM);
+
+        /* 只用于平凡类型, 新增的元素不做任何初始化, 使用前必须写入 */
+        void resize_uninitialized(size_type new_size MYSTL_INSTRUMENT_SITE_PARAM) {
+            static_assert(std::is_trivial<T>::value, "resize_uninitialized requires a trivial type\n");
+            MYSTL_INSTRUMENT_ENTER();
+            resize_default_init(new_size);
+        }
+
+        /* 尾部追加n个未初始化的元素, 返回第一个新元素的位置, [p, p + n)可以直接写入 */
+        pointer append_uninitialized(size_type n MYSTL_INSTRUMENT_SITE_PARAM) {
+            static_assert(std::is_trivial<T>::value, "append_uninitialized requires a trivial type\n");
+            MYSTL_INSTRUMENT_ENTER();
+            reserve_for_append(n);
+            auto p = end_;
+            end_ += n;
+            return p;
+        }
         void reverse() { /* 独立实现的reverse，没有用算法库里面的reverse, 可能存在bug */
             auto p = begin();
             int left = 0, right = size() - 1;
@@ -268,15 +388,24 @@ namespace my_stl {
     private:
         /* 辅助函数 */
         /* 初始化和析构*/
-        void try_init() noexcept;
         void init_space(size_type size, size_type cap);
         void fill_init(size_type n, const value_type &value);
         template<class Iter> void range_init(Iter first, Iter last);
         void destroy_and_recover(iterator first, iterator last, size_type n);
 
+        /* 移动赋值的两种情况: 可以接管rhs的空间 / 只能逐个移动元素 */
+        void move_assign(vector &rhs, m_true_type) noexcept;
+        void move_assign(vector &rhs, m_false_type);
+
         /* 计算扩展空间 */
         size_type get_new_cap(size_type add_size);
 
+        /* 保证尾部至少还能放下n个元素, 不够时按增长策略扩容一次 */
+        void reserve_for_append(size_type n) {
+            if (static_cast<size_type>(cap_ - end_) < n)
+                reverse(get_new_cap(n));
+        }
+
         /* 赋值 */
         void fill_assign(size_type n, const value_type &value);
         template<class Iter> void copy_assign(Iter first, Iter last, my_stl::input_iterator_tag);
@@ -287,6 +416,40 @@ namespace my_stl {
         void reallocate_emplace(iterator pos, Args &&...args);
         void reallocate_insert(iterator pos, const value_type &value);
 
+        /* 把元素搬到新空间, pos之后空出gap个位置, 然后释放旧空间 */
+        void relocate_to(iterator pos, iterator new_begin, size_type gap);
+        void relocate_to(iterator pos, iterator new_begin, size_type gap, m_true_type);
+        void relocate_to(iterator pos, iterator new_begin, size_type gap, m_false_type);
+
+        /* 元素是否可以按字节搬运 */
+        static constexpr bool relocatable() {return is_trivially_relocatable<T>::value;}
+
+        /* 能否直接用配置器的reallocate(realloc/mremap)扩容, 避免分配新空间再整段复制 */
+        static constexpr bool can_reallocate() {
+            return relocatable() && alloc_traits::has_reallocate::value;
+        }
+        void resize_buffer(size_type new_cap) {
+            resize_buffer(new_cap, m_bool_constant<can_reallocate()>());
+        }
+        void resize_buffer(size_type new_cap, m_true_type);
+        void resize_buffer(size_type, m_false_type) {}
+
+        /* 把[pos, end)整体后移n个位置/前移回来, 只用于可平凡重定位的元素 */
+        void shift_right(iterator pos, size_type n) {
+            std::memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos),
+                         static_cast<size_t>(end_ - pos) * sizeof(T));
+        }
+        void shift_left(iterator pos, size_type n) {
+            std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + n),
+                         static_cast<size_t>(end_ - pos) * sizeof(T));
+        }
+
+        /* 尾部批量追加 */
+        template<class Iter>
+        void append_range(Iter first, Iter last, my_stl::input_iterator_tag);
+        template<class Iter>
+        void append_range(Iter first, Iter last, my_stl::forward_iterator_tag);
+
         /* 插入 */
         template<class Iter>
         void copy_insert(iterator pos, Iter first, Iter last);
@@ -300,64 +463,96 @@ namespace my_stl {
      * 一些运算符重载的具体实现
      **************************************************************************************/
      /* 赋值运算符 */
-     template <class T>
-     vector<T>& vector<T>::operator=(const vector &rhs) {
+     template <class T, class Alloc, class Growth>
+     vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(const vector &rhs) {
          if (this == &rhs)
              return *this;
+         /* 要传播的配置器和当前的不相等, 旧空间只能由旧配置器释放 */
+         if (alloc_traits::propagate_on_container_copy_assignment::value &&
+             !my_stl::alloc_equal(alloc_ref(), rhs.alloc_ref())) {
+             destroy_and_recover(begin_, end_, cap_ - begin_);
+             begin_ = end_ = cap_ = nullptr;
+         }
+         my_stl::alloc_on_copy(alloc_ref(), rhs.alloc_ref());
          const auto len = rhs.size();
          /* 当赋值的大小大于当前容量，重新申请一个vector */
          if (len > capacity()) {
-             vector tmp(rhs.begin(), rhs.end());
+             vector tmp(rhs.begin(), rhs.end(), alloc_ref());
              swap(tmp);
          }
          /* 当前大小大于赋值的长度，复制然后删去多余的元素，再更新迭代器 */
          else if (size() >= len) {
              auto i = my_stl::copy(rhs.begin(), rhs.end(), begin());
-             data_allocator::destroy(i, end_);
+             alloc_traits::destroy(alloc_ref(), i, end_);
              end_ = begin() + len;
          }
          /* 当赋值的大小大于当前大小但小于当前容量,先赋值已经构造的，再初始化赋值后半段 */
          else {
              my_stl::copy(rhs.begin(), rhs.begin() + size(), begin_);
              my_stl::uninitialized_copy(rhs.begin() + size(), rhs.end(), end_);
-             cap_ = end_ = begin_ + len;
+             end_ = begin_ + len;
          }
          return *this;
      }
 
      /* 移动赋值运算符 */
-     template <class T>
-     vector<T>& vector<T>::operator=(vector &&rhs) noexcept {
+     template <class T, class Alloc, class Growth>
+     vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(vector &&rhs)
+     noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+              alloc_traits::is_always_equal::value) {
+         if (this != &rhs)
+             move_assign(rhs, m_bool_constant<alloc_traits::propagate_on_container_move_assignment::value ||
+                                              alloc_traits::is_always_equal::value>());
+         return *this;
+     }
+
+     /* 接管rhs的空间, 需要的话连配置器一起移动过来 */
+     template <class T, class Alloc, class Growth>
+     void vector<T, Alloc, Growth>::move_assign(vector &rhs, m_true_type) noexcept {
          destroy_and_recover(begin_, end_, cap_ - begin_);
+         my_stl::alloc_on_move(alloc_ref(), rhs.alloc_ref());
          begin_ = rhs.begin_;
          end_= rhs.end_;
          cap_ = rhs.cap_;
          rhs.begin_ = nullptr;
          rhs.end_ = nullptr;
          rhs.cap_ = nullptr;
-         return *this;
      }
 
-     /* 若分配失败忽略，不抛出异常 */
-     template <class T>
-     void vector<T>::try_init() noexcept {
-         try {
-             begin_ = data_allocator::allocate(16);
-             end_ = begin_;
-             cap_ = begin_ + 16;
-         } catch (...) {
-             begin_ = nullptr;
-             end_ = nullptr;
-             cap_ = nullptr;
+     /* 配置器不传播, 不相等时rhs的空间不能由本配置器释放, 只能逐个移动元素 */
+     template <class T, class Alloc, class Growth>
+     void vector<T, Alloc, Growth>::move_assign(vector &rhs, m_false_type) {
+         if (alloc_ref() == rhs.alloc_ref()) {
+             move_assign(rhs, m_true_type());
+             return;
+         }
+         clear();
+         reverse(rhs.size());
+         end_ = my_stl::uninitialized_move(rhs.begin_, rhs.end_, begin_);
+         rhs.clear();
+     }
+
+     template <class T, class Alloc, class Growth>
+     vector<T, Alloc, Growth>::vector(vector &&rhs, const allocator_type &a) : holder(a) {
+         if (alloc_ref() == rhs.alloc_ref()) {
+             begin_ = rhs.begin_;
+             end_ = rhs.end_;
+             cap_ = rhs.cap_;
+             rhs.begin_ = rhs.end_ = rhs.cap_ = nullptr;
+         }
+         else {
+             init_space(0, rhs.size());
+             end_ = my_stl::uninitialized_move(rhs.begin_, rhs.end_, begin_);
          }
      }
 
      /* 指定大小和存储空间,便于之后的空间扩展调用 */
-     template <class T>
-     void vector<T>::init_space(size_type size, size_type cap) {
+     template <class T, class Alloc, class Growth>
+     void vector<T, Alloc, Growth>::init_space(size_type size, size_type cap) {
          try {
              /* 分配内存 */
-             begin_ = data_allocator::allocate(cap);
+             begin_ = alloc_traits::allocate(alloc_ref(), cap);
+             MYSTL_INSTRUMENT_ALLOC(vector, 0, cap * sizeof(T));
              end_ = begin_ + size;
              cap_ = begin_ + cap;
          } catch (...) {
@@ -369,38 +564,51 @@ namespace my_stl {
      }
 
      /* fill_init */
-     template <class T>
-     void vector<T>::fill_init(size_type n, const value_type &value) {
-         const size_type init_size = my_stl::max(static_cast<size_type>(16), n);
-         init_space(n, init_size);
+     template <class T, class Alloc, class Growth>
+     void vector<T, Alloc, Growth>::fill_init(size_type n, const value_type &value) {
+         init_space(n, n);
          my_stl::uninitialized_fill_n(begin_, n, value);
      }
 
      /* range_init */
-     template <class T>
+     template <class T, class Alloc, class Growth>
      template <class Iter>
-     void vector<T>::range_init(Iter first, Iter last) {
-         const size_type init_size = my_stl::max(static_cast<size_type>(last - first), static_cast<size_type>(16));
-         init_space(static_cast<size_type>(last - first), init_size);
+     void vector<T, Alloc, Growth>::range_init(Iter first, Iter last) {
+         const size_type n = static_cast<size_type>(my_stl::distance(first, last));
+         init_space(n, n);
          my_stl::uninitialized_copy(first, last, begin_);
      }
 
      /* 析构，回收内存空间函数 */
-     template <class T>
-     void vector<T>::destroy_and_recover(iterator first, iterator last, size_type n) {
-         data_allocator::destroy(first, last);
-         data_allocator::deallocate(first, n);
+     template <class T, class Alloc, class Growth>
+     void vector<T, Alloc, Growth>::destroy_and_recover(iterator first, iterator last, size_type n) {
+         MYSTL_INSTRUMENT_FREE(vector, n * sizeof(T), static_cast<size_type>(last - first) * sizeof(T));
+         alloc_traits::destroy(alloc_ref(), first, last);
+         alloc_traits::deallocate(alloc_ref(), first, n);
      }
 
      /* 改变存储空间大小，当大于当前存储空间大小才会分配. 移动，更新迭代器*/
-     template <class T>
-     void vector<T>::reverse(size_type n) {
+     template <class T, class Alloc, class Growth>
+     void vector<T, Alloc, Growth>::reverse(size_type n MYSTL_INSTRUMENT_SITE_ARG) {
+         MYSTL_INSTRUMENT_ENTER();
          if (capacity() < n) {
              THROW_LENGTH_ERROR_IF(n > max_size(),
                                    "can not larger than max_size() in vector<T>::reverse(n)");
+             if (can_reallocate()) {
+                 MYSTL_INSTRUMENT_ALLOC(vector, capacity() * sizeof(T), n * sizeof(T));
+                 resize_buffer(n);
+                 return;
+             }
              const auto old_size = size();
-             auto temp = data_allocator::allocate(n);
-             my_stl::uninitialized_move(begin_, end_, temp);
+             auto temp = alloc_traits::allocate(alloc_ref(), n);
+             MYSTL_INSTRUMENT_ALLOC(vector, capacity() * sizeof(T), n * sizeof(T));
+             try {
+                 relocate_to(end_, temp, 0);
+             } catch (...) {
+                 MYSTL_INSTRUMENT_FREE(vector, n * sizeof(T), n * sizeof(T));
+                 alloc_traits::deallocate(alloc_ref(), temp, n);
+                 throw;
+             }
              begin_ = temp;
              end_ = temp + old_size;
              cap_ = begin_ + n;
@@ -408,30 +616,41 @@ namespace my_stl {
      }
 
      /* 放弃多余的容量 */
-     template <class T>
-     void vector<T>::shrink_to_fit() {
+     template <class T, class Alloc, class Growth>
+     void vector<T, Alloc, Growth>::shrink_to_fit() {
          if (end_ < cap_)
              reinsert(size());
      }
 
      /* 在pos位置原地构造元素，减少复制或者移动开销,这个函数有点迷惑 */
-     template <class T>
+     template <class T, class Alloc, class Growth>
      template <class ...Args>
-     typename vector<T>::iterator vector<T>::emplace(const_iterator pos, Args &&...args) {
+     typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::emplace(const_iterator pos, Args &&...args) {
          MYSTL_DEBUG(pos >= begin() && pos <= end());
          iterator x_pos = const_cast<iterator> (pos);
          const size_type n = x_pos - begin_;
          if (end_ != cap_ && x_pos == end_) {
-             data_allocator::construct(my_stl::address_of(*end_), my_stl::forward<Args>(args)...);
+             alloc_traits::construct(alloc_ref(), my_stl::address_of(*end_), my_stl::forward<Args>(args)...);
              ++end_;
          }
          else if (end_ != cap_) {
-             auto new_end = end_;
-             data_allocator::construct(my_stl::address_of(*end_), *(end_ - 1));
-             ++new_end;
-             my_stl::copy_backward(x_pos, end_ - 1, end_);
-             *x_pos = value_type(my_stl::forward<Args>(args)...);
-             //end_ = new_end;                                            //可能存在bug
+             /* 先构造出新元素, 防止args引用的正是要后移的元素 */
+             value_type value(my_stl::forward<Args>(args)...);
+             if (relocatable()) {
+                 shift_right(x_pos, 1);
+                 try {
+                     alloc_traits::construct(alloc_ref(), x_pos, my_stl::move(value));
+                 } catch (...) {
+                     shift_left(x_pos, 1);
+                     throw;
+                 }
+             }
+             else {
+                 alloc_traits::construct(alloc_ref(), my_stl::address_of(*end_), my_stl::move(*(end_ - 1)));
+                 my_stl::move_backward(x_pos, end_ - 1, end_);
+                 *x_pos = my_stl::move(value);
+             }
+             ++end_;
          }
          else {
              reallocate_emplace(x_pos, my_stl::forward<Args>(args)...);
@@ -440,11 +659,11 @@ namespace my_stl {
      }
 
      /* 尾部就地构造元素 */
-     template <class T>
+     template <class T, class Alloc, class Growth>
      template <class ...Args>
-     void vector<T>::emplace_back(Args &&...args) {
+     void vector<T, Alloc, Growth>::emplace_back(Args &&...args) {
          if (end_ < cap_) {
-             data_allocator::construct(my_stl::address_of(*end_), my_stl::forward<Args>(args)...);
+             alloc_traits::construct(alloc_ref(), my_stl::address_of(*end_), my_stl::forward<Args>(args)...);
              ++end_;
          }
          else {
@@ -453,10 +672,11 @@ namespace my_stl {
      }
 
      /* 尾部插入元素 */
-     template <class T>
-     void vector<T>::push_back(const value_type &value) {
+     template <class T, class Alloc, class Growth>
+     void vector<T, Alloc, Growth>::push_back(const value_type &value MYSTL_INSTRUMENT_SITE_ARG) {
+         MYSTL_INSTRUMENT_ENTER();
          if (end_ != cap_) {
-             data_allocator::construct(my_stl::address_of(*end_), value);
+             alloc_traits::construct(alloc_ref(), my_stl::address_of(*end_), value);
              ++end_;
          }
          else {
@@ -465,103 +685,128 @@ namespace my_stl {
      }
 
      /* 弹出尾部元素, 可能存在bug*/
-     template <class T>
-     void vector<T>::pop_back() {
+     template <class T, class Alloc, class Growth>
+     void vector<T, Alloc, Growth>::pop_back() {
          MYSTL_DEBUG(!empty());
-         data_allocator::destroy(end_ - 1);
+         alloc_traits::destroy(alloc_ref(), end_ - 1);
          --end_;
      }
 
     /* 在pos处插入元素 */
-    template <class T>
-    typename vector<T>::iterator vector<T>::insert(const_iterator pos, const value_type &value) {
-        MYSTL_DEBUG(pos >= begin() && pos <= end());
-        iterator x_pos = const_cast<iterator>(pos);
-        const size_type n = pos - begin_;
-        if (end_ != cap_ && x_pos == end_) {
-            data_allocator::construct(my_stl::address_of(*end_), value);
-            end_++;
-        }
-        else if (end_ != cap_) {
-            auto new_end = end_;
-            data_allocator::construct(my_stl::address_of(*end_), *(end_ - 1));
-            ++new_end;
-            auto value_copy = value;                        //避免元素因复制操作而被改变
-            my_stl::copy_backward(x_pos, end_ - 1, end_);   //想象移动图
-            *x_pos = my_stl::move(value_copy);
-            end_ = new_end;
-        }
-        else {
-            reallocate_insert(x_pos, value);
-        }
-        return begin_ + n;
+    template <class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(const_iterator pos, const value_type &value MYSTL_INSTRUMENT_SITE_ARG) {
+        MYSTL_INSTRUMENT_ENTER();
+        /* emplace会先复制一份value, 避免元素因移动而被改变 */
+        return emplace(pos, value);
     }
 
     /* 删除pos位置上的元素 */
-    template <class T>
-    typename vector<T>::iterator vector<T>::erase(const_iterator pos) {
+    template <class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase(const_iterator pos) {
         MYSTL_DEBUG(pos >= begin() && pos < end());
         iterator x_pos = begin_ + (pos - begin());
-        my_stl::move(x_pos + 1, end_, x_pos);               //想象移动图
-        data_allocator::destroy(end_ - 1);
-        --end_;
+        if (relocatable()) {
+            /* 析构被删元素, 后面的整段前移 */
+            alloc_traits::destroy(alloc_ref(), x_pos);
+            --end_;
+            shift_left(x_pos, 1);
+        }
+        else {
+            my_stl::move(x_pos + 1, end_, x_pos);               //想象移动图
+            alloc_traits::destroy(alloc_ref(), end_ - 1);
+            --end_;
+        }
         return x_pos;
     }
 
     /* 删除[first, last)上的元素*/
-    template <class T>
-    typename vector<T>::iterator
-    vector<T>::erase(const_iterator first, const_iterator last) {
+    template <class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator
+    vector<T, Alloc, Growth>::erase(const_iterator first, const_iterator last) {
         MYSTL_DEBUG(first >= begin() && last <= end() && !(last < first));
         const auto n = first - begin();
         iterator r = begin_ + (first - begin());
-        /* 把后面那一段移动到前面来, 再析构后面那一段 */
-        data_allocator::destroy(my_stl::move(r + (last - first), end_, r), end_);
-        end_ = end_ - (last - first);
+        const size_type len = last - first;
+        if (len == 0)
+            return r;
+        if (relocatable()) {
+            /* 析构被删的一段, 后面的整段前移 */
+            alloc_traits::destroy(alloc_ref(), r, r + len);
+            end_ -= len;
+            shift_left(r, len);
+        }
+        else {
+            /* 把后面那一段移动到前面来, 再析构后面那一段 */
+            alloc_traits::destroy(alloc_ref(), my_stl::move(r + len, end_, r), end_);
+            end_ -= len;
+        }
         return begin_ + n;
     }
 
     /* 重置容器大小 */
-    template <class T>
-    void vector<T>::resize(size_type new_size, const value_type &value) {
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::resize(size_type new_size, const value_type &value MYSTL_INSTRUMENT_SITE_ARG) {
+        MYSTL_INSTRUMENT_ENTER();
         if (new_size < size())
             erase(begin() + new_size, end());
         else
             insert(end(), new_size - size(), value);
     }
 
+    /* 默认初始化方式重置大小, 平凡类型只移动end_ */
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::resize_default_init(size_type new_size MYSTL_INSTRUMENT_SITE_ARG) {
+        MYSTL_INSTRUMENT_ENTER();
+        if (new_size <= size()) {
+            erase(begin() + new_size, end());
+            return;
+        }
+        const size_type n = new_size - size();
+        reserve_for_append(n);
+        if (std::is_trivially_default_constructible<T>::value) {
+            end_ += n;
+            return;
+        }
+        auto cur = end_;
+        try {
+            for (; cur != end_ + n; ++cur)
+                my_stl::construct_default(cur);
+        } catch (...) {
+            alloc_traits::destroy(alloc_ref(), end_, cur);
+            throw;
+        }
+        end_ = cur;
+    }
+
     /* 得到新存储空间函数 */
-    template <class T>
-    typename vector<T>::size_type
-    vector<T>::get_new_cap(size_type add_size) {
-        /* 经验增加算法 */
-        const auto old_size = capacity();
+    template <class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::size_type
+    vector<T, Alloc, Growth>::get_new_cap(size_type add_size) {
+        /* 由增长策略决定, 结果至少能放下size() + add_size个元素 */
+        const auto old_size = size();
         THROW_LENGTH_ERROR_IF(old_size > max_size() - add_size, "vector<T>'s size too big..\n");
-        if (old_size > max_size() - old_size / 2) {
-            return old_size + add_size > max_size() - 16 ?
-            old_size + add_size : old_size + add_size + 16;
-        }
-        const size_type new_size = old_size == 0 ?
-                my_stl::max(add_size, static_cast<size_type>(16)) :
-                my_stl::max(old_size + old_size / 2, old_size + add_size);
-        return new_size;
+        return Growth::new_cap(capacity(), old_size + add_size, max_size());
     }
 
     /* 与另一个vector交换,只需交换指针 */
-    template <class T>
-    void vector<T>::swap(vector<T> &rhs) noexcept {
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::swap(vector<T, Alloc, Growth> &rhs) noexcept {
         if (this != &rhs) {
+            /* 配置器不传播时两者必须相等, 否则行为未定义 */
+            MYSTL_DEBUG(alloc_traits::propagate_on_container_swap::value ||
+                        my_stl::alloc_equal(alloc_ref(), rhs.alloc_ref()));
+            my_stl::alloc_on_swap(alloc_ref(), rhs.alloc_ref());
             my_stl::swap(begin_, rhs.begin_);
             my_stl::swap(end_, rhs.end_);
             my_stl::swap(cap_, rhs.cap_);
         }
     }
 
-    template <class T>
-    void vector<T>::fill_assign(size_type n, const value_type &value) {
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::fill_assign(size_type n, const value_type &value) {
         if (n > capacity()) {
             /* 直接申请新的 */
-            vector temp(n, value);
+            vector temp(n, value, alloc_ref());
             swap(temp);
         }
         else if (n > size()) {
@@ -575,9 +820,9 @@ namespace my_stl {
         }
     }
 
-    template <class T>
+    template <class T, class Alloc, class Growth>
     template <class Iter>
-    void vector<T>::copy_assign(Iter first, Iter last, my_stl::input_iterator_tag) {
+    void vector<T, Alloc, Growth>::copy_assign(Iter first, Iter last, my_stl::input_iterator_tag) {
         auto cur = begin_;
         while (first != last && cur != end_) {
             *cur = *first;
@@ -593,19 +838,19 @@ namespace my_stl {
     }
 
     /* 用[first, last)给容器赋值 */
-    template <class T>
+    template <class T, class Alloc, class Growth>
     template <class Iter>
-    void vector<T>::copy_assign(Iter first, Iter last, my_stl::forward_iterator_tag) {
+    void vector<T, Alloc, Growth>::copy_assign(Iter first, Iter last, my_stl::forward_iterator_tag) {
         const size_type len = my_stl::distance(first ,last);
         if (len > capacity()) {
-            vector temp(first, last);
+            vector temp(first, last, alloc_ref());
             swap(temp);
         }
         else if (size() >= len) {
             /* 拷贝目标的范围元素 */
             auto new_end = my_stl::copy(first, last, begin_);
             /* 龙卷风摧毁原来多余的 */
-            data_allocator::destroy(new_end, end_);
+            alloc_traits::destroy(alloc_ref(), new_end, end_);
             end_ = new_end;
         }
         else {
@@ -620,166 +865,289 @@ namespace my_stl {
     }
 
     /* 重新分配空间且在pos处就地构造元素 */
-    template <class T>
+    template <class T, class Alloc, class Growth>
     template <class ...Args>
-    void vector<T>::reallocate_emplace(iterator pos, Args &&...args) {
+    void vector<T, Alloc, Growth>::reallocate_emplace(iterator pos, Args &&...args) {
         /* 上面已经实现的经验空间分配算法计算新的大小 */
         const auto new_size = get_new_cap(1);
-        auto new_begin = data_allocator::allocate(new_size);
-        auto new_end = new_begin;
+        const size_type before = pos - begin_;
+        if (can_reallocate()) {
+            /* 先构造出新元素, 扩容之后args可能已经失效 */
+            value_type value(my_stl::forward<Args>(args)...);
+            MYSTL_INSTRUMENT_ALLOC(vector, capacity() * sizeof(T), new_size * sizeof(T));
+            resize_buffer(new_size);
+            pos = begin_ + before;
+            shift_right(pos, 1);
+            try {
+                alloc_traits::construct(alloc_ref(), pos, my_stl::move(value));
+            } catch (...) {
+                shift_left(pos, 1);
+                throw;
+            }
+            ++end_;
+            return;
+        }
+        auto new_begin = alloc_traits::allocate(alloc_ref(), new_size);
+        MYSTL_INSTRUMENT_ALLOC(vector, capacity() * sizeof(T), new_size * sizeof(T));
+        /* 先在新空间构造新元素, args可能引用旧空间里的元素 */
         try {
-            /* 移动前半段 */
-            new_end = my_stl::uninitialized_move(begin_, pos, new_begin);
-            /* placement new 指定pos进行原地构造 */
-            data_allocator::construct(my_stl::address_of(*new_end), my_stl::forward<Args>(args)...);
-            /* 后半段再移动 */
-            ++new_end;
-            new_end = my_stl::uninitialized_move(pos, end_, new_end);
+            alloc_traits::construct(alloc_ref(), new_begin + before, my_stl::forward<Args>(args)...);
         } catch (...) {
-            data_allocator::deallocate(new_begin, new_size);
+            MYSTL_INSTRUMENT_FREE(vector, new_size * sizeof(T), new_size * sizeof(T));
+            alloc_traits::deallocate(alloc_ref(), new_begin, new_size);
             throw ;
         }
-        /* 析构和释放原空间内容 */
-        destroy_and_recover(begin_, end_, cap_ - begin_);
+        try {
+            relocate_to(pos, new_begin, 1);
+        } catch (...) {
+            alloc_traits::destroy(alloc_ref(), new_begin + before);
+            MYSTL_INSTRUMENT_FREE(vector, new_size * sizeof(T), new_size * sizeof(T));
+            alloc_traits::deallocate(alloc_ref(), new_begin, new_size);
+            throw ;
+        }
+        const size_type old_size = size();
         begin_ = new_begin;
-        end_ = new_end;
+        end_ = new_begin + old_size + 1;
         cap_ = new_begin + new_size;
     }
 
+    /* 用配置器的reallocate把空间调整为new_cap, 元素被原样保留 */
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::resize_buffer(size_type new_cap, m_true_type) {
+        const size_type old_size = size();
+        MYSTL_INSTRUMENT_FREE(vector, capacity() * sizeof(T), old_size * sizeof(T));
+        begin_ = alloc_traits::reallocate(alloc_ref(), begin_, capacity(), new_cap);
+        end_ = begin_ + old_size;
+        cap_ = begin_ + new_cap;
+    }
+
+    /* 把[begin, pos)和[pos, end)搬到new_begin开始的空间, 中间空出gap个位置, 并释放原空间 */
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::relocate_to(iterator pos, iterator new_begin, size_type gap) {
+        relocate_to(pos, new_begin, gap, m_bool_constant<is_trivially_relocatable<T>::value>());
+    }
+
+    /* 可平凡重定位: 整段memcpy, 不会抛出异常, 旧空间只需释放不需析构 */
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::relocate_to(iterator pos, iterator new_begin, size_type gap, m_true_type) {
+        const size_type before = pos - begin_;
+        my_stl::uninitialized_relocate(begin_, pos, new_begin);
+        my_stl::uninitialized_relocate(pos, end_, new_begin + before + gap);
+        MYSTL_INSTRUMENT_FREE(vector, capacity() * sizeof(T), size() * sizeof(T));
+        alloc_traits::deallocate(alloc_ref(), begin_, cap_ - begin_);
+    }
+
+    /* 一般情况: 逐个移动构造, 中途抛出异常时析构已构造的元素, 原空间保持不变 */
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::relocate_to(iterator pos, iterator new_begin, size_type gap, m_false_type) {
+        const size_type before = pos - begin_;
+        auto mid = my_stl::uninitialized_move(begin_, pos, new_begin);
+        try {
+            my_stl::uninitialized_move(pos, end_, mid + gap);
+        } catch (...) {
+            alloc_traits::destroy(alloc_ref(), new_begin, new_begin + before);
+            throw;
+        }
+        destroy_and_recover(begin_, end_, cap_ - begin_);
+    }
+
     /* fill_insert */
-    template <class T>
-    typename vector<T>::iterator
-    vector<T>::fill_insert(iterator pos, size_type n, const value_type &value) {
+    template <class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator
+    vector<T, Alloc, Growth>::fill_insert(iterator pos, size_type n, const value_type &value) {
         if (n == 0)
             return pos;
         const size_type x_pos = pos - begin_;               /* begin到pos位置的距离*/
         const value_type value_copy = value;                /* 避免原值被覆盖 */
+        if (static_cast<size_type>(cap_ - end_) < n && can_reallocate()) {
+            MYSTL_INSTRUMENT_ALLOC(vector, capacity() * sizeof(T), get_new_cap(n) * sizeof(T));
+            resize_buffer(get_new_cap(n));
+            pos = begin_ + x_pos;
+        }
         if (static_cast<size_type>(cap_ - end_) >= n) {
             /* 剩余空间足够 */
             const size_type after_elements = end_ - pos;     /* pos到end的距离 */
             auto old_end = end_;
-            if (after_elements > n) {
-                my_stl::uninitialized_copy(end_ - n, end_, end_); /* 移动后半段 */
-                end_ += n;                                        /* 更新end */
-                my_stl::move_backward(pos, old_end - n, old_end); /* 填充位置的元素后移 */
-                my_stl::uninitialized_fill_n(pos, n, value_copy); /* 填充新的值 */
+            if (relocatable()) {
+                /* 后半段整体后移n个位置, 空出来的位置直接构造 */
+                shift_right(pos, n);
+                try {
+                    my_stl::uninitialized_fill_n(pos, n, value_copy);
+                } catch (...) {
+                    shift_left(pos, n);
+                    throw;
+                }
+                end_ += n;
+            }
+            else if (after_elements > n) {
+                end_ = my_stl::uninitialized_move(end_ - n, end_, end_);   /* 移动后半段 */
+                my_stl::move_backward(pos, old_end - n, old_end);          /* 填充位置的元素后移 */
+                my_stl::fill_n(pos, n, value_copy);                         /* 填充新的值 */
             }
             else {
                 /* 暴力填充 */
                 end_ = my_stl::uninitialized_fill_n(end_, n - after_elements, value_copy);
                 end_ = my_stl::uninitialized_move(pos, old_end, end_);
-                my_stl::uninitialized_fill_n(pos, after_elements, value_copy);
+                my_stl::fill_n(pos, after_elements, value_copy);
             }
         }
         else {
             /* 剩余空间不足 */
             const auto new_size = get_new_cap(n);
-            auto new_begin = data_allocator::allocate(new_size);
-            auto new_end = new_begin;
+            const size_type old_size = size();
+            auto new_begin = alloc_traits::allocate(alloc_ref(), new_size);
+            MYSTL_INSTRUMENT_ALLOC(vector, capacity() * sizeof(T), new_size * sizeof(T));
+            /* 先填充中间 [pos, pos + n), 再把两边的原有元素搬过去 */
+            try {
+                my_stl::uninitialized_fill_n(new_begin + x_pos, n, value_copy);
+            } catch (...) {
+                MYSTL_INSTRUMENT_FREE(vector, new_size * sizeof(T), new_size * sizeof(T));
+                alloc_traits::deallocate(alloc_ref(), new_begin, new_size);
+                throw;
+            }
             try {
-                /* 分段处理 [begin, pos)  [pos, pos + n)  [pos + n, end) */
-                new_end = my_stl::uninitialized_move(begin_, pos, new_begin);
-                new_end = my_stl::uninitialized_fill_n(new_end, n, value_copy);
-                new_end = my_stl::uninitialized_move(pos, end_, new_end);
+                relocate_to(pos, new_begin, n);
             } catch (...) {
-                /* 释放空间 */
-                destroy_and_recover(new_begin, new_end, new_size);
+                alloc_traits::destroy(alloc_ref(), new_begin + x_pos, new_begin + x_pos + n);
+                MYSTL_INSTRUMENT_FREE(vector, new_size * sizeof(T), new_size * sizeof(T));
+                alloc_traits::deallocate(alloc_ref(), new_begin, new_size);
                 throw;
             }
-            data_allocator::deallocate(begin_, cap_ - begin_);
             begin_ = new_begin;
-            end_ = new_end;
+            end_ = new_begin + old_size + n;
             cap_ = new_begin + new_size;
         }
         return begin_ + x_pos;
     }
 
     /* reallocate_insert */
-    template<class T>
-    void vector<T>::reallocate_insert(iterator pos, const value_type &value) {
-        const auto new_size = get_new_cap(1);
-        auto new_begin = data_allocator::allocate(new_size);
-        auto new_end = new_begin;
-        const value_type &value_copy = value;
-        try {
-            /* 三段式扩展 */
-            new_end = my_stl::uninitialized_move(begin_, pos, new_begin);
-            data_allocator::construct(my_stl::address_of(*new_end), value_copy);
-            ++new_end;
-            new_end = my_stl::uninitialized_move(pos, end_, new_end);
-        } catch (...) {
-            data_allocator::deallocate(new_end, new_size);
-            throw;
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::reallocate_insert(iterator pos, const value_type &value) {
+        reallocate_emplace(pos, value);
+    }
+
+    /* 输入迭代器无法预先知道长度, 只能逐个追加 */
+    template <class T, class Alloc, class Growth>
+    template <class Iter>
+    void vector<T, Alloc, Growth>::append_range(Iter first, Iter last, my_stl::input_iterator_tag) {
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    template <class T, class Alloc, class Growth>
+    template <class Iter>
+    void vector<T, Alloc, Growth>::append_range(Iter first, Iter last, my_stl::forward_iterator_tag) {
+        const size_type n = static_cast<size_type>(my_stl::distance(first, last));
+        reserve_for_append(n);
+        /* 失败时uninitialized_copy会析构已构造的部分, end_保持不变 */
+        end_ = my_stl::uninitialized_copy(first, last, end_);
+    }
+
+    template <class T, class Alloc, class Growth>
+    template <class Generator>
+    void vector<T, Alloc, Growth>::append_n(size_type n, Generator gen MYSTL_INSTRUMENT_SITE_ARG) {
+        MYSTL_INSTRUMENT_ENTER();
+        reserve_for_append(n);
+        /* 空间已经足够, 每构造一个就推进end_, 异常时已追加的元素保留 */
+        for (; n > 0; --n) {
+            alloc_traits::construct(alloc_ref(), end_, gen());
+            ++end_;
         }
-        /* 析构和删除原有的东西 */
-        destroy_and_recover(begin_, end_, cap_ - begin_);
-        begin_ = new_begin;
-        end_ = new_end;
-        cap_ = new_begin + new_size;
     }
 
     /* copy_insert*/
-    template <class T>
+    template <class T, class Alloc, class Growth>
     template <class Iter>
-    void vector<T>::copy_insert(iterator pos, Iter first, Iter last) {
+    void vector<T, Alloc, Growth>::copy_insert(iterator pos, Iter first, Iter last) {
         if (first == last)
             return;
         auto n = my_stl::distance(first, last);  /* 计算范围大小 */
+        if (cap_ - end_ < n && can_reallocate()) {
+            const auto x_pos = pos - begin_;
+            MYSTL_INSTRUMENT_ALLOC(vector, capacity() * sizeof(T), get_new_cap(n) * sizeof(T));
+            resize_buffer(get_new_cap(n));
+            pos = begin_ + x_pos;
+        }
         if (cap_ - end_ >= n){
             /* 剩余空间足够 */
             const auto after_elements = end_ - pos;
             auto old_end = end_;
-            if (after_elements > n) {
-                end_ = my_stl::uninitialized_copy(end_ - n, end_, end_); //构造后半段
+            if (relocatable()) {
+                /* 后半段整体后移n个位置, 空出来的位置直接拷贝构造 */
+                shift_right(pos, n);
+                try {
+                    my_stl::uninitialized_copy(first, last, pos);
+                } catch (...) {
+                    shift_left(pos, n);
+                    throw;
+                }
+                end_ += n;
+            }
+            else if (after_elements > n) {
+                end_ = my_stl::uninitialized_move(end_ - n, end_, end_); //构造后半段
                 my_stl::move_backward(pos, old_end - n, old_end);        //移动原有的到后面
-                my_stl::uninitialized_copy(first, last, pos);            //填充范围元素
+                my_stl::copy(first, last, pos);                          //填充范围元素
             }
             else {
                 auto mid = first;
                 my_stl::advance(mid, after_elements);
                 end_ = my_stl::uninitialized_copy(mid, last, end_);      //拷贝构造目标后半段
                 end_ = my_stl::uninitialized_move(pos, old_end, end_);   //移动原有的
-                my_stl::uninitialized_copy(first, mid, pos);             //拷贝构造目标前半段
+                my_stl::copy(first, mid, pos);                           //拷贝目标前半段
             }
         }
         else {
             /* 剩余空间不足 */
             auto new_size = get_new_cap(n);
-            auto new_begin = data_allocator::allocate(new_size);
-            auto new_end = new_begin;
+            const size_type before = pos - begin_;
+            const size_type old_size = size();
+            auto new_begin = alloc_traits::allocate(alloc_ref(), new_size);
+            MYSTL_INSTRUMENT_ALLOC(vector, capacity() * sizeof(T), new_size * sizeof(T));
+            /* 先拷贝中间 [pos, pos + n), 再把两边的原有元素搬过去 */
+            try {
+                my_stl::uninitialized_copy(first, last, new_begin + before);
+            } catch (...) {
+                MYSTL_INSTRUMENT_FREE(vector, new_size * sizeof(T), new_size * sizeof(T));
+                alloc_traits::deallocate(alloc_ref(), new_begin, new_size);
+                throw;
+            }
             try {
-                /* 分段处理 [begin, pos)  [pos, pos + n)  [pos + n, end) */
-                new_end = my_stl::uninitialized_move(begin_, pos, new_begin);
-                new_end = my_stl::uninitialized_copy(first, last, new_end);
-                new_end = my_stl::uninitialized_move(pos, end_, new_end);
+                relocate_to(pos, new_begin, n);
             } catch (...) {
-                destroy_and_recover(new_begin, new_end, new_size);
+                alloc_traits::destroy(alloc_ref(), new_begin + before, new_begin + before + n);
+                MYSTL_INSTRUMENT_FREE(vector, new_size * sizeof(T), new_size * sizeof(T));
+                alloc_traits::deallocate(alloc_ref(), new_begin, new_size);
                 throw;
             }
-            data_allocator::deallocate(begin_, cap_ - begin_);
             begin_ = new_begin;
-            end_ = new_end;
+            end_ = new_begin + old_size + n;
             cap_ = new_begin + new_size;
         }
     }
 
-    template <class T>
-    void vector<T>::reinsert(size_type size) {
-        auto new_begin = data_allocator::allocate(size);
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::reinsert(size_type size) {
+        if (can_reallocate()) {
+            MYSTL_INSTRUMENT_ALLOC(vector, capacity() * sizeof(T), size * sizeof(T));
+            resize_buffer(size);
+            return;
+        }
+        auto new_begin = alloc_traits::allocate(alloc_ref(), size);
+        MYSTL_INSTRUMENT_ALLOC(vector, capacity() * sizeof(T), size * sizeof(T));
         try {
-            my_stl::uninitialized_move(begin_, end_, new_begin);
+            relocate_to(end_, new_begin, 0);
         } catch (...) {
-            data_allocator::deallocate(new_begin, size);
+            MYSTL_INSTRUMENT_FREE(vector, size * sizeof(T), size * sizeof(T));
+            alloc_traits::deallocate(alloc_ref(), new_begin, size);
             throw;
         }
-        data_allocator::deallocate(begin_, cap_ - begin_);
         begin_ = new_begin;
         end_ = begin_ + size;
         cap_ = begin_ + size;
     }
 
-    template <class T>
-    void vector<T>::print(const char *ends) {
+    template <class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::print(const char *ends) {
         auto first = begin();
         auto last = end();
         while (first != last) {
@@ -793,8 +1161,8 @@ namespace my_stl {
     * 重载比较运算符
     **************************************************************************************/
     /* 重载输出运算符 */
-    template <class T>
-    std::ostream& operator<<(std::ostream &os, const my_stl::vector<T> &vec) {
+    template <class T, class Alloc, class Growth>
+    std::ostream& operator<<(std::ostream &os, const my_stl::vector<T, Alloc, Growth> &vec) {
         for (auto it = vec.begin(); it != vec.end(); ++it) {
             os << *it << " ";
         }
@@ -802,40 +1170,52 @@ namespace my_stl {
         return os;
     }
 
-    template <class T>
-    bool operator==(const vector<T> &lhs, const vector<T> &rhs) {
+    template <class T, class Alloc, class Growth>
+    bool operator==(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs) {
         return lhs.size() == rhs.size() && my_stl::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
 
-    template <class T>
-    bool operator<(const vector<T> &lhs, const vector<T> &rhs) {
+    template <class T, class Alloc, class Growth>
+    bool operator<(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs) {
         return my_stl::s_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
-    template <class T>
-    bool operator!=(const vector<T> &lhs, const vector<T> &rhs) {
+    template <class T, class Alloc, class Growth>
+    bool operator!=(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs) {
         return !(rhs == lhs);
     }
 
-    template <class T>
-    bool operator>(const vector<T> &lhs, const vector<T> &rhs) {
+    template <class T, class Alloc, class Growth>
+    bool operator>(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs) {
         return rhs < lhs;
     }
 
-    template <class T>
-    bool operator<=(const vector<T> &lhs, const vector<T> &rhs) {
+    template <class T, class Alloc, class Growth>
+    bool operator<=(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs) {
         return !(lhs > rhs);
     }
 
-    template <class T>
-    bool operator>=(const vector<T> &lhs, const vector<T> &rhs) {
+    template <class T, class Alloc, class Growth>
+    bool operator>=(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs) {
         return !(lhs < rhs);
     }
 
-    template <class T>
-    void swap(vector<T> &lhs, vector<T> &rhs) {
+    /* copy到vector的尾部插入迭代器时转为append_range, 整批只扩容一次 */
+    template <class InputIter, class T, class Alloc, class Growth>
+    back_insert_iterator<vector<T, Alloc, Growth>>
+    copy(InputIter first, InputIter last, back_insert_iterator<vector<T, Alloc, Growth>> result) {
+        result.container()->append_range(first, last);
+        return result;
+    }
+
+    template <class T, class Alloc, class Growth>
+    void swap(vector<T, Alloc, Growth> &lhs, vector<T, Alloc, Growth> &rhs) {
         lhs.swap(rhs);
     }
+
+    /* vector只持有三根指针和配置器, 配置器能按字节搬运, vector就能 */
+    template <class T, class Alloc, class Growth>
+    struct is_trivially_relocatable<vector<T, Alloc, Growth>> : is_trivially_relocatable<Alloc> {};
 }
 
 
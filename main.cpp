@@ -1,10 +1,30 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <cstdint>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <atomic>
 #include "cmake-build-debug/MySTL/type_traits.h"
 #include "cmake-build-debug/MySTL/vector.h"
 #include "cmake-build-debug/MySTL/functional.h"
 #include "cmake-build-debug/MySTL/list.h"
+#include "cmake-build-debug/MySTL/alloc.h"
+#include "cmake-build-debug/MySTL/arena.h"
+#include "cmake-build-debug/MySTL/small_vector.h"
+#include "cmake-build-debug/MySTL/inplace_vector.h"
+#include "cmake-build-debug/MySTL/bit_vector.h"
+#include "cmake-build-debug/MySTL/algo.h"
+#include "cmake-build-debug/MySTL/parallel_algo.h"
+#include "cmake-build-debug/MySTL/unrolled_list.h"
+#include "cmake-build-debug/MySTL/intrusive_list.h"
 
 
 using namespace std;
@@ -158,8 +178,1848 @@ void test_list() {
     std::cout << "******************************测试通过******************************" << std::endl;
 }
 
-int main() {
+/*
+ * 断言式测试: 失败时打印位置和表达式并计数, 不依赖NDEBUG;
+ * main最后根据test_failures打印结果并返回非0
+ */
+static int test_failures = 0;
+#define TEST_CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            ++test_failures; \
+            std::cout << __FILE__ << ":" << __LINE__ << " 检查失败: " #expr << std::endl; \
+        } \
+    } while (0)
+
+/* 容器和std::vector逐个元素比较 */
+template <class Container, class T>
+bool same_elements(const Container &c, const std::vector<T> &expect) {
+    if (static_cast<size_t>(my_stl::distance(c.begin(), c.end())) != expect.size())
+        return false;
+    return std::equal(expect.begin(), expect.end(), c.begin());
+}
+
+void test_small_vector() {
+    std::cout << "[----------------- Run container test : small_vector -----------------]\n";
+    /* 可平凡重定位的int: 内部缓冲区放满后第一次扩容搬到堆上 */
+    my_stl::small_vector<int, 4> a;
+    TEST_CHECK(a.is_inline() && a.capacity() == 4);
+    for (int i = 0; i < 4; ++i)
+        a.push_back(i);
+    TEST_CHECK(a.is_inline());
+    a.push_back(4);
+    TEST_CHECK(!a.is_inline() && a.capacity() >= 5);
+    TEST_CHECK(same_elements(a, std::vector<int>{0, 1, 2, 3, 4}));
+    a.insert(a.begin() + 1, 2, 9);
+    a.erase(a.begin() + 4);
+    TEST_CHECK(same_elements(a, std::vector<int>{0, 9, 9, 1, 3, 4}));
+    a.erase(a.begin(), a.begin() + 3);
+    a.shrink_to_fit();
+    TEST_CHECK(a.is_inline() && same_elements(a, std::vector<int>{1, 3, 4}));
+
+    /* 不可平凡重定位的string, 在内部缓冲区中插入时触发搬到堆上 */
+    typedef my_stl::small_vector<std::string, 3> svec;
+    svec s{"a", "b", "c"};
+    TEST_CHECK(s.is_inline());
+    s.insert(s.begin() + 1, std::string(40, 'x'));
+    TEST_CHECK(!s.is_inline());
+    TEST_CHECK(same_elements(s, std::vector<std::string>{"a", std::string(40, 'x'), "b", "c"}));
+    s.emplace(s.begin(), s.back());                 /* 参数引用容器内的元素 */
+    TEST_CHECK(s.front() == "c" && s.size() == 5);
+
+    /* 拷贝和移动: 内部缓冲区逐个移动, 堆上直接接管指针 */
+    svec heap_copy(s);
+    TEST_CHECK(same_elements(heap_copy, std::vector<std::string>(s.begin(), s.end())));
+    const std::string *heap_data = &heap_copy.front();
+    svec heap_moved(std::move(heap_copy));
+    TEST_CHECK(&heap_moved.front() == heap_data && heap_copy.empty() && heap_copy.is_inline());
+    svec small{"p", "q"};
+    svec small_moved(std::move(small));
+    TEST_CHECK(small_moved.is_inline() && small.empty());
+    TEST_CHECK(same_elements(small_moved, std::vector<std::string>{"p", "q"}));
+
+    /* 内部和堆上的两个对象交换 */
+    small_moved.swap(heap_moved);
+    TEST_CHECK(small_moved.size() == 5 && !small_moved.is_inline());
+    TEST_CHECK(heap_moved.is_inline() && same_elements(heap_moved, std::vector<std::string>{"p", "q"}));
+    heap_moved = small_moved;
+    TEST_CHECK(heap_moved.size() == 5 && heap_moved.front() == "c");
+    heap_moved.resize(1);
+    heap_moved.shrink_to_fit();
+    TEST_CHECK(heap_moved.is_inline() && heap_moved.size() == 1 && heap_moved[0] == "c");
+}
+
+/* 抛出T型异常时返回true */
+template <class E, class Fn>
+bool throws(Fn fn) {
+    try {
+        fn();
+    } catch (const E&) {
+        return true;
+    }
+    return false;
+}
+
+void test_inplace_vector() {
+    std::cout << "[----------------- Run container test : inplace_vector -----------------]\n";
+    /* int: 可平凡复制的特化, 对象本身也可平凡复制 */
+    typedef my_stl::inplace_vector<int, 8> ivec;
+    static_assert(std::is_trivially_copyable<ivec>::value, "inplace_vector<int, N> should be trivially copyable");
+    ivec a{1, 2, 3};
+    a.emplace_back(4);
+    a.push_back(5);
+    a.emplace(a.begin(), 0);
+    TEST_CHECK(same_elements(a, std::vector<int>{0, 1, 2, 3, 4, 5}));
+    a.insert(a.begin() + 2, 2, 7);                  /* 插入点之后的元素多于n */
+    TEST_CHECK(same_elements(a, std::vector<int>{0, 1, 7, 7, 2, 3, 4, 5}) && a.full());
+    a.erase(a.begin() + 1, a.begin() + 5);
+    TEST_CHECK(same_elements(a, std::vector<int>{0, 3, 4, 5}));
+    a.erase(a.begin());
+    TEST_CHECK(same_elements(a, std::vector<int>{3, 4, 5}));
+
+    ivec copied = a;
+    ivec moved = std::move(copied);
+    ivec raw;
+    std::memcpy(static_cast<void*>(&raw), &a, sizeof(ivec));
+    TEST_CHECK(copied == a && moved == a && raw == a);
+
+    /* 超过容量时抛出length_error, 内容不变 */
+    ivec full(8, 1);
+    TEST_CHECK(throws<std::length_error>([&] {full.push_back(2);}));
+    TEST_CHECK(throws<std::length_error>([&] {full.insert(full.begin(), 9);}));
+    TEST_CHECK(throws<std::length_error>([&] {a.insert(a.begin(), 6, 0);}));
+    TEST_CHECK(throws<std::length_error>([&] {a.reverse(9);}));
+    TEST_CHECK(throws<std::out_of_range>([&] {a.at(3);}));
+    TEST_CHECK(full == ivec(8, 1) && same_elements(a, std::vector<int>{3, 4, 5}));
+
+    /* string: 逐个拷贝/移动/析构的版本 */
+    typedef my_stl::inplace_vector<std::string, 6> svec;
+    svec s{"b", "c", "d"};
+    s.insert(s.begin() + 1, 3, std::string(30, 'x'));   /* 插入点之后的元素少于n */
+    TEST_CHECK(s.size() == 6 && s[1] == std::string(30, 'x') && s[4] == "c" && s.back() == "d");
+    s.erase(s.begin() + 1, s.begin() + 4);
+    std::string items[] = {"y", "z"};
+    s.insert(s.begin(), items, items + 2);
+    TEST_CHECK(same_elements(s, std::vector<std::string>{"y", "z", "b", "c", "d"}));
+    s.emplace(s.begin() + 1, s.back());
+    TEST_CHECK(same_elements(s, std::vector<std::string>{"y", "d", "z", "b", "c", "d"}));
+    TEST_CHECK(throws<std::length_error>([&] {s.emplace_back("w");}));
+    svec s_copy(s);
+    svec s_moved(std::move(s_copy));
+    TEST_CHECK(s_moved == s);
+    svec t{"t"};
+    t.swap(s_moved);
+    TEST_CHECK(t == s && s_moved.size() == 1 && s_moved[0] == "t");
+    t.resize(2);
+    TEST_CHECK(same_elements(t, std::vector<std::string>{"y", "d"}));
+}
+
+/* 最后一个字里超出size()的位必须是0 */
+template <class Bits>
+bool tail_clear(const Bits &b) {
+    const size_t extra = b.size() % 64;
+    return extra == 0 || b.num_words() == 0 || (b.data()[b.num_words() - 1] >> extra) == 0;
+}
+
+void test_bit_vector() {
+    std::cout << "[----------------- Run container test : bit_vector -----------------]\n";
+    my_stl::bit_vector<> b(70, true);
+    TEST_CHECK(b.count() == 70 && b.all() && tail_clear(b));
+    /* 缩小再以false扩大, 原来超出的位不能重新出现 */
+    b.resize(65);
+    TEST_CHECK(b.count() == 65 && tail_clear(b));
+    b.resize(130);
+    TEST_CHECK(b.count() == 65 && !b.test(65) && !b.test(129) && tail_clear(b));
+    /* 以true扩大时只补新增的位 */
+    b.resize(3);
+    b.resize(100, true);
+    TEST_CHECK(b.count() == 100 && tail_clear(b));
+    b.flip();
+    TEST_CHECK(b.none() && tail_clear(b));
+    b.flip();
+    TEST_CHECK(b.all() && tail_clear(b));
+    my_stl::bit_vector<> inverted = ~b;
+    TEST_CHECK(inverted.none() && tail_clear(inverted));
+
+    /* 逐位修改和跨字查找 */
+    my_stl::bit_vector<> c(200);
+    const size_t marks[] = {0, 63, 64, 127, 150, 199};
+    for (size_t m : marks)
+        c.set(m);
+    size_t found = 0, pos = c.find_first();
+    for (; pos != c.size(); pos = c.find_next(pos))
+        TEST_CHECK(pos == marks[found++]);
+    TEST_CHECK(found == 6 && c.count() == 6);
+    c.flip(63);
+    c[199] = false;
+    TEST_CHECK(c.count() == 4 && c.find_next(0) == 64 && c.find_next(150) == c.size());
+
+    /* push_back/pop_back跨过字的边界 */
+    my_stl::bit_vector<> d;
+    for (size_t i = 0; i < 129; ++i)
+        d.push_back(i % 3 == 0);
+    TEST_CHECK(d.size() == 129 && d.num_words() == 3 && d.count() == 43);
+    d.pop_back();
+    TEST_CHECK(d.num_words() == 2 && d.count() == 43 && tail_clear(d));
+    d.pop_back();
+    d.pop_back();
+    TEST_CHECK(d.size() == 126 && d.count() == 42 && tail_clear(d));
+
+    /* 批量运算 */
+    my_stl::bit_vector<> x{true, true, false, false}, y{true, false, true, false};
+    TEST_CHECK((x & y) == (my_stl::bit_vector<>{true, false, false, false}));
+    TEST_CHECK((x | y) == (my_stl::bit_vector<>{true, true, true, false}));
+    TEST_CHECK((x ^ y) == (my_stl::bit_vector<>{false, true, true, false}));
+    my_stl::bit_vector<> shorter(3);
+    TEST_CHECK(throws<std::length_error>([&] {x &= shorter;}));
+    TEST_CHECK(throws<std::length_error>([&] {x |= shorter;}));
+    TEST_CHECK(throws<std::length_error>([&] {x ^= shorter;}));
+    TEST_CHECK(throws<std::out_of_range>([&] {x.at(4);}));
+    TEST_CHECK(x == (my_stl::bit_vector<>{true, true, false, false}));
+}
+
+/* 比较次数达到throw_at时抛出一次异常, 之后正常比较 */
+struct throwing_less {
+    std::atomic<size_t> *calls;
+    size_t throw_at;
+    bool operator()(const std::string &a, const std::string &b) const {
+        if (calls->fetch_add(1) + 1 == throw_at)
+            throw std::runtime_error("compare");
+        return a < b;
+    }
+};
+
+void test_parallel_sort() {
+    std::cout << "[----------------- Run algorithm test : parallel_sort -----------------]\n";
+    const size_t n = 5000, grain = 64;
+    my_stl::thread_pool pool(3);
+    std::mt19937 gen(17);
+    std::vector<std::string> origin;
+    for (size_t i = 0; i < n; ++i)  /* 超出短字符串优化的长度, 被移动后变成空串 */
+        origin.push_back("value-" + std::to_string(gen() % 1000) + "-padding-padding-padding");
+    std::vector<std::string> expect(origin);
+    std::sort(expect.begin(), expect.end());
+
+    std::atomic<size_t> calls(0);
+    my_stl::vector<std::string> v(origin.data(), origin.data() + n);
+    my_stl::parallel_sort(v.begin(), v.end(), throwing_less{&calls, 0}, grain, pool);
+    TEST_CHECK(same_elements(v, expect));
+    const size_t total = calls.load();
+
+    /* 异常可能发生在分配, 桶排序或移回的任一阶段, 最多一个元素停留在被移动后的状态, 其余元素都要回到原区间 */
+    for (size_t k = 1; k <= 16; ++k) {
+        calls = 0;
+        my_stl::vector<std::string> w(origin.data(), origin.data() + n);
+        const bool threw = throws<std::runtime_error>([&] {
+            my_stl::parallel_sort(w.begin(), w.end(), throwing_less{&calls, total * k / 17}, grain, pool);
+        });
+        TEST_CHECK(threw && w.size() == n);
+        std::vector<std::string> left;
+        for (auto &x : w)
+            if (!x.empty())
+                left.push_back(x);
+        std::sort(left.begin(), left.end());
+        TEST_CHECK(left.size() + 1 >= n && std::includes(expect.begin(), expect.end(), left.begin(), left.end()));
+    }
+}
+
+/* 第i个元素的迭代器, 用于只有双向迭代器的容器 */
+template <class Container>
+typename Container::iterator nth(Container &c, size_t i) {
+    auto it = c.begin();
+    for (; i > 0; --i)
+        ++it;
+    return it;
+}
+
+/* 正反两个方向都和expect一致, 每个结点交出的段都不空, 段数等于结点数 */
+template <class UL, class T>
+bool same_unrolled(const UL &u, const std::list<T> &expect) {
+    if (u.size() != expect.size() || !std::equal(expect.begin(), expect.end(), u.begin()))
+        return false;
+    auto r = u.end();
+    for (auto it = expect.rbegin(); it != expect.rend(); ++it)
+        if (!(*--r == *it))
+            return false;
+    size_t elements = 0, segments = 0;
+    bool empty_segment = false;
+    u.for_each_segment([&](const T *f, const T *l) {
+        empty_segment = empty_segment || f == l;
+        elements += static_cast<size_t>(l - f);
+        ++segments;
+    });
+    return !empty_segment && elements == u.size() && segments == u.node_count();
+}
+
+void test_unrolled_list() {
+    std::cout << "[----------------- Run container test : unrolled_list -----------------]\n";
+    typedef my_stl::unrolled_list<int, 4> ulist;
+    ulist u;
+    std::list<int> ref;
+    for (int i = 0; i < 8; ++i) {
+        u.push_back(i);
+        ref.push_back(i);
+    }
+    TEST_CHECK(u.node_count() == 2 && same_unrolled(u, ref));
+
+    /* 在满结点中间插入: 结点对半分裂, 其他结点的迭代器不失效 */
+    auto six = nth(u, 6);
+    auto r = u.insert(nth(u, 2), 100);
+    ref.insert(std::next(ref.begin(), 2), 100);
+    TEST_CHECK(*r == 100 && *six == 6 && u.node_count() == 3 && same_unrolled(u, ref));
+    u.insert(nth(u, 5), 3, 200);
+    ref.insert(std::next(ref.begin(), 5), 3, 200);
+    TEST_CHECK(same_unrolled(u, ref));
+
+    /* 在自身内部splice, 区间两端和目标位置都落在结点中间 */
+    u.splice(nth(u, 1), u, nth(u, 6), nth(u, 10));
+    ref.splice(std::next(ref.begin(), 1), ref, std::next(ref.begin(), 6), std::next(ref.begin(), 10));
+    TEST_CHECK(u.size() == 12 && same_unrolled(u, ref));
+    u.splice(u.end(), u, u.begin(), nth(u, 3));
+    ref.splice(ref.end(), ref, ref.begin(), std::next(ref.begin(), 3));
+    TEST_CHECK(same_unrolled(u, ref));
+    u.splice(u.begin(), u, nth(u, 7));
+    ref.splice(ref.begin(), ref, std::next(ref.begin(), 7));
+    TEST_CHECK(same_unrolled(u, ref));
+    u.splice(nth(u, 4), u, nth(u, 4), nth(u, 4));   /* 空区间 */
+    TEST_CHECK(same_unrolled(u, ref));
+
+    /* 从另一个list搬运一段, 两边都在结点中间分裂 */
+    ulist other{50, 51, 52, 53, 54, 55, 56};
+    std::list<int> other_ref{50, 51, 52, 53, 54, 55, 56};
+    u.splice(nth(u, 9), other, nth(other, 2), nth(other, 6));
+    ref.splice(std::next(ref.begin(), 9), other_ref, std::next(other_ref.begin(), 2), std::next(other_ref.begin(), 6));
+    TEST_CHECK(same_unrolled(u, ref) && same_unrolled(other, other_ref));
+    u.splice(nth(u, 3), other);
+    ref.splice(std::next(ref.begin(), 3), other_ref);
+    TEST_CHECK(other.empty() && other.node_count() == 0 && same_unrolled(u, ref));
+
+    /* 跨结点erase后结点半空, shrink_to_fit重新装满 */
+    r = u.erase(nth(u, 2), nth(u, 11));
+    auto ref_r = ref.erase(std::next(ref.begin(), 2), std::next(ref.begin(), 11));
+    TEST_CHECK(*r == *ref_r && same_unrolled(u, ref));
+    u.erase(nth(u, 1));
+    ref.erase(std::next(ref.begin(), 1));
+    u.shrink_to_fit();
+    TEST_CHECK(u.node_count() == (u.size() + 3) / 4 && same_unrolled(u, ref));
+
+    u.sort();
+    ref.sort();
+    u.reverse();
+    ref.reverse();
+    TEST_CHECK(same_unrolled(u, ref));
+
+    /* string: 分裂和搬运时逐个移动构造/析构, 交给ASan检查 */
+    typedef my_stl::unrolled_list<std::string, 3> slist;
+    slist s;
+    std::list<std::string> sref;
+    for (int i = 0; i < 10; ++i) {
+        const std::string v = std::string(30, char('a' + i));
+        s.push_front(v);
+        sref.push_front(v);
+    }
+    s.insert(nth(s, 4), s.back());                      /* 参数引用容器内的元素 */
+    sref.insert(std::next(sref.begin(), 4), sref.back());
+    s.splice(nth(s, 2), s, nth(s, 5), s.end());
+    sref.splice(std::next(sref.begin(), 2), sref, std::next(sref.begin(), 5), sref.end());
+    TEST_CHECK(same_unrolled(s, sref));
+    s.erase(nth(s, 1), nth(s, 8));
+    sref.erase(std::next(sref.begin(), 1), std::next(sref.begin(), 8));
+    slist t(s);
+    t.shrink_to_fit();
+    TEST_CHECK(same_unrolled(s, sref) && same_unrolled(t, sref) && t == s);
+}
+
+/* 同一个对象用两个hook挂进两个链表, hook不在对象开头 */
+struct linked_item {
+    std::string name;
+    int key;
+    int seq;
+    my_stl::intrusive_list_hook all;
+    my_stl::intrusive_list_hook some;
+};
+
+/* 正向与反向遍历得到同一个序列(next和prev都链接正确), 并且长度等于size() */
+template <class IList>
+std::vector<const linked_item*> linked_order(const IList &l, bool &consistent) {
+    std::vector<const linked_item*> forward, backward;
+    for (auto &x : l)
+        forward.push_back(&x);
+    for (auto it = l.end(); it != l.begin(); )
+        backward.push_back(&*--it);
+    std::reverse(backward.begin(), backward.end());
+    consistent = forward == backward && forward.size() == l.size();
+    return forward;
+}
+
+/* key不降, key相同时seq递增 */
+template <class IList>
+bool stable_by_key(const IList &l) {
+    bool consistent = false;
+    auto order = linked_order(l, consistent);
+    for (size_t i = 1; i < order.size(); ++i)
+        if (order[i]->key < order[i - 1]->key || (order[i]->key == order[i - 1]->key && order[i]->seq < order[i - 1]->seq))
+            return false;
+    return consistent;
+}
+
+void test_intrusive_list() {
+    std::cout << "[----------------- Run container test : intrusive_list -----------------]\n";
+    typedef my_stl::intrusive_list<linked_item, &linked_item::all> all_list;
+    typedef my_stl::intrusive_list<linked_item, &linked_item::some> some_list;
+    auto by_key = [](const linked_item &lhs, const linked_item &rhs) {return lhs.key < rhs.key;};
+    const int n = 300;
+    /* 链表在对象之后声明, 先析构, 析构时把对象摘下来 */
+    std::vector<linked_item> pool(n);
+    all_list a, c;
+    some_list b;
+    for (int i = 0; i < n; ++i) {
+        pool[i].key = (i * 37) % 11;
+        pool[i].seq = i;
+        a.push_back(pool[i]);
+        if (i % 3 == 0)
+            b.push_front(pool[i]);
+    }
+    bool consistent = false;
+    TEST_CHECK(a.size() == n && b.size() == n / 3);
+    TEST_CHECK(&*a.iterator_to(pool[7]) == &pool[7] && &*b.iterator_to(pool[9]) == &pool[9]);
+    TEST_CHECK(linked_order(b, consistent).front() == &pool[n - 3] && consistent);
+
+    /* 摘下的对象hook复位, 另一个hook不受影响 */
+    a.erase(a.iterator_to(pool[3]));
+    a.pop_front();
+    a.pop_back();
+    TEST_CHECK(!pool[3].all.is_linked() && pool[3].some.is_linked());
+    TEST_CHECK(!pool[0].all.is_linked() && !pool[n - 1].all.is_linked() && a.size() == n - 3);
+    a.remove_if([](const linked_item &x) {return x.seq % 10 == 5;});
+    TEST_CHECK(!pool[15].all.is_linked() && pool[15].some.is_linked() && a.size() == n - 3 - 30);
+    b.erase(b.iterator_to(pool[3]));
+    TEST_CHECK(!pool[3].some.is_linked());
+
+    /* 排序只重新链接: 对象地址不变, 稳定, next和prev两个方向都对 */
+    const linked_item *first_obj = &pool[1];
+    a.sort(by_key);
+    TEST_CHECK(stable_by_key(a) && a.size() == n - 33 && first_obj->all.is_linked());
+    b.sort(by_key);
+    TEST_CHECK(linked_order(b, consistent).size() == n / 3 - 1 && consistent);
+    a.reverse();
+    a.reverse();
+    a.sort(by_key);     /* 已经有序的输入 */
+    TEST_CHECK(stable_by_key(a));
+
+    /* 把一段splice到另一个链表, 再有序合并回来 */
+    auto mid = a.begin();
+    for (int i = 0; i < 100; ++i)
+        ++mid;
+    c.splice(c.end(), a, a.begin(), mid);
+    TEST_CHECK(c.size() == 100 && a.size() == n - 133 && stable_by_key(c) && stable_by_key(a));
+    c.merge(a, by_key);   /* key相同时c(原来在前的一段)的对象在前 */
+    a.swap(c);
+    TEST_CHECK(c.empty() && a.size() == n - 33 && stable_by_key(a));
+    c.splice(c.begin(), a, a.iterator_to(pool[1]));
+    TEST_CHECK(c.size() == 1 && &c.front() == &pool[1] && pool[1].all.is_linked());
+
+    /* 按当前位置重新编号, key逆序: 归并排序要整段重新链接 */
+    int pos = 0;
+    for (auto &x : a) {
+        x.seq = pos++;
+        x.key = -x.seq / 4;
+    }
+    a.sort(by_key);
+    TEST_CHECK(stable_by_key(a) && a.front().key == -(pos - 1) / 4 && a.back().seq == 3);
+
+    int disposed = 0;
+    a.erase_and_dispose(a.begin(), [&](linked_item *p) {disposed += p->all.is_linked() ? 100 : 1;});
+    c.clear_and_dispose([&](linked_item *p) {disposed += p->all.is_linked() ? 100 : 1;});
+    TEST_CHECK(disposed == 2 && !pool[1].all.is_linked());
+    a.clear();
+    bool any_linked = false;
+    for (auto &x : pool)
+        any_linked = any_linked || x.all.is_linked();
+    TEST_CHECK(!any_linked && a.empty() && b.size() == n / 3 - 1);
+}
+
+#ifdef MYSTL_INSTRUMENT
+/* 调用点的键以"main.cpp:行号 "开头 */
+bool site_at(const std::string &key, unsigned line) {
+    const std::string prefix = "main.cpp:" + std::to_string(line) + " ";
+    return key.compare(0, prefix.size(), prefix) == 0;
+}
+
+void test_instrument() {
+    std::cout << "[----------------- Run instrument test -----------------]\n";
+    my_stl::instrument::reset();
+    unsigned reserve_line = 0, grow_line = 0;
+    size_t wasted = 0;
+    {
+        my_stl::vector<int> v;
+        v.reverse(10); reserve_line = __LINE__;
+        for (int i = 0; i < 10; ++i)
+            v.push_back(i);
+        v.push_back(10); grow_line = __LINE__;
+        wasted = (v.capacity() - v.size()) * sizeof(int);
+    }
+    const auto stats = my_stl::instrument::stats(typeid(my_stl::vector<int>));
+    TEST_CHECK(stats.total.allocs == 2 && stats.total.reallocs == 1 && stats.total.frees == 2);
+    TEST_CHECK(stats.total.live_bytes == 0 && stats.total.wasted_bytes == wasted);
+    TEST_CHECK(stats.sites.size() == 2);
+    for (auto &site : stats.sites) {
+        if (site_at(site.first, reserve_line))
+            TEST_CHECK(site.second.allocs == 1 && site.second.reallocs == 0 && site.second.bytes == 10 * sizeof(int));
+        else
+            TEST_CHECK(site_at(site.first, grow_line) && site.second.allocs == 1 && site.second.reallocs == 1);
+    }
+    my_stl::instrument::reset();
+    TEST_CHECK(my_stl::instrument::stats(typeid(my_stl::vector<int>)).sites.empty());
+}
+#endif
+
+void test_vector_uninitialized() {
+    std::cout << "[----------------- Run container test : vector uninitialized growth -----------------]\n";
+    my_stl::vector<int> v{1, 2, 3};
+    v.resize_default_init(100);
+    TEST_CHECK(v.size() == 100 && v.capacity() >= 100 && v[0] == 1 && v[1] == 2 && v[2] == 3);
+    for (int i = 3; i < 100; ++i)
+        v[i] = i;
+    const size_t cap = v.capacity();
+    v.resize_default_init(2);
+    TEST_CHECK(v.size() == 2 && v.capacity() == cap && v[0] == 1 && v[1] == 2);
+
+    /* 容量足够时不重新分配, 原有元素不动 */
+    const int *data = v.data();
+    v.resize_uninitialized(50);
+    TEST_CHECK(v.size() == 50 && v.capacity() == cap && v.data() == data && v[1] == 2);
+    v.resize_uninitialized(0);
+    TEST_CHECK(v.empty() && v.capacity() == cap);
+
+    /* append_uninitialized返回第一个新元素, 扩容后也指向新空间 */
+    v.push_back(7);
+    int *p = v.append_uninitialized(4);
+    TEST_CHECK(p == v.data() + 1 && v.size() == 5);
+    for (int i = 0; i < 4; ++i)
+        p[i] = 10 + i;
+    p = v.append_uninitialized(cap);
+    TEST_CHECK(p == v.data() + 5 && v.size() == cap + 5 && v.capacity() >= cap + 5);
+    std::memset(p, 0, cap * sizeof(int));
+    TEST_CHECK(v[0] == 7 && v[1] == 10 && v[4] == 13 && v.back() == 0);
+    p = v.append_uninitialized(0);
+    TEST_CHECK(p == v.data() + v.size() && v.size() == cap + 5);
+
+    /* 非平凡类型的新元素是默认构造的 */
+    my_stl::vector<std::string> s{"a", "b"};
+    s.resize_default_init(40);
+    TEST_CHECK(s.size() == 40 && s.capacity() >= 40 && s[0] == "a" && s[1] == "b" && s[2].empty() && s[39].empty());
+    s.resize_default_init(1);
+    TEST_CHECK(s.size() == 1 && s.capacity() >= 40 && s[0] == "a");
+}
+
+/* 单遍的输入迭代器, 依次产生cur, cur + 1, ... ; append_range对它只能逐个追加 */
+struct counting_input_iterator : my_stl::iterator<my_stl::input_iterator_tag, int> {
+    int cur;
+    explicit counting_input_iterator(int c) : cur(c) {}
+    int operator*() const {return cur;}
+    counting_input_iterator& operator++() {++cur; return *this;}
+    bool operator==(const counting_input_iterator &rhs) const {return cur == rhs.cur;}
+    bool operator!=(const counting_input_iterator &rhs) const {return cur != rhs.cur;}
+};
+
+void test_vector_append() {
+    std::cout << "[----------------- Run container test : vector append -----------------]\n";
+    std::vector<int> expect;
+    my_stl::vector<int> v;
+    /* 前向迭代器: 先算长度, 空vector按请求大小一次分配 */
+    int src[1000];
+    for (int i = 0; i < 1000; ++i)
+        src[i] = i;
+    v.append_range(src, src);
+    TEST_CHECK(v.empty() && v.capacity() == 0);
+    v.append_range(src, src + 1000);
+    expect.insert(expect.end(), src, src + 1000);
+    TEST_CHECK(v.capacity() == 1000 && same_elements(v, expect));
+    my_stl::list<int> l{-1, -2, -3};
+    v.append_range(l.begin(), l.end());             /* 扩容, 双向迭代器 */
+    expect.insert(expect.end(), {-1, -2, -3});
+    TEST_CHECK(v.capacity() >= 1003 && same_elements(v, expect));
+
+    /* 输入迭代器: 逐个追加, 中途扩容 */
+    my_stl::vector<int> w;
+    w.append_range(counting_input_iterator(5), counting_input_iterator(5));
+    TEST_CHECK(w.empty());
+    w.append_range(counting_input_iterator(0), counting_input_iterator(100));
+    TEST_CHECK(w.size() == 100 && w.front() == 0 && w.back() == 99 && w[57] == 57);
+
+    /* copy到back_inserter转为append_range, 两种迭代器都走得通 */
+    my_stl::vector<int> c{7};
+    my_stl::copy(src + 10, src + 20, my_stl::back_inserter(c));
+    my_stl::copy(counting_input_iterator(3), counting_input_iterator(6), my_stl::back_inserter(c));
+    my_stl::copy(src, src, my_stl::back_inserter(c));
+    TEST_CHECK(same_elements(c, std::vector<int>{7, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 3, 4, 5}));
+
+    /* append_n: 只扩容一次, n == 0时不变 */
+    my_stl::vector<std::string> s{"x"};
+    int next = 0;
+    s.append_n(0, [&] {return std::to_string(next++);});
+    TEST_CHECK(s.size() == 1 && next == 0);
+    s.append_n(50, [&] {return std::to_string(next++);});
+    TEST_CHECK(s.size() == 51 && s.capacity() >= 51 && s[0] == "x" && s[1] == "0" && s[50] == "49");
+    const size_t cap = s.capacity();
+    s.append_range(s.begin(), s.begin());
+    TEST_CHECK(s.size() == 51 && s.capacity() == cap);
+}
+
+void test_vector_unchecked() {
+    std::cout << "[----------------- Run container test : vector unchecked append -----------------]\n";
+    my_stl::vector<std::string> s;
+    s.reverse(4);
+    const std::string *data = s.data();
+    const std::string a = "alpha";
+    s.push_back_unchecked(a);
+    s.push_back_unchecked(std::string(30, 'b'));
+    s.unchecked_emplace_back(3, 'c');
+    s.unchecked_emplace_back();
+    TEST_CHECK(s.data() == data && s.size() == 4 && s.capacity() == 4);
+    TEST_CHECK(same_elements(s, std::vector<std::string>{"alpha", std::string(30, 'b'), "ccc", ""}));
+
+    /* reserve_and_fill: fill写满n个 */
+    my_stl::vector<int> v{1, 2};
+    size_t added = v.reserve_and_fill(10, [](int *p) {
+        for (int i = 0; i < 10; ++i)
+            *p++ = 100 + i;
+        return p;
+    });
+    TEST_CHECK(added == 10 && v.size() == 12 && v.capacity() >= 12 && v[2] == 100 && v.back() == 109);
+
+    /* 只写了3个: 返回3, end_停在写到的位置, 预留的空间留着给下一次 */
+    const size_t cap_before = v.capacity();
+    added = v.reserve_and_fill(64, [](int *p) {
+        for (int i = 0; i < 3; ++i)
+            *p++ = -i;
+        return p;
+    });
+    TEST_CHECK(added == 3 && v.size() == 15 && v.capacity() >= 12 + 64 && v.capacity() > cap_before);
+    TEST_CHECK(v[11] == 109 && v[12] == 0 && v[13] == -1 && v.back() == -2);
+    v.push_back(42);
+    TEST_CHECK(v.size() == 16 && v[15] == 42);
+
+    /* 一个也没写 */
+    const int *before = v.data();
+    added = v.reserve_and_fill(8, [](int *p) {return p;});
+    TEST_CHECK(added == 0 && v.size() == 16 && v.data() == before && v.back() == 42);
+}
+
+/* McIlroy的快速排序攻击者: 元素的值在比较时才确定, 让每一次划分都极不均衡.
+ * 没有堆排序兜底时n = 4096要一百多万次比较, 有兜底时在6nlogn以内 */
+struct qsort_adversary {
+    std::vector<int> val;
+    int gas;
+    int solid = 0;
+    int candidate = 0;
+    size_t compares = 0;
+    explicit qsort_adversary(int n) : val(n, n), gas(n) {}
+};
+
+struct adversary_less {
+    qsort_adversary *a;
+    bool operator()(int x, int y) const {
+        ++a->compares;
+        if (a->val[x] == a->gas && a->val[y] == a->gas)
+            a->val[x == a->candidate ? x : y] = a->solid++;
+        if (a->val[x] == a->gas)
+            a->candidate = x;
+        else if (a->val[y] == a->gas)
+            a->candidate = y;
+        return a->val[x] < a->val[y];
+    }
+};
+
+/* 用攻击者排序0..n-1, 检查结果有序并且比较次数在6nlogn以内 */
+template <class Sorter>
+bool survives_adversary(int n, Sorter sorter) {
+    qsort_adversary adv(n);
+    std::vector<int> v(n);
+    for (int i = 0; i < n; ++i)
+        v[i] = i;
+    sorter(v.data(), v.data() + n, adversary_less{&adv});
+    for (int i = 1; i < n; ++i)
+        if (adv.val[v[i]] < adv.val[v[i - 1]])
+            return false;
+    return static_cast<double>(adv.compares) < 6.0 * n * std::log2(n);
+}
+
+/* 长度n的各种输入: 随机(有重复), 有序, 逆序, 全相等, 先升后降 */
+std::vector<std::vector<int>> sort_test_inputs(size_t n, std::mt19937 &gen) {
+    std::vector<std::vector<int>> inputs(5, std::vector<int>(n));
+    for (size_t i = 0; i < n; ++i) {
+        inputs[0][i] = static_cast<int>(gen() % (n / 2 + 1)) - static_cast<int>(n / 4);
+        inputs[1][i] = static_cast<int>(i);
+        inputs[2][i] = static_cast<int>(n - i);
+        inputs[3][i] = 7;
+        inputs[4][i] = static_cast<int>(i < n / 2 ? i : n - i);
+    }
+    return inputs;
+}
+
+/* sorter排出的结果和std::sort相同 */
+template <class Sorter>
+bool sorts_like_std(std::vector<int> input, Sorter sorter) {
+    std::vector<int> expect(input);
+    std::sort(expect.begin(), expect.end());
+    sorter(input.data(), input.data() + input.size());
+    return input == expect;
+}
+
+void test_sort() {
+    std::cout << "[----------------- Run algorithm test : sort -----------------]\n";
+    std::mt19937 gen(31);
+    auto introsort = [](int *first, int *last) {my_stl::introsort(first, last);};
+    /* 空区间, 一个和两个元素, 以及插入排序阈值(16)两侧 */
+    for (size_t n : {0, 1, 2, 3, 15, 16, 17, 33, 100, 1000})
+        for (auto &input : sort_test_inputs(n, gen))
+            TEST_CHECK(sorts_like_std(input, introsort));
+    TEST_CHECK(survives_adversary(4096, [](int *first, int *last, adversary_less comp) {
+        my_stl::introsort(first, last, comp);
+    }));
+
+    /* pdqsort: less<int>走无分支划分, lambda走普通划分; 插入排序阈值(24), 分块大小(64), 九数中值(128)两侧 */
+    auto branchless = [](int *first, int *last) {my_stl::sort(first, last);};
+    auto branchy = [](int *first, int *last) {my_stl::sort(first, last, [](int a, int b) {return a < b;});};
+    auto descending = [](int *first, int *last) {
+        my_stl::sort(first, last, my_stl::greater<int>());
+        std::reverse(first, last);
+    };
+    for (size_t n : {0, 1, 2, 23, 24, 25, 63, 64, 65, 127, 128, 129, 5000}) {
+        for (auto &input : sort_test_inputs(n, gen)) {
+            TEST_CHECK(sorts_like_std(input, branchless));
+            TEST_CHECK(sorts_like_std(input, branchy));
+        }
+        std::vector<int> few_unique(n);
+        for (auto &x : few_unique)
+            x = static_cast<int>(gen() % 3);
+        TEST_CHECK(sorts_like_std(few_unique, branchless) && sorts_like_std(few_unique, descending));
+    }
+    TEST_CHECK(survives_adversary(4096, [](int *first, int *last, adversary_less comp) {
+        my_stl::sort(first, last, comp);
+    }));
+
+    /* 比较代价高的类型 */
+    my_stl::vector<std::string> words;
+    for (int i = 0; i < 300; ++i)
+        words.push_back(std::to_string(gen() % 50));
+    std::vector<std::string> expect(words.begin(), words.end());
+    std::sort(expect.begin(), expect.end());
+    my_stl::sort(words.begin(), words.end());
+    TEST_CHECK(same_elements(words, expect));
+
+    /* radix_sort: 负数, 插入排序阈值(64)两侧, 某些字节全相同被跳过的趟 */
+    auto radix = [](int *first, int *last) {my_stl::radix_sort(first, last);};
+    for (size_t n : {0, 1, 2, 63, 64, 65, 3000}) {
+        for (auto &input : sort_test_inputs(n, gen))
+            TEST_CHECK(sorts_like_std(input, radix));
+        my_stl::vector<int64_t> wide;
+        for (size_t i = 0; i < n; ++i)
+            wide.push_back(static_cast<int64_t>(gen()) * (i % 2 ? -1 : 1) * 100003);
+        std::vector<int64_t> wide_expect(wide.begin(), wide.end());
+        std::sort(wide_expect.begin(), wide_expect.end());
+        my_stl::radix_sort(wide.begin(), wide.end());
+        TEST_CHECK(same_elements(wide, wide_expect));
+    }
+
+    /* float: 正负数和±0.0, -0.0排在+0.0之前 */
+    my_stl::vector<float> f;
+    for (int i = 0; i < 200; ++i) {
+        f.push_back(static_cast<float>(static_cast<int>(gen() % 2001) - 1000) / 8.0f);
+        f.push_back(i % 2 ? 0.0f : -0.0f);
+    }
+    my_stl::radix_sort(f.begin(), f.end());
+    TEST_CHECK(std::is_sorted(f.begin(), f.end()));
+    bool zeros_ordered = true, seen_positive_zero = false;
+    for (float x : f) {
+        if (x != 0.0f)
+            continue;
+        if (!std::signbit(x))
+            seen_positive_zero = true;
+        else if (seen_positive_zero)
+            zeros_ordered = false;
+    }
+    TEST_CHECK(zeros_ordered && seen_positive_zero);
+
+    /* pair只按first排序, first相同时保持原来的先后 */
+    typedef my_stl::pair<int, int> keyed;
+    for (size_t n : {50, 5000}) {
+        my_stl::vector<keyed> pairs;
+        for (size_t i = 0; i < n; ++i)
+            pairs.push_back(keyed(static_cast<int>(gen() % 21) - 10, static_cast<int>(i)));
+        my_stl::radix_sort(pairs.begin(), pairs.end());
+        bool stable = pairs.size() == n;
+        for (size_t i = 1; i < pairs.size(); ++i)
+            stable = stable && (pairs[i - 1].first < pairs[i].first ||
+                                (pairs[i - 1].first == pairs[i].first && pairs[i - 1].second < pairs[i].second));
+        TEST_CHECK(stable);
+    }
+
+    /* stable_sort: 按key排序, seq记录原来的位置; 块长(7)和无缓冲区阈值(15)两侧, 以及不用缓冲区的版本 */
+    typedef my_stl::pair<int, int> item;
+    auto by_key = [](const item &a, const item &b) {return a.first < b.first;};
+    auto key_then_seq = [](const my_stl::vector<item> &v) {
+        for (size_t i = 1; i < v.size(); ++i)
+            if (v[i].first < v[i - 1].first || (v[i].first == v[i - 1].first && v[i].second < v[i - 1].second))
+                return false;
+        return true;
+    };
+    for (size_t n : {0, 1, 2, 6, 7, 8, 14, 15, 16, 100, 3000}) {
+        my_stl::vector<item> a;
+        for (size_t i = 0; i < n; ++i)
+            a.push_back(item(static_cast<int>(gen() % 7), static_cast<int>(i)));
+        my_stl::vector<item> b(a);
+        my_stl::stable_sort(a.begin(), a.end(), by_key);
+        my_stl::inplace_stable_sort(b.begin(), b.end(), by_key);
+        TEST_CHECK(a.size() == n && key_then_seq(a) && a == b);
+    }
+
+    /* inplace_merge: 两半各自有序, 相等时前一半的元素在前; 任一半为空时不变 */
+    my_stl::vector<item> m;
+    for (int i = 0; i < 40; ++i)
+        m.push_back(item(i / 3, i));
+    for (int i = 0; i < 30; ++i)
+        m.push_back(item(i / 2, 100 + i));
+    my_stl::inplace_merge(m.begin(), m.begin() + 40, m.end(), by_key);
+    TEST_CHECK(m.size() == 70 && key_then_seq(m));
+    const my_stl::vector<item> merged(m);
+    my_stl::inplace_merge(m.begin(), m.begin(), m.end(), by_key);
+    my_stl::inplace_merge(m.begin(), m.end(), m.end(), by_key);
+    my_stl::inplace_merge(m.begin(), m.begin(), m.begin(), by_key);
+    TEST_CHECK(m == merged);
+    my_stl::vector<int> halves{5, 6, 7, 1, 2, 3};
+    my_stl::inplace_merge(halves.begin(), halves.begin() + 3, halves.end());
+    TEST_CHECK(same_elements(halves, std::vector<int>{1, 2, 3, 5, 6, 7}));
+}
+
+void test_list_node_cache() {
+    std::cout << "[----------------- Run container test : list node cache -----------------]\n";
+    typedef my_stl::list<int> ilist;
+    ilist a;
+    TEST_CHECK(a.node_cache_limit() == 0 && a.node_cache_size() == 0);
+    a.push_back(1);
+    a.pop_back();
+    TEST_CHECK(a.node_cache_size() == 0);                       /* 默认不缓存 */
+
+    /* 释放的结点最多留limit个, 之后的插入先用缓存 */
+    a.set_node_cache(8);
+    for (int i = 0; i < 20; ++i)
+        a.push_back(i);
+    a.clear();
+    TEST_CHECK(a.node_cache_limit() == 8 && a.node_cache_size() == 8);
+    for (int i = 0; i < 3; ++i)
+        a.push_back(i);
+    TEST_CHECK(a.node_cache_size() == 5 && a.size() == 3);
+
+    /* 调小上限时多余的结点还给配置器 */
+    a.set_node_cache(2);
+    TEST_CHECK(a.node_cache_limit() == 2 && a.node_cache_size() == 2);
+    a.set_node_cache(6);
+    TEST_CHECK(a.node_cache_size() == 2);
+    a.pop_front();
+    a.pop_front();
+    TEST_CHECK(a.node_cache_size() == 4 && a.size() == 1);
+
+    /* 移动构造接管缓存的结点和上限, 被移动的list保留自己的上限 */
+    ilist b(std::move(a));
+    TEST_CHECK(b.node_cache_size() == 4 && b.node_cache_limit() == 6 && b.size() == 1 && b.front() == 2);
+    TEST_CHECK(a.node_cache_size() == 0 && a.node_cache_limit() == 6 && a.empty());
+
+    /* swap交换缓存的结点, 上限留在各自的list, 超出的部分还回去 */
+    ilist c;
+    c.set_node_cache(3);
+    b.swap(c);
+    TEST_CHECK(b.node_cache_limit() == 6 && b.node_cache_size() == 0 && b.empty());
+    TEST_CHECK(c.node_cache_limit() == 3 && c.node_cache_size() == 3 && c.size() == 1 && c.front() == 2);
+    b.swap(c);
+    TEST_CHECK(b.node_cache_size() == 3 && c.node_cache_size() == 0 && b.front() == 2 && c.empty());
+
+    /* 拷贝不继承缓存设置, 拷贝赋值也不改变自己的设置 */
+    ilist d(b);
+    TEST_CHECK(d.node_cache_limit() == 0 && d.node_cache_size() == 0 && d.size() == 1);
+    ilist e;
+    e.set_node_cache(5);
+    e = b;
+    TEST_CHECK(e.node_cache_limit() == 5 && e.node_cache_size() == 0 && e.front() == 2);
+    b.set_node_cache(0);
+    TEST_CHECK(b.node_cache_size() == 0 && b.front() == 2);
+}
+
+/* 计时工具, 返回fn运行的毫秒数 */
+template <class Fn>
+double time_ms(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+/* 结点分配: allocator(每个结点一次::operator new) 对比 pool_allocator(自由链表复用) */
+void bench_list_pool() {
+    typedef my_stl::list_node<int> node;
+    const int n = 10000000;
+    std::cout << "[-------------------- bench : list node allocation --------------------]\n";
+
+    auto churn = [&](auto alloc_one, auto free_one) {
+        /* 模拟push_back n个结点后全部erase, 再来一轮 */
+        std::vector<node*> nodes(n);
+        for (int round = 0; round < 2; ++round) {
+            for (int i = 0; i < n; ++i) nodes[i] = alloc_one();
+            for (int i = 0; i < n; ++i) free_one(nodes[i]);
+        }
+    };
+    double t1 = time_ms([&] {
+        churn([] {return my_stl::allocator<node>::allocate(1);},
+              [](node *p) {my_stl::allocator<node>::deallocate(p, 1);});
+    });
+    double t2 = time_ms([&] {
+        churn([] {return my_stl::pool_allocator<node>::allocate(1);},
+              [](node *p) {my_stl::pool_allocator<node>::deallocate(p, 1);});
+    });
+    std::cout << "allocator<list_node<int>>      : " << t1 << " ms\n";
+    std::cout << "pool_allocator<list_node<int>> : " << t2 << " ms\n";
+
+    double t3 = time_ms([&] {
+        my_stl::list<int> l;
+        for (int i = 0; i < n; ++i) l.push_back(i);
+        while (!l.empty()) l.pop_front();
+        for (int i = 0; i < n; ++i) l.push_back(i);
+        for (auto it = l.begin(); it != l.end();) it = l.erase(it);
+    });
+    double t4 = time_ms([&] {
+        std::list<int> l;
+        for (int i = 0; i < n; ++i) l.push_back(i);
+        while (!l.empty()) l.pop_front();
+        for (int i = 0; i < n; ++i) l.push_back(i);
+        for (auto it = l.begin(); it != l.end();) it = l.erase(it);
+    });
+    std::cout << "my_stl::list push_back/erase   : " << t3 << " ms\n";
+    std::cout << "std::list push_back/erase      : " << t4 << " ms\n";
+}
+
+/* 每个请求建一批短命的vector和list, 请求结束时全部丢弃: 全局堆 对比 单调arena */
+void bench_arena() {
+    const int requests = 2000, containers = 100;
+    std::cout << "[-------------------- bench : monotonic arena --------------------]\n";
+
+    double t1 = time_ms([&] {
+        for (int r = 0; r < requests; ++r) {
+            my_stl::vector<my_stl::vector<int>> vs;
+            my_stl::vector<my_stl::list<int, my_stl::allocator<int>>> ls;
+            for (int c = 0; c < containers; ++c) {
+                vs.emplace_back();
+                ls.emplace_back();
+                for (int i = 0; i < 50; ++i) vs.back().push_back(i);
+                for (int i = 0; i < 20; ++i) ls.back().push_back(i);
+            }
+        }
+    });
+
+    typedef my_stl::arena_allocator<int> int_alloc;
+    typedef my_stl::vector<int, int_alloc> arena_vector;
+    typedef my_stl::list<int, int_alloc> arena_list;
+    my_stl::monotonic_buffer_resource arena;
+    double t2 = time_ms([&] {
+        for (int r = 0; r < requests; ++r) {
+            {
+                int_alloc a(&arena);
+                my_stl::vector<arena_vector, my_stl::arena_allocator<arena_vector>> vs{
+                    my_stl::arena_allocator<arena_vector>(a)};
+                my_stl::vector<arena_list, my_stl::arena_allocator<arena_list>> ls{
+                    my_stl::arena_allocator<arena_list>(a)};
+                for (int c = 0; c < containers; ++c) {
+                    vs.emplace_back(a);
+                    ls.emplace_back(a);
+                    for (int i = 0; i < 50; ++i) vs.back().push_back(i);
+                    for (int i = 0; i < 20; ++i) ls.back().push_back(i);
+                }
+            }
+            arena.release();                /* 请求结束, 一次归还所有块 */
+        }
+    });
+    std::cout << "global heap : " << t1 << " ms\n";
+    std::cout << "arena       : " << t2 << " ms\n";
+}
+
+/* 不声明可重定位的包装, 扩容时只能逐个移动构造再析构 */
+struct boxed_ints {
+    my_stl::vector<int> v;
+};
+
+void bench_relocate() {
+    const int rounds = 200, n = 20000;
+    std::cout << "[-------------------- bench : trivially relocatable --------------------]\n";
+    double t1 = time_ms([&] {
+        for (int r = 0; r < rounds; ++r) {
+            my_stl::vector<my_stl::vector<int>> vv;
+            for (int i = 0; i < n; ++i) {
+                vv.emplace_back();
+                vv.back().push_back(i);
+            }
+            vv.erase(vv.begin(), vv.begin() + n / 2);
+        }
+    });
+    double t2 = time_ms([&] {
+        for (int r = 0; r < rounds; ++r) {
+            my_stl::vector<boxed_ints> vv;
+            for (int i = 0; i < n; ++i) {
+                vv.emplace_back();
+                vv.back().v.push_back(i);
+            }
+            vv.erase(vv.begin(), vv.begin() + n / 2);
+        }
+    });
+    double t3 = time_ms([&] {
+        for (int r = 0; r < rounds; ++r) {
+            std::vector<std::vector<int>> vv;
+            for (int i = 0; i < n; ++i) {
+                vv.emplace_back();
+                vv.back().push_back(i);
+            }
+            vv.erase(vv.begin(), vv.begin() + n / 2);
+        }
+    });
+    std::cout << "my_stl::vector<vector<int>> (memcpy) : " << t1 << " ms\n";
+    std::cout << "my_stl::vector<boxed_ints> (move)    : " << t2 << " ms\n";
+    std::cout << "std::vector<std::vector<int>>        : " << t3 << " ms\n";
+}
+
+/* 当前进程的物理内存峰值(VmHWM), 单位MB; reset为真时先把峰值清零 */
+long peak_rss_mb(bool reset = false) {
+    if (reset) {
+        std::ofstream("/proc/self/clear_refs") << "5";
+        return 0;
+    }
+    std::ifstream in("/proc/self/status");
+    std::string key;
+    long kb = 0;
+    while (in >> key) {
+        if (key == "VmHWM:") {
+            in >> kb;
+            break;
+        }
+    }
+    return kb / 1024;
+}
+
+/* 逐个push_back n个int: 普通配置器每次扩容都要新旧两份空间, malloc_allocator走realloc/mremap.
+ * 请求里的1e9个int(4GB)在复制式扩容下峰值接近10GB, 这里默认用2.5e8个 */
+void bench_realloc_growth(size_t n = 250000000) {
+    std::cout << "[-------------------- bench : realloc growth --------------------]\n";
+    long rss1, rss2;
+    peak_rss_mb(true);
+    double t1 = time_ms([&] {
+        my_stl::vector<int, my_stl::malloc_allocator<int>> v;
+        for (size_t i = 0; i < n; ++i)
+            v.push_back(static_cast<int>(i));
+    });
+    rss1 = peak_rss_mb();
+    peak_rss_mb(true);
+    double t2 = time_ms([&] {
+        my_stl::vector<int> v;
+        for (size_t i = 0; i < n; ++i)
+            v.push_back(static_cast<int>(i));
+    });
+    rss2 = peak_rss_mb();
+    std::cout << "malloc_allocator (mremap) : " << t1 << " ms, peak " << rss1 << " MB\n";
+    std::cout << "allocator (copy)          : " << t2 << " ms, peak " << rss2 << " MB\n";
+}
+
+/* 每个连接一个短命的小list: 哨兵内嵌之后创建空list不再分配内存 */
+void bench_list_create() {
+    const int conns = 2000000;
+    std::cout << "[-------------------- bench : per-connection list --------------------]\n";
+    long sink = 0;
+    double t1 = time_ms([&] {
+        for (int c = 0; c < conns; ++c) {
+            my_stl::list<int> l;
+            if (c % 4 == 0)
+                l.push_back(c);
+            sink += static_cast<long>(l.size()) + (l.begin() == l.end());
+        }
+    });
+    double t2 = time_ms([&] {
+        for (int c = 0; c < conns; ++c) {
+            std::list<int> l;
+            if (c % 4 == 0)
+                l.push_back(c);
+            sink += static_cast<long>(l.size()) + (l.begin() == l.end());
+        }
+    });
+    std::cout << "my_stl::list : " << t1 << " ms\n";
+    std::cout << "std::list    : " << t2 << " ms (" << sink << ")\n";
+}
+
+/* 建一个容器, push_back size个元素, 读一遍再销毁; small_vector内联8个元素 */
+template <class Vec>
+double bench_fill_vec(int rounds, int size, long &sink) {
+    return time_ms([&] {
+        for (int r = 0; r < rounds; ++r) {
+            Vec v;
+            for (int i = 0; i < size; ++i)
+                v.push_back(i);
+            for (auto x : v)
+                sink += x;
+        }
+    });
+}
+
+void bench_small_vector() {
+    const int rounds = 1000000;
+    const int sizes[] = {0, 1, 2, 4, 8, 9, 16, 32, 64};
+    long sink = 0;
+    std::cout << "[-------------------- bench : small_vector<int, 8> vs vector<int> --------------------]\n";
+    for (int size : sizes) {
+        double t1 = bench_fill_vec<my_stl::small_vector<int, 8>>(rounds, size, sink);
+        double t2 = bench_fill_vec<my_stl::vector<int>>(rounds, size, sink);
+        std::cout << "size " << size << "\t small_vector : " << t1 << " ms\t vector : " << t2 << " ms\n";
+    }
+    std::cout << "(" << sink << ")\n";
+}
+
+/* 1e8个标志: bit_vector(每字64位) 对比 vector<char>(每个标志一字节), 稀疏置位后统计/遍历/合并 */
+void bench_bit_vector() {
+    const size_t n = 100000000;
+    const size_t stride = 997;
+    my_stl::bit_vector<> a(n), b(n);
+    my_stl::vector<char> ca(n, 0), cb(n, 0);
+    for (size_t i = 0; i < n; i += stride) {
+        a.set(i);
+        ca[i] = 1;
+    }
+    for (size_t i = 0; i < n; i += stride * 3) {
+        b.set(i + 1);
+        cb[i + 1] = 1;
+    }
+    size_t sink = 0;
+    std::cout << "[-------------------- bench : bit_vector vs vector<char>, 1e8 flags --------------------]\n";
+    double t1 = time_ms([&] { sink += a.count(); });
+    double t2 = time_ms([&] {
+        size_t c = 0;
+        for (size_t i = 0; i < n; ++i)
+            c += ca[i] != 0;
+        sink += c;
+    });
+    std::cout << "count     \t bit_vector : " << t1 << " ms\t vector<char> : " << t2 << " ms\n";
+    t1 = time_ms([&] {
+        for (size_t i = a.find_first(); i != a.size(); i = a.find_next(i))
+            sink += i;
+    });
+    t2 = time_ms([&] {
+        for (size_t i = 0; i < n; ++i)
+            if (ca[i])
+                sink += i;
+    });
+    std::cout << "find_next \t bit_vector : " << t1 << " ms\t vector<char> : " << t2 << " ms\n";
+    t1 = time_ms([&] {
+        a |= b;
+        a &= b;
+        sink += a.data()[0];
+    });
+    t2 = time_ms([&] {
+        for (size_t i = 0; i < n; ++i)
+            ca[i] |= cb[i];
+        for (size_t i = 0; i < n; ++i)
+            ca[i] &= cb[i];
+        sink += ca[0];
+    });
+    std::cout << "or + and  \t bit_vector : " << t1 << " ms\t vector<char> : " << t2 << " ms\n";
+    std::cout << "(" << sink << ")\n";
+}
+
+/* 256MB接收缓冲区: resize(值初始化, 先清零) 对比 resize_uninitialized, 之后都用fread从/dev/zero读满 */
+void bench_resize_uninitialized() {
+    const size_t n = size_t(256) << 20;
+    size_t sink = 0;
+    std::cout << "[-------------------- bench : resize vs resize_uninitialized, 256MB read --------------------]\n";
+    for (int round = 0; round < 3; ++round) {
+        double t1 = time_ms([&] {
+            my_stl::vector<unsigned char> buf;
+            buf.resize(n);
+            FILE *f = std::fopen("/dev/zero", "rb");
+            sink += std::fread(buf.data(), 1, n, f);
+            std::fclose(f);
+        });
+        double t2 = time_ms([&] {
+            my_stl::vector<unsigned char> buf;
+            buf.resize_uninitialized(n);
+            FILE *f = std::fopen("/dev/zero", "rb");
+            sink += std::fread(buf.data(), 1, n, f);
+            std::fclose(f);
+        });
+        double t3 = time_ms([&] {
+            my_stl::vector<unsigned char> buf;
+            buf.reverse(n);
+            FILE *f = std::fopen("/dev/zero", "rb");
+            for (size_t got = 0; got < n; got += size_t(1) << 20)
+                sink += std::fread(buf.append_uninitialized(size_t(1) << 20), 1, size_t(1) << 20, f);
+            std::fclose(f);
+        });
+        std::cout << "resize : " << t1 << " ms\t resize_uninitialized : " << t2
+                  << " ms\t append_uninitialized(1MB chunks) : " << t3 << " ms\n";
+    }
+    std::cout << "(" << sink << ")\n";
+}
+
+/* 按批追加记录: 逐个push_back(每个元素检查一次容量) 对比 append_range / copy到back_inserter(每批检查一次) */
+struct ingest_record {
+    long id;
+    double value;
+    int a, b;
+};
+
+void bench_append_range() {
+    const int batch = 64;
+    const int batches = 1000000;
+    const int flush = 1024;     /* 每1024批清空一次, 容量保留, 测的是追加本身而不是扩容 */
+    ingest_record src[batch];
+    for (int i = 0; i < batch; ++i)
+        src[i] = ingest_record{i, i * 0.5, i, -i};
+    long sink = 0;
+    std::cout << "[-------------------- bench : push_back vs append_range, 64 x 1000000 records --------------------]\n";
+    for (int round = 0; round < 3; ++round) {
+        my_stl::vector<ingest_record> v;
+        double t1 = time_ms([&] {
+            for (int b = 0; b < batches; ++b) {
+                if (b % flush == 0)
+                    v.clear();
+                for (int i = 0; i < batch; ++i)
+                    v.push_back(src[i]);
+            }
+            sink += v.size();
+        });
+        double t2 = time_ms([&] {
+            for (int b = 0; b < batches; ++b) {
+                if (b % flush == 0)
+                    v.clear();
+                v.append_range(src, src + batch);
+            }
+            sink += v.size();
+        });
+        double t3 = time_ms([&] {
+            for (int b = 0; b < batches; ++b) {
+                if (b % flush == 0)
+                    v.clear();
+                my_stl::copy(src, src + batch, my_stl::back_inserter(v));
+            }
+            sink += v.size();
+        });
+        std::cout << "push_back : " << t1 << " ms\t append_range : " << t2 << " ms\t back_inserter : " << t3 << " ms\n";
+    }
+    std::cout << "(" << sink << ")\n";
+}
+
+/* 预留空间后写入1e8个int: push_back / push_back_unchecked / reserve_and_fill */
+void bench_unchecked_push() {
+    const int n = 100000000;
+    long sink = 0;
+    std::cout << "[-------------------- bench : push_back vs push_back_unchecked vs reserve_and_fill, 1e8 ints --------------------]\n";
+    for (int round = 0; round < 3; ++round) {
+        my_stl::vector<int> v;
+        v.reverse(n);
+        double t1 = time_ms([&] {
+            for (int i = 0; i < n; ++i)
+                v.push_back(i * 3);
+            sink += v.back();
+        });
+        v.clear();
+        double t2 = time_ms([&] {
+            for (int i = 0; i < n; ++i)
+                v.push_back_unchecked(i * 3);
+            sink += v.back();
+        });
+        v.clear();
+        double t3 = time_ms([&] {
+            v.reserve_and_fill(n, [&](int *out) {
+                for (int i = 0; i < n; ++i)
+                    out[i] = i * 3;
+                return out + n;
+            });
+            sink += v.back();
+        });
+        std::cout << "push_back : " << t1 << " ms\t push_back_unchecked : " << t2
+                  << " ms\t reserve_and_fill : " << t3 << " ms\n";
+    }
+    std::cout << "(" << sink << ")\n";
+}
+
+/* 排序的测试数据: 随机, 已排序, 逆序, 大量重复, 基本有序(有序后随机交换0.1%) */
+enum class sort_input { random, sorted, reversed, few_unique, nearly_sorted };
+
+template <class T>
+my_stl::vector<T> make_sort_input(size_t n, sort_input kind, unsigned seed = 42) {
+    std::mt19937_64 rng(seed);
+    my_stl::vector<T> v;
+    v.reverse(n);
+    for (size_t i = 0; i < n; ++i)
+        v.push_back(static_cast<T>(kind == sort_input::few_unique ? rng() % 16 : rng()));
+    if (kind == sort_input::sorted || kind == sort_input::nearly_sorted)
+        std::sort(v.begin(), v.end());
+    if (kind == sort_input::nearly_sorted)
+        for (size_t i = 0; i < n / 1000; ++i)
+            std::swap(v[rng() % n], v[rng() % n]);
+    else if (kind == sort_input::reversed)
+        std::sort(v.begin(), v.end(), [](const T &a, const T &b) {return b < a;});
+    return v;
+}
+
+const char* sort_input_name(sort_input kind) {
+    switch (kind) {
+        case sort_input::random:    return "random    ";
+        case sort_input::sorted:    return "sorted    ";
+        case sort_input::reversed:  return "reversed  ";
+        case sort_input::few_unique: return "few_unique";
+        default:                    return "nearly    ";
+    }
+}
+
+/* my_stl::sort(pdqsort) 对比 my_stl::introsort 和 std::sort, 5e6个int */
+void bench_sort() {
+    const size_t n = 5000000;
+    const sort_input kinds[] = {sort_input::random, sort_input::sorted, sort_input::reversed,
+                                sort_input::few_unique, sort_input::nearly_sorted};
+    std::cout << "[-------------------- bench : my_stl::sort vs introsort vs std::sort, 5e6 ints --------------------]\n";
+    for (auto kind : kinds) {
+        auto input = make_sort_input<int>(n, kind);
+        auto a = input;
+        auto b = input;
+        auto c = input;
+        double t1 = time_ms([&] { my_stl::sort(a.begin(), a.end()); });
+        double t2 = time_ms([&] { my_stl::introsort(b.begin(), b.end()); });
+        double t3 = time_ms([&] { std::sort(c.begin(), c.end()); });
+        std::cout << sort_input_name(kind) << "\t my_stl::sort : " << t1 << " ms\t introsort : " << t2
+                  << " ms\t std::sort : " << t3 << " ms" << (a == c && b == c ? "" : "\t MISMATCH") << "\n";
+    }
+}
+
+/* radix_sort 对比 my_stl::sort 和 std::sort, 2e7个键; pair按first排序, 对比std::stable_sort */
+template <class T, class Gen>
+void bench_radix_one(const char *name, size_t n, Gen gen) {
+    std::mt19937_64 rng(7);
+    my_stl::vector<T> input;
+    input.reverse(n);
+    for (size_t i = 0; i < n; ++i)
+        input.push_back(gen(rng));
+    auto a = input;
+    auto b = input;
+    auto c = input;
+    double t1 = time_ms([&] { my_stl::radix_sort(a.begin(), a.end()); });
+    double t2 = time_ms([&] { my_stl::sort(b.begin(), b.end()); });
+    double t3 = time_ms([&] { std::sort(c.begin(), c.end()); });
+    std::cout << name << "\t radix_sort : " << t1 << " ms\t my_stl::sort : " << t2 << " ms\t std::sort : " << t3
+              << " ms" << (a == c ? "" : "\t MISMATCH") << "\n";
+}
+
+void bench_radix_sort() {
+    const size_t n = 20000000;
+    std::cout << "[-------------------- bench : radix_sort vs comparison sorts, 2e7 keys --------------------]\n";
+    bench_radix_one<uint32_t>("uint32_t   ", n, [](std::mt19937_64 &g) {return static_cast<uint32_t>(g());});
+    bench_radix_one<uint32_t>("uint32_t<1e6", n, [](std::mt19937_64 &g) {return static_cast<uint32_t>(g() % 1000000);});
+    bench_radix_one<uint64_t>("uint64_t   ", n, [](std::mt19937_64 &g) {return static_cast<uint64_t>(g());});
+    bench_radix_one<uint64_t>("uint64_t<2^40", n, [](std::mt19937_64 &g) {return static_cast<uint64_t>(g() >> 24);});
+    bench_radix_one<int64_t>("int64_t    ", n, [](std::mt19937_64 &g) {return static_cast<int64_t>(g());});
+    bench_radix_one<float>("float      ", n, [](std::mt19937_64 &g) {return static_cast<float>(static_cast<int64_t>(g())) * 1e-9f;});
+
+    typedef my_stl::pair<uint32_t, uint32_t> record;
+    std::mt19937_64 rng(7);
+    my_stl::vector<record> input;
+    input.reverse(n);
+    for (size_t i = 0; i < n; ++i)
+        input.push_back(record(static_cast<uint32_t>(rng() % 100000), static_cast<uint32_t>(i)));
+    auto a = input;
+    auto c = input;
+    double t1 = time_ms([&] { my_stl::radix_sort(a.begin(), a.end()); });
+    double t3 = time_ms([&] {
+        std::stable_sort(c.begin(), c.end(), [](const record &x, const record &y) {return x.first < y.first;});
+    });
+    std::cout << "pair<u32,u32>\t radix_sort : " << t1 << " ms\t std::stable_sort : " << t3
+              << " ms" << (a == c ? "" : "\t MISMATCH") << "\n";
+}
+
+void bench_stable_sort() {
+    const size_t n = 5000000;
+    std::cout << "[-------------------- bench : stable_sort, 5e6 pair<u32,u32> by first --------------------]\n";
+    typedef my_stl::pair<uint32_t, uint32_t> record;
+    struct by_key {
+        bool operator()(const record &x, const record &y) const {return x.first < y.first;}
+    };
+    for (uint32_t keys : {100u, 100000u, 4000000000u}) {
+        std::mt19937_64 rng(keys);
+        my_stl::vector<record> input;
+        input.reverse(n);
+        for (size_t i = 0; i < n; ++i)
+            input.push_back(record(static_cast<uint32_t>(rng() % keys), static_cast<uint32_t>(i)));
+        auto a = input;
+        auto b = input;
+        auto c = input;
+        double t1 = time_ms([&] { my_stl::stable_sort(a.begin(), a.end(), by_key()); });
+        double t2 = time_ms([&] { std::stable_sort(b.begin(), b.end(), by_key()); });
+        double t3 = time_ms([&] { my_stl::inplace_stable_sort(c.begin(), c.end(), by_key()); });
+        std::cout << "keys < " << keys << "\t stable_sort : " << t1 << " ms\t std::stable_sort : " << t2
+                  << " ms\t no buffer : " << t3 << " ms" << (a == b && a == c ? "" : "\t MISMATCH") << "\n";
+    }
+
+    /* 两段有序区间合并 */
+    my_stl::vector<uint32_t> m;
+    m.reverse(n);
+    for (size_t i = 0; i < n; ++i)
+        m.push_back(static_cast<uint32_t>(i < n / 2 ? 2 * i : 2 * (i - n / 2) + 1));
+    auto m1 = m;
+    auto m2 = m;
+    double t4 = time_ms([&] { my_stl::inplace_merge(m1.begin(), m1.begin() + n / 2, m1.end()); });
+    double t5 = time_ms([&] { std::inplace_merge(m2.begin(), m2.begin() + n / 2, m2.end()); });
+    std::cout << "inplace_merge\t my_stl : " << t4 << " ms\t std : " << t5
+              << " ms" << (m1 == m2 ? "" : "\t MISMATCH") << "\n";
+}
+
+/* 换成自底向上归并之前的list::sort: 递归地走到中点, 再把右半段的结点成段splice进左半段.
+ * 只用于bench_list_sort对比, 返回排好后的第一个元素 */
+template <class List, class Compare>
+typename List::iterator recursive_list_sort(List &l, typename List::iterator f1, typename List::iterator l2,
+                                            size_t n, Compare comp) {
+    typedef typename List::iterator iterator;
+    if (n < 2)
+        return f1;
+    if (n == 2) {
+        if (comp(*--l2, *f1)) {
+            l.splice(f1, l, l2);
+            return l2;
+        }
+        return f1;
+    }
+    const size_t n2 = n / 2;
+    iterator l1 = f1;
+    my_stl::advance(l1, n2);
+    iterator result = f1 = recursive_list_sort(l, f1, l1, n2, comp);
+    iterator f2 = l1 = recursive_list_sort(l, l1, l2, n - n2, comp);
+    /* 右半段开头比f1小的一段整体挪到f1之前 */
+    auto move_run = [&] {
+        iterator m = f2;
+        for (++m; m != l2 && comp(*m, *f1); ++m)
+            ;
+        if (l1 == f2)
+            l1 = m;
+        const iterator run = f2;
+        f2 = m;
+        l.splice(f1, l, run, m);
+        return run;
+    };
+    if (comp(*f2, *f1))
+        result = move_run();
+    ++f1;
+    while (f1 != l1 && f2 != l2) {
+        if (comp(*f2, *f1))
+            move_run();
+        ++f1;
+    }
+    return result;
+}
+
+void bench_list_sort() {
+    const size_t n = 4000000;
+    std::cout << "[-------------------- bench : list::sort, 4e6 int --------------------]\n";
+    const sort_input kinds[] = {sort_input::random, sort_input::sorted, sort_input::reversed, sort_input::few_unique};
+    /* 所有list在任何排序之前建好, 每个list的结点都是新分配的, 按链表顺序连续;
+     * 否则后面的list会复用前面排序打乱过的结点, 测到的是内存的分散程度而不是排序本身 */
+    my_stl::list<int> bottom_up[4], recursive[4];
+    std::list<int> reference[4];
+    for (size_t k = 0; k < 4; ++k) {
+        auto input = make_sort_input<int>(n, kinds[k], 17);
+        for (auto x : input)
+            bottom_up[k].push_back(x);
+        for (auto x : input)
+            recursive[k].push_back(x);
+        for (auto x : input)
+            reference[k].push_back(x);
+    }
+    for (size_t k = 0; k < 4; ++k) {
+        auto &a = bottom_up[k];
+        auto &o = recursive[k];
+        double t1 = time_ms([&] { a.sort(); });
+        double t2 = time_ms([&] { recursive_list_sort(o, o.begin(), o.end(), o.size(), my_stl::less<int>()); });
+        double t3 = time_ms([&] { reference[k].sort(); });
+        const bool sorted = my_stl::is_sorted(a.begin(), a.end()) && my_stl::is_sorted(o.begin(), o.end())
+                            && a.size() == n && o.size() == n;
+        std::cout << sort_input_name(kinds[k]) << "\t bottom-up : " << t1 << " ms\t old recursive : " << t2
+                  << " ms\t std::list : " << t3 << " ms" << (sorted ? "" : "\t NOT SORTED") << "\n";
+    }
+}
+
+/* 不可平凡复制的int, list::sort对它只走归并 */
+struct boxed_int {
+    int v;
+    boxed_int(int x = 0) : v(x) {}
+    boxed_int(const boxed_int &rhs) : v(rhs.v) {}
+    boxed_int& operator=(const boxed_int &rhs) {v = rhs.v; return *this;}
+    bool operator<(const boxed_int &rhs) const {return v < rhs.v;}
+};
+
+/* 结点在内存中的顺序被打乱的list: 先顺序建好, 再按随机顺序把结点splice到新的list */
+template <class List>
+void make_shuffled_list(List &out, size_t n, std::mt19937_64 &rng) {
+    List tmp;
+    for (size_t i = 0; i < n; ++i)
+        tmp.push_back(static_cast<int>(rng()));
+    /* 打乱的是下标, 迭代器放在std::vector里只按下标读取 */
+    std::vector<typename List::iterator> nodes;
+    nodes.reserve(n);
+    for (auto it = tmp.begin(); it != tmp.end(); ++it)
+        nodes.push_back(it);
+    my_stl::vector<size_t> order(n, 0);
+    for (size_t i = 0; i < n; ++i)
+        order[i] = i;
+    for (size_t i = n; i > 1; --i)
+        my_stl::swap(order[i - 1], order[rng() % i]);
+    for (auto i : order)
+        out.splice(out.end(), tmp, nodes[i]);
+}
+
+/* 只按key比较, seq记录排序前的位置, 用来检查稳定性 */
+struct keyed_int {
+    int key;
+    int seq;
+    keyed_int(int x = 0) : key(x), seq(0) {}
+};
+
+/* 不可平凡复制的版本, list::sort对它只走归并 */
+struct boxed_keyed_int : keyed_int {
+    boxed_keyed_int(int x = 0) : keyed_int(x) {}
+    boxed_keyed_int(const boxed_keyed_int &rhs) : keyed_int(rhs) {}
+    boxed_keyed_int& operator=(const boxed_keyed_int &rhs) {keyed_int::operator=(rhs); return *this;}
+};
+
+/* 结点打乱的list按key排序(重复很多), 检查key有序并且相等的key保持原来的先后 */
+template <class List>
+bool shuffled_sort_is_stable(size_t n, std::mt19937_64 &rng) {
+    List l;
+    make_shuffled_list(l, n, rng);
+    int seq = 0;
+    for (auto &x : l) {
+        x.key &= 63;
+        x.seq = seq++;
+    }
+    l.sort([](const keyed_int &lhs, const keyed_int &rhs) {return lhs.key < rhs.key;});
+    if (l.size() != n)
+        return false;
+    auto prev = l.begin();
+    for (auto it = prev; it != l.end(); prev = it) {
+        if (++it == l.end())
+            break;
+        if (it->key < prev->key || (it->key == prev->key && it->seq < prev->seq))
+            return false;
+    }
+    return true;
+}
+
+void bench_list_gather_sort() {
+    std::cout << "[-------------------- bench : list::sort on shuffled nodes --------------------]\n";
+    std::mt19937_64 rng(23);
+    for (size_t n : {size_t(1) << 10, size_t(1) << 16, size_t(1) << 20, size_t(1) << 22}) {
+        const size_t rounds = (size_t(8) << 20) / n;
+        double t1 = 0, t2 = 0, t3 = 0;
+        bool sorted = true;
+        for (size_t r = 0; r < rounds; ++r) {
+            my_stl::list<int> a;
+            my_stl::list<boxed_int> b;
+            std::list<int> c;
+            make_shuffled_list(a, n, rng);
+            make_shuffled_list(b, n, rng);
+            make_shuffled_list(c, n, rng);
+            t1 += time_ms([&] { a.sort(); });
+            t2 += time_ms([&] { b.sort(); });
+            t3 += time_ms([&] { c.sort(); });
+            sorted = sorted && my_stl::is_sorted(a.begin(), a.end()) && my_stl::is_sorted(b.begin(), b.end())
+                     && a.size() == n && b.size() == n;
+        }
+        const bool stable = shuffled_sort_is_stable<my_stl::list<keyed_int>>(n, rng)
+                            && shuffled_sort_is_stable<my_stl::list<boxed_keyed_int>>(n, rng);
+        std::cout << "n = " << n << "\t gather_sort : " << t1 / rounds << " ms\t merge : " << t2 / rounds
+                  << " ms\t std::list : " << t3 / rounds << " ms"
+                  << (sorted ? "" : "\t NOT SORTED") << (stable ? "" : "\t NOT STABLE") << "\n";
+    }
+}
+
+/* 遍历求和: unrolled_list(每结点64个int) 对比 list(顺序分配的结点和打乱的结点) 和 std::list */
+template <class Container>
+long long sum_of(const Container &c) {
+    long long sum = 0;
+    for (auto &x : c)
+        sum += x;
+    return sum;
+}
+
+void bench_unrolled_list() {
+    std::cout << "[-------------------- bench : unrolled_list vs list, iteration --------------------]\n";
+    std::mt19937_64 rng(29);
+    for (size_t n : {size_t(1) << 16, size_t(1) << 20, size_t(1) << 23}) {
+        const size_t rounds = (size_t(64) << 20) / n;
+        my_stl::unrolled_list<int> u;
+        my_stl::list<int> a, b;
+        std::list<int> c;
+        for (size_t i = 0; i < n; ++i) {
+            const int v = static_cast<int>(rng() % 1000);
+            u.push_back(v);
+            a.push_back(v);
+            c.push_back(v);
+        }
+        make_shuffled_list(b, n, rng);
+        volatile long long sink = 0;
+        double t1 = time_ms([&] { for (size_t r = 0; r < rounds; ++r) sink = sink + sum_of(u); });
+        double t2 = time_ms([&] {
+            for (size_t r = 0; r < rounds; ++r) {
+                long long sum = 0;
+                u.for_each_segment([&](const int *f, const int *l) {
+                    for (; f != l; ++f)
+                        sum += *f;
+                });
+                sink = sink + sum;
+            }
+        });
+        double t3 = time_ms([&] { for (size_t r = 0; r < rounds; ++r) sink = sink + sum_of(a); });
+        double t4 = time_ms([&] { for (size_t r = 0; r < rounds; ++r) sink = sink + sum_of(b); });
+        double t5 = time_ms([&] { for (size_t r = 0; r < rounds; ++r) sink = sink + sum_of(c); });
+        auto per_elem = [&](double t) {return t * 1e6 / static_cast<double>(rounds * n);};
+        std::cout << "n = " << n << " (ns/elem)\t unrolled_list : " << per_elem(t1)
+                  << "\t for_each_segment : " << per_elem(t2)
+                  << "\t list : " << per_elem(t3) << "\t list(shuffled) : " << per_elem(t4)
+                  << "\t std::list : " << per_elem(t5) << "\n";
+    }
+
+    std::cout << "[-------------------- bench : unrolled_list vs list, queue of 1e5, 5e7 push_back + pop_front --------------------]\n";
+    const size_t window = 100000, ops = 50000000;
+    double tq1 = time_ms([&] {
+        my_stl::unrolled_list<int> q;
+        for (size_t i = 0; i < ops; ++i) {
+            q.push_back(static_cast<int>(i));
+            if (q.size() > window)
+                q.pop_front();
+        }
+    });
+    double tq2 = time_ms([&] {
+        my_stl::list<int> q;
+        for (size_t i = 0; i < ops; ++i) {
+            q.push_back(static_cast<int>(i));
+            if (q.size() > window)
+                q.pop_front();
+        }
+    });
+    std::cout << "unrolled_list : " << tq1 << " ms\t list : " << tq2 << " ms\n";
+}
+
+/* 对象已经在池(vector)里: intrusive_list只串起对象, list要为每个对象分配结点并拷贝 */
+struct pooled_task {
+    int id;
+    int payload[7];
+    my_stl::intrusive_list_hook hook;
+};
+
+void bench_intrusive_list() {
+    const size_t n = 1000000, rounds = 20;
+    std::cout << "[-------------------- bench : intrusive_list vs list, 1e6 pooled objects --------------------]\n";
+    my_stl::vector<pooled_task> pool(n);
+    for (size_t i = 0; i < n; ++i)
+        pool[i].id = static_cast<int>(i);
+    volatile long long sink = 0;
+
+    double t1 = time_ms([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            my_stl::intrusive_list<pooled_task, &pooled_task::hook> l;
+            for (auto &t : pool)
+                l.push_back(t);
+            long long sum = 0;
+            for (auto &t : l)
+                sum += t.id;
+            while (!l.empty())
+                l.pop_front();
+            sink = sink + sum;
+        }
+    });
+    double t2 = time_ms([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            my_stl::list<pooled_task> l;
+            for (auto &t : pool)
+                l.push_back(t);
+            long long sum = 0;
+            for (auto &t : l)
+                sum += t.id;
+            while (!l.empty())
+                l.pop_front();
+            sink = sink + sum;
+        }
+    });
+    double t3 = time_ms([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            my_stl::list<pooled_task*> l;
+            for (auto &t : pool)
+                l.push_back(&t);
+            long long sum = 0;
+            for (auto p : l)
+                sum += p->id;
+            while (!l.empty())
+                l.pop_front();
+            sink = sink + sum;
+        }
+    });
+    std::cout << "push_back + iterate + pop_front (ms/round)\t intrusive_list : " << t1 / rounds
+              << "\t list<T> : " << t2 / rounds << "\t list<T*> : " << t3 / rounds << "\n";
+
+    /* 对象在两个队列之间来回搬: 取出队头, 挂到另一个队列的队尾 */
+    const size_t moves = 20000000;
+    double t4 = time_ms([&] {
+        my_stl::intrusive_list<pooled_task, &pooled_task::hook> ready, waiting;
+        for (auto &t : pool)
+            ready.push_back(t);
+        for (size_t i = 0; i < moves; ++i) {
+            auto &from = (i & 1) ? waiting : ready;
+            auto &to = (i & 1) ? ready : waiting;
+            if (!from.empty())
+                to.splice(to.end(), from, from.begin());
+        }
+        sink = sink + static_cast<long long>(ready.size());
+    });
+    double t5 = time_ms([&] {
+        my_stl::list<pooled_task*> ready, waiting;
+        for (auto &t : pool)
+            ready.push_back(&t);
+        for (size_t i = 0; i < moves; ++i) {
+            auto &from = (i & 1) ? waiting : ready;
+            auto &to = (i & 1) ? ready : waiting;
+            if (!from.empty()) {
+                to.push_back(from.front());
+                from.pop_front();
+            }
+        }
+        sink = sink + static_cast<long long>(ready.size());
+    });
+    std::cout << "2e7 moves between queues\t intrusive_list splice : " << t4
+              << " ms\t list<T*> push_back + pop_front : " << t5 << " ms\n";
+}
+
+/* 稳定状态的FIFO: 先放入1e6个元素, 之后每次push_back一个再pop_front一个, 结点数不变 */
+template <class List>
+double fifo_churn_ms(List &q, size_t n, size_t ops) {
+    for (size_t i = 0; i < n; ++i)
+        q.push_back(static_cast<int>(i));
+    return time_ms([&] {
+        for (size_t i = 0; i < ops; ++i) {
+            q.push_back(static_cast<int>(i));
+            q.pop_front();
+        }
+    });
+}
+
+void bench_list_node_cache() {
+    const size_t n = 1000000, ops = 50000000;
+    std::cout << "[-------------------- bench : list node cache, FIFO of 1e6, 5e7 push_back + pop_front --------------------]\n";
+    {
+        my_stl::list<int> q;
+        std::cout << "pool_allocator, no cache\t : " << fifo_churn_ms(q, n, ops) << " ms\n";
+    }
+    {
+        my_stl::list<int> q;
+        q.set_node_cache(64);
+        std::cout << "pool_allocator, cache 64\t : " << fifo_churn_ms(q, n, ops) << " ms\n";
+    }
+    {
+        my_stl::list<int, my_stl::allocator<int>> q;
+        std::cout << "allocator, no cache\t\t : " << fifo_churn_ms(q, n, ops) << " ms\n";
+    }
+    {
+        my_stl::list<int, my_stl::allocator<int>> q;
+        q.set_node_cache(64);
+        std::cout << "allocator, cache 64\t\t : " << fifo_churn_ms(q, n, ops) << " ms\n";
+    }
+    {
+        std::list<int> q;
+        std::cout << "std::list\t\t\t : " << fifo_churn_ms(q, n, ops) << " ms\n";
+    }
+}
+
+void bench_parallel_sort() {
+    const size_t n = 20000000;
+    std::cout << "[-------------------- bench : parallel_sort vs sort, 2e7 uint64_t --------------------]\n";
+    std::mt19937_64 rng(11);
+    my_stl::vector<uint64_t> input;
+    input.reverse(n);
+    for (size_t i = 0; i < n; ++i)
+        input.push_back(rng());
+    auto s = input;
+    double ts = time_ms([&] { my_stl::sort(s.begin(), s.end()); });
+    std::cout << "sort\t\t\t : " << ts << " ms\n";
+    for (size_t threads : {1, 2, 4, 8}) {
+        my_stl::thread_pool pool(threads);
+        auto p = input;
+        double tp = time_ms([&] {
+            my_stl::parallel_sort(p.begin(), p.end(), my_stl::less<uint64_t>(), my_stl::parallel_sort_grain, pool);
+        });
+        std::cout << "parallel_sort(" << threads << " threads) : " << tp << " ms"
+                  << (p == s ? "" : "\t MISMATCH") << "\n";
+    }
+}
+
+/* 所有bench, 运行 My_STL bench [名字...], 不带名字时全部运行 */
+struct bench_entry {
+    const char *name;
+    void (*fn)();
+};
+
+const bench_entry all_benches[] = {
+        {"list_pool", bench_list_pool},
+        {"arena", bench_arena},
+        {"relocate", bench_relocate},
+        {"realloc_growth", [] {bench_realloc_growth();}},
+        {"list_create", bench_list_create},
+        {"small_vector", bench_small_vector},
+        {"bit_vector", bench_bit_vector},
+        {"resize_uninitialized", bench_resize_uninitialized},
+        {"append_range", bench_append_range},
+        {"unchecked_push", bench_unchecked_push},
+        {"sort", bench_sort},
+        {"radix_sort", bench_radix_sort},
+        {"stable_sort", bench_stable_sort},
+        {"list_sort", bench_list_sort},
+        {"list_gather_sort", bench_list_gather_sort},
+        {"unrolled_list", bench_unrolled_list},
+        {"intrusive_list", bench_intrusive_list},
+        {"list_node_cache", bench_list_node_cache},
+        {"parallel_sort", bench_parallel_sort},
+};
+
+int run_benches(int argc, char **argv) {
+    for (const auto &b : all_benches) {
+        bool selected = argc == 0;
+        for (int i = 0; i < argc; ++i)
+            selected = selected || std::string(argv[i]) == b.name;
+        if (selected)
+            b.fn();
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && std::string(argv[1]) == "bench")
+        return run_benches(argc - 2, argv + 2);
+    test_vector_uninitialized();
+    test_vector_append();
+    test_vector_unchecked();
+    test_small_vector();
+    test_inplace_vector();
+    test_bit_vector();
+    test_sort();
+    test_parallel_sort();
+    test_unrolled_list();
+    test_intrusive_list();
+#ifdef MYSTL_INSTRUMENT
+    test_instrument();
+#endif
+    test_list_node_cache();
     test_list();
+    if (test_failures != 0) {
+        std::cout << "******************************" << test_failures << "项检查失败******************************" << std::endl;
+        return 1;
+    }
     return 0;
 }
 